@@ -0,0 +1,223 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <math.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "adc-convert.h"
+
+/* Raw value used to derive the scale of the library conversion */
+#define LDX_SCALE_PROBE		4096
+
+typedef void (*conv_fn_t)(const struct adc_conv *conv, const int32_t *raw,
+			  float *mv, size_t n);
+
+/*
+ * conv_tail() - Converts samples one by one
+ *
+ * @conv:	Conversion.
+ * @raw:	Raw samples, starting at the first entry of the coefficients.
+ * @mv:		Buffer for the converted samples.
+ * @n:		Number of samples.
+ */
+static void conv_tail(const struct adc_conv *conv, const int32_t *raw,
+		      float *mv, size_t n)
+{
+	unsigned int j = 0;
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+		mv[i] = raw[i] * conv->scale[j] + conv->offset[j];
+		if (++j == conv->period)
+			j = 0;
+	}
+}
+
+#if defined(__ARM_NEON)
+static void conv_neon(const struct adc_conv *conv, const int32_t *raw,
+		      float *mv, size_t n)
+{
+	size_t i = 0;
+	unsigned int j;
+
+	for (; n - i >= conv->period; i += conv->period) {
+		for (j = 0; j < conv->period; j += 4) {
+			float32x4_t v = vcvtq_f32_s32(vld1q_s32(raw + i + j));
+
+			v = vmlaq_f32(vld1q_f32(conv->offset + j), v,
+				      vld1q_f32(conv->scale + j));
+			vst1q_f32(mv + i + j, v);
+		}
+	}
+
+	conv_tail(conv, raw + i, mv + i, n - i);
+}
+#elif defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+static void conv_sse2(const struct adc_conv *conv, const int32_t *raw,
+		      float *mv, size_t n)
+{
+	size_t i = 0;
+	unsigned int j;
+
+	for (; n - i >= conv->period; i += conv->period) {
+		for (j = 0; j < conv->period; j += 4) {
+			__m128 v = _mm_cvtepi32_ps(_mm_loadu_si128(
+					(const __m128i *)(raw + i + j)));
+
+			v = _mm_add_ps(_mm_mul_ps(v, _mm_load_ps(conv->scale + j)),
+				       _mm_load_ps(conv->offset + j));
+			_mm_storeu_ps(mv + i + j, v);
+		}
+	}
+
+	conv_tail(conv, raw + i, mv + i, n - i);
+}
+
+__attribute__((target("avx")))
+static void conv_avx(const struct adc_conv *conv, const int32_t *raw,
+		     float *mv, size_t n)
+{
+	size_t i = 0;
+	unsigned int j;
+
+	for (; n - i >= conv->period; i += conv->period) {
+		for (j = 0; j < conv->period; j += 8) {
+			__m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256(
+					(const __m256i *)(raw + i + j)));
+
+			v = _mm256_add_ps(_mm256_mul_ps(v,
+					_mm256_load_ps(conv->scale + j)),
+					_mm256_load_ps(conv->offset + j));
+			_mm256_storeu_ps(mv + i + j, v);
+		}
+	}
+
+	conv_tail(conv, raw + i, mv + i, n - i);
+}
+#endif
+
+static conv_fn_t conv_fn;
+static const char *conv_name;
+
+/*
+ * conv_select() - Selects the fastest implementation for the running CPU
+ */
+static void conv_select(void)
+{
+	if (conv_fn)
+		return;
+
+#if defined(__ARM_NEON)
+	conv_fn = conv_neon;
+	conv_name = "NEON";
+#elif defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx")) {
+		conv_fn = conv_avx;
+		conv_name = "AVX";
+	} else if (__builtin_cpu_supports("sse2")) {
+		conv_fn = conv_sse2;
+		conv_name = "SSE2";
+	}
+#endif
+	if (!conv_fn) {
+		conv_fn = conv_tail;
+		conv_name = "scalar";
+	}
+}
+
+int adc_conv_init(struct adc_conv *conv, unsigned int nchannels)
+{
+	unsigned int i;
+
+	if (!nchannels || nchannels > ADC_IIO_MAX_CHANNELS)
+		return -EINVAL;
+
+	conv->nchannels = nchannels;
+	conv->period = nchannels * ADC_CONV_LANES;
+	for (i = 0; i < nchannels; i++)
+		adc_conv_set(conv, i, 1, 0);
+
+	conv_select();
+
+	return 0;
+}
+
+void adc_conv_set(struct adc_conv *conv, unsigned int ch, float scale,
+		  float offset)
+{
+	unsigned int j;
+
+	for (j = ch; j < conv->period; j += conv->nchannels) {
+		conv->scale[j] = scale;
+		conv->offset[j] = offset;
+	}
+}
+
+int adc_conv_set_from_adc(struct adc_conv *conv, unsigned int ch, adc_t *adc)
+{
+	float offset, scale, mid;
+
+	offset = ldx_adc_convert_sample_to_mv(adc, 0);
+	scale = (ldx_adc_convert_sample_to_mv(adc, LDX_SCALE_PROBE) - offset) /
+		LDX_SCALE_PROBE;
+
+	/* The coefficients are only valid for a linear conversion */
+	mid = ldx_adc_convert_sample_to_mv(adc, LDX_SCALE_PROBE / 2);
+	if (fabsf(mid - (offset + scale * LDX_SCALE_PROBE / 2)) >
+	    fabsf(scale) + 1e-3f)
+		return -EINVAL;
+
+	adc_conv_set(conv, ch, scale, offset);
+
+	return 0;
+}
+
+int adc_conv_init_iio(struct adc_conv *conv, const struct adc_iio *iio)
+{
+	unsigned int i;
+	int ret;
+
+	ret = adc_conv_init(conv, iio->nchannels);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < iio->nchannels; i++)
+		adc_conv_set(conv, i, iio->chans[i].scale,
+			     iio->chans[i].raw_offset * iio->chans[i].scale);
+
+	return 0;
+}
+
+void adc_conv_run(const struct adc_conv *conv, const int32_t *raw, float *mv,
+		  size_t n)
+{
+	conv_fn(conv, raw, mv, n);
+}
+
+const char *adc_conv_impl(void)
+{
+	conv_select();
+
+	return conv_name;
+}
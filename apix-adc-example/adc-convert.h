@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ADC_CONVERT_H_
+#define ADC_CONVERT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libdigiapix/adc.h"
+
+#include "adc-iio.h"
+
+/* Samples per vector of the widest implementation (AVX) */
+#define ADC_CONV_LANES		8
+#define ADC_CONV_MAX_PERIOD	(ADC_IIO_MAX_CHANNELS * ADC_CONV_LANES)
+
+/*
+ * Conversion of interleaved raw samples to mV: mv = raw * scale + offset.
+ *
+ * The coefficients of the channels are repeated up to 'period' entries, a
+ * multiple of the vector width, so every vector of samples is converted with
+ * one multiply and one add regardless of the number of channels.
+ */
+struct adc_conv {
+	unsigned int nchannels;
+	unsigned int period;
+	float scale[ADC_CONV_MAX_PERIOD] __attribute__((aligned(32)));
+	float offset[ADC_CONV_MAX_PERIOD] __attribute__((aligned(32)));
+};
+
+/*
+ * adc_conv_init() - Initializes a conversion with unity coefficients
+ *
+ * @conv:	Conversion to initialize.
+ * @nchannels:	Number of interleaved channels.
+ *
+ * Return: 0 on success, -EINVAL if the number of channels is not valid.
+ */
+int adc_conv_init(struct adc_conv *conv, unsigned int nchannels);
+
+/*
+ * adc_conv_set() - Sets the coefficients of a channel
+ *
+ * @conv:	Conversion.
+ * @ch:		Channel position in the interleaved samples.
+ * @scale:	mV per LSB.
+ * @offset:	mV of a raw value of 0.
+ */
+void adc_conv_set(struct adc_conv *conv, unsigned int ch, float scale,
+		  float offset);
+
+/*
+ * adc_conv_set_from_adc() - Sets the coefficients of a channel from the library
+ *
+ * The coefficients are derived from ldx_adc_convert_sample_to_mv(), so the
+ * results match the per-sample conversion of the library.
+ *
+ * @conv:	Conversion.
+ * @ch:		Channel position in the interleaved samples.
+ * @adc:	ADC channel.
+ *
+ * Return: 0 on success, -EINVAL if the conversion of the library is not
+ *	   linear.
+ */
+int adc_conv_set_from_adc(struct adc_conv *conv, unsigned int ch, adc_t *adc);
+
+/*
+ * adc_conv_init_iio() - Initializes a conversion for the scans of a capture
+ *
+ * @conv:	Conversion to initialize.
+ * @iio:	Capture, the samples must be unpacked with adc_iio_unpack().
+ *
+ * Return: 0 on success, -EINVAL if the capture has no channels.
+ */
+int adc_conv_init_iio(struct adc_conv *conv, const struct adc_iio *iio);
+
+/*
+ * adc_conv_run() - Converts a batch of raw samples to mV
+ *
+ * @conv:	Conversion.
+ * @raw:	Raw samples, interleaved and starting with the first channel.
+ * @mv:		Buffer to store the n converted samples.
+ * @n:		Number of samples.
+ */
+void adc_conv_run(const struct adc_conv *conv, const int32_t *raw, float *mv,
+		  size_t n);
+
+/*
+ * adc_conv_impl() - Returns the name of the implementation in use
+ *
+ * Return: "NEON", "AVX", "SSE2" or "scalar".
+ */
+const char *adc_conv_impl(void);
+
+#endif /* ADC_CONVERT_H_ */
@@ -0,0 +1,486 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "adc-iio.h"
+
+#define IIO_SYSFS_DIR		"/sys/bus/iio/devices"
+#define IIO_DEV_DIR		"/dev"
+
+#define ALIGN(x, a)		(((x) + (a) - 1) / (a) * (a))
+
+/*
+ * sysfs_read() - Reads a sysfs attribute
+ *
+ * @path:	Path of the attribute.
+ * @buf:	Buffer to store the value, without the trailing new line.
+ * @len:	Size of the buffer.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int sysfs_read(const char *path, char *buf, size_t len)
+{
+	ssize_t n;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -errno;
+
+	n = read(fd, buf, len - 1);
+	close(fd);
+	if (n < 0)
+		return -errno;
+
+	buf[n] = '\0';
+	buf[strcspn(buf, "\n")] = '\0';
+
+	return 0;
+}
+
+/*
+ * sysfs_write() - Writes a sysfs attribute
+ *
+ * @path:	Path of the attribute.
+ * @val:	Value to write.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int sysfs_write(const char *path, const char *val)
+{
+	ssize_t n;
+	int fd;
+
+	fd = open(path, O_WRONLY);
+	if (fd < 0)
+		return -errno;
+
+	n = write(fd, val, strlen(val));
+	close(fd);
+
+	return n < 0 ? -errno : 0;
+}
+
+/*
+ * dev_attr() - Builds the path of an attribute of the device
+ *
+ * @iio:	Capture.
+ * @path:	Buffer of PATH_MAX bytes to store the path.
+ * @fmt:	Format of the attribute path, relative to the device.
+ */
+static void dev_attr(const struct adc_iio *iio, char *path, const char *fmt,
+		     ...)
+{
+	va_list ap;
+	int len;
+
+	len = snprintf(path, PATH_MAX, IIO_SYSFS_DIR "/iio:device%u/",
+		       iio->chip);
+	va_start(ap, fmt);
+	vsnprintf(path + len, PATH_MAX - len, fmt, ap);
+	va_end(ap);
+}
+
+/*
+ * disable_scan_elements() - Disables all the scan elements of the device
+ *
+ * Elements left enabled by other applications would change the scan layout.
+ *
+ * @iio:	Capture.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int disable_scan_elements(const struct adc_iio *iio)
+{
+	char path[PATH_MAX];
+	struct dirent *de;
+	size_t len;
+	DIR *dir;
+
+	dev_attr(iio, path, "scan_elements");
+	dir = opendir(path);
+	if (!dir)
+		return -errno;
+
+	while ((de = readdir(dir))) {
+		len = strlen(de->d_name);
+		if (len < 3 || strcmp(de->d_name + len - 3, "_en"))
+			continue;
+		dev_attr(iio, path, "scan_elements/%s", de->d_name);
+		sysfs_write(path, "0");
+	}
+	closedir(dir);
+
+	return 0;
+}
+
+/*
+ * read_scale() - Reads the scale and offset of a channel
+ *
+ * Uses the channel attributes if they exist and the shared ones otherwise.
+ *
+ * @iio:	Capture.
+ * @c:		Channel.
+ */
+static void read_scale(const struct adc_iio *iio, struct adc_iio_chan *c)
+{
+	char path[PATH_MAX], val[64];
+
+	c->scale = 1.0f;
+	dev_attr(iio, path, "in_voltage%u_scale", c->channel);
+	if (!sysfs_read(path, val, sizeof(val))) {
+		c->scale = strtof(val, NULL);
+	} else {
+		dev_attr(iio, path, "in_voltage_scale");
+		if (!sysfs_read(path, val, sizeof(val)))
+			c->scale = strtof(val, NULL);
+	}
+
+	c->raw_offset = 0.0f;
+	dev_attr(iio, path, "in_voltage%u_offset", c->channel);
+	if (!sysfs_read(path, val, sizeof(val))) {
+		c->raw_offset = strtof(val, NULL);
+	} else {
+		dev_attr(iio, path, "in_voltage_offset");
+		if (!sysfs_read(path, val, sizeof(val)))
+			c->raw_offset = strtof(val, NULL);
+	}
+}
+
+/*
+ * read_element() - Reads the index and type of a scan element
+ *
+ * @iio:	Capture.
+ * @elem:	Element name, for example "in_voltage3".
+ * @c:		Channel to fill.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int read_element(const struct adc_iio *iio, const char *elem,
+			struct adc_iio_chan *c)
+{
+	char path[PATH_MAX], val[64];
+	char endian, sign;
+	unsigned int storage;
+	int ret;
+
+	dev_attr(iio, path, "scan_elements/%s_index", elem);
+	ret = sysfs_read(path, val, sizeof(val));
+	if (ret)
+		return ret;
+	c->index = strtoul(val, NULL, 10);
+
+	/* For example "le:s12/16>>4" */
+	dev_attr(iio, path, "scan_elements/%s_type", elem);
+	ret = sysfs_read(path, val, sizeof(val));
+	if (ret)
+		return ret;
+	if (sscanf(val, "%ce:%c%u/%u>>%u", &endian, &sign, &c->bits,
+		   &storage, &c->shift) != 5)
+		return -EINVAL;
+	if (storage != 8 && storage != 16 && storage != 32 && storage != 64)
+		return -EINVAL;
+
+	c->bytes = storage / 8;
+	c->be = endian == 'b';
+	c->is_signed = sign == 's';
+
+	return 0;
+}
+
+/*
+ * compute_layout() - Sorts the channels by scan index and computes their
+ *		      offsets
+ *
+ * Every element is aligned to its storage size, the timestamp goes last.
+ *
+ * @iio:	Capture.
+ * @ts:		Timestamp element, NULL if disabled.
+ */
+static void compute_layout(struct adc_iio *iio, const struct adc_iio_chan *ts)
+{
+	struct adc_iio_chan tmp;
+	unsigned int i, j, offset = 0, max_bytes = 1;
+
+	for (i = 1; i < iio->nchannels; i++) {
+		tmp = iio->chans[i];
+		for (j = i; j > 0 && iio->chans[j - 1].index > tmp.index; j--)
+			iio->chans[j] = iio->chans[j - 1];
+		iio->chans[j] = tmp;
+	}
+
+	for (i = 0; i < iio->nchannels; i++) {
+		offset = ALIGN(offset, iio->chans[i].bytes);
+		iio->chans[i].offset = offset;
+		offset += iio->chans[i].bytes;
+		if (iio->chans[i].bytes > max_bytes)
+			max_bytes = iio->chans[i].bytes;
+	}
+
+	iio->ts_offset = -1;
+	if (ts) {
+		offset = ALIGN(offset, ts->bytes);
+		iio->ts_offset = offset;
+		offset += ts->bytes;
+		if (ts->bytes > max_bytes)
+			max_bytes = ts->bytes;
+	}
+
+	iio->scan_size = ALIGN(offset, max_bytes);
+}
+
+/*
+ * set_trigger_rate() - Sets the sampling rate
+ *
+ * The rate is an attribute of the trigger (for example, hrtimer triggers)
+ * or of the device for the ADCs with their own trigger.
+ *
+ * @iio:	Capture.
+ * @rate:	Scans per second.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int set_trigger_rate(const struct adc_iio *iio, double rate)
+{
+	char path[PATH_MAX], trigger[64], name[64], val[32];
+	struct dirent *de;
+	DIR *dir;
+	int ret = -ENOENT;
+
+	/* Some triggers only accept integer frequencies */
+	if (rate == (double)(unsigned long)rate)
+		snprintf(val, sizeof(val), "%lu", (unsigned long)rate);
+	else
+		snprintf(val, sizeof(val), "%.3f", rate);
+
+	dev_attr(iio, path, "trigger/current_trigger");
+	if (!sysfs_read(path, trigger, sizeof(trigger)) && trigger[0]) {
+		dir = opendir(IIO_SYSFS_DIR);
+		while (dir && (de = readdir(dir))) {
+			if (strncmp(de->d_name, "trigger", 7))
+				continue;
+			snprintf(path, sizeof(path), IIO_SYSFS_DIR "/%s/name",
+				 de->d_name);
+			if (sysfs_read(path, name, sizeof(name)) ||
+			    strcmp(name, trigger))
+				continue;
+			snprintf(path, sizeof(path),
+				 IIO_SYSFS_DIR "/%s/sampling_frequency",
+				 de->d_name);
+			ret = sysfs_write(path, val);
+			break;
+		}
+		if (dir)
+			closedir(dir);
+		if (!ret)
+			return 0;
+	}
+
+	dev_attr(iio, path, "sampling_frequency");
+	ret = sysfs_write(path, val);
+	if (ret) {
+		dev_attr(iio, path, "in_voltage_sampling_frequency");
+		ret = sysfs_write(path, val);
+	}
+
+	return ret;
+}
+
+int adc_iio_open(struct adc_iio *iio, unsigned int chip,
+		 const unsigned int *channels, unsigned int n,
+		 const struct adc_iio_cfg *cfg)
+{
+	struct adc_iio_chan ts, *c;
+	char path[PATH_MAX], elem[32], val[16];
+	bool has_ts;
+	unsigned int i;
+	int ret;
+
+	memset(iio, 0, sizeof(*iio));
+	iio->fd = -1;
+	iio->chip = chip;
+
+	if (!n || n > ADC_IIO_MAX_CHANNELS)
+		return -EINVAL;
+
+	/* The layout can only be changed with the buffer disabled */
+	dev_attr(iio, path, "buffer/enable");
+	ret = sysfs_write(path, "0");
+	if (ret)
+		return ret;
+
+	ret = disable_scan_elements(iio);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < n; i++) {
+		c = &iio->chans[i];
+		c->channel = channels[i];
+		snprintf(elem, sizeof(elem), "in_voltage%u", channels[i]);
+
+		dev_attr(iio, path, "scan_elements/%s_en", elem);
+		ret = sysfs_write(path, "1");
+		if (!ret)
+			ret = read_element(iio, elem, c);
+		if (ret)
+			goto error;
+
+		read_scale(iio, c);
+	}
+	iio->nchannels = n;
+
+	dev_attr(iio, path, "scan_elements/in_timestamp_en");
+	has_ts = !sysfs_write(path, "1") &&
+		 !read_element(iio, "in_timestamp", &ts);
+	compute_layout(iio, has_ts ? &ts : NULL);
+
+	if (cfg->trigger) {
+		dev_attr(iio, path, "trigger/current_trigger");
+		ret = sysfs_write(path, cfg->trigger);
+		if (ret)
+			goto error;
+	}
+
+	if (cfg->rate > 0) {
+		ret = set_trigger_rate(iio, cfg->rate);
+		if (ret)
+			goto error;
+		iio->rate = cfg->rate;
+	}
+
+	iio->batch = cfg->batch ? cfg->batch : 1;
+	snprintf(val, sizeof(val), "%u", cfg->buffer_len > iio->batch ?
+		 cfg->buffer_len : 2 * iio->batch);
+	dev_attr(iio, path, "buffer/length");
+	ret = sysfs_write(path, val);
+	if (ret)
+		goto error;
+
+	/* Wake up the reader once per batch, not on every scan */
+	snprintf(val, sizeof(val), "%u", iio->batch);
+	dev_attr(iio, path, "buffer/watermark");
+	sysfs_write(path, val);
+
+	iio->buf = malloc((size_t)iio->scan_size * iio->batch);
+	if (!iio->buf) {
+		ret = -ENOMEM;
+		goto error;
+	}
+
+	dev_attr(iio, path, "buffer/enable");
+	ret = sysfs_write(path, "1");
+	if (ret)
+		goto error;
+
+	snprintf(path, sizeof(path), IIO_DEV_DIR "/iio:device%u", chip);
+	iio->fd = open(path, O_RDONLY);
+	if (iio->fd < 0) {
+		ret = -errno;
+		goto error;
+	}
+
+	return 0;
+
+error:
+	adc_iio_close(iio);
+
+	return ret;
+}
+
+ssize_t adc_iio_read(struct adc_iio *iio, const uint8_t **scans)
+{
+	ssize_t n;
+
+	do {
+		n = read(iio->fd, iio->buf, (size_t)iio->scan_size * iio->batch);
+	} while (n < 0 && errno == EINTR);
+
+	if (n < 0)
+		return -errno;
+
+	*scans = iio->buf;
+
+	return n / iio->scan_size;
+}
+
+void adc_iio_unpack(const struct adc_iio *iio, const uint8_t *scans,
+		    size_t n, int32_t *out)
+{
+	unsigned int i;
+	size_t s;
+
+	for (s = 0; s < n; s++, scans += iio->scan_size)
+		for (i = 0; i < iio->nchannels; i++)
+			*out++ = adc_iio_sample(iio, scans, i);
+}
+
+int adc_iio_write_hdr(const struct adc_iio *iio, int fd)
+{
+	struct adc_iio_file_hdr hdr;
+	unsigned int i;
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, ADC_IIO_FILE_MAGIC, sizeof(hdr.magic));
+	hdr.version = htole16(ADC_IIO_FILE_VERSION);
+	hdr.nchannels = htole16(iio->nchannels);
+	hdr.scan_size = htole32(iio->scan_size);
+	hdr.ts_offset = htole32(iio->ts_offset);
+	hdr.rate = iio->rate;
+
+	for (i = 0; i < iio->nchannels; i++) {
+		const struct adc_iio_chan *c = &iio->chans[i];
+
+		hdr.chans[i].channel = c->channel;
+		hdr.chans[i].offset = c->offset;
+		hdr.chans[i].bytes = c->bytes;
+		hdr.chans[i].bits = c->bits;
+		hdr.chans[i].shift = c->shift;
+		hdr.chans[i].flags = (c->is_signed ? 1 : 0) | (c->be ? 2 : 0);
+		hdr.chans[i].scale = c->scale;
+		hdr.chans[i].raw_offset = c->raw_offset;
+	}
+
+	if (write(fd, &hdr, sizeof(hdr)) != sizeof(hdr))
+		return -errno;
+
+	return 0;
+}
+
+void adc_iio_close(struct adc_iio *iio)
+{
+	char path[PATH_MAX];
+
+	if (iio->fd >= 0) {
+		close(iio->fd);
+		iio->fd = -1;
+	}
+
+	/* Leave the sysfs interface of the channels usable again */
+	dev_attr(iio, path, "buffer/enable");
+	sysfs_write(path, "0");
+
+	free(iio->buf);
+	iio->buf = NULL;
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ADC_IIO_H_
+#define ADC_IIO_H_
+
+#include <endian.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#define ADC_IIO_MAX_CHANNELS		16
+#define ADC_IIO_DEF_BUFFER_LEN		16384	/* scans */
+
+#define ADC_IIO_FILE_MAGIC		"DADC"
+#define ADC_IIO_FILE_VERSION		1
+
+/* Configuration of a buffered capture */
+struct adc_iio_cfg {
+	double rate;			/* Scans per second, 0 to keep it */
+	const char *trigger;		/* Trigger name, NULL to keep it */
+	unsigned int buffer_len;	/* Kernel buffer length, in scans */
+	unsigned int batch;		/* Scans returned by each read */
+};
+
+/* Layout of a channel in the scans of the buffer */
+struct adc_iio_chan {
+	unsigned int channel;		/* N of in_voltageN */
+	unsigned int index;		/* Scan index */
+	unsigned int offset;		/* Byte offset in the scan */
+	unsigned int bytes;		/* Storage size */
+	unsigned int bits;		/* Valid bits */
+	unsigned int shift;
+	bool is_signed;
+	bool be;
+	float scale;			/* mV per LSB */
+	float raw_offset;		/* Added to the raw value before scaling */
+};
+
+struct adc_iio {
+	unsigned int chip;
+	int fd;
+	unsigned int nchannels;
+	struct adc_iio_chan chans[ADC_IIO_MAX_CHANNELS];	/* Scan order */
+	int ts_offset;			/* Timestamp offset, -1 if disabled */
+	unsigned int scan_size;
+	uint8_t *buf;
+	unsigned int batch;
+	double rate;			/* Configured rate, 0 if unknown */
+};
+
+/*
+ * Header of a capture file, followed by the scans as read from the device.
+ * Multi-byte fields are little endian.
+ */
+struct adc_iio_file_hdr {
+	char magic[4];
+	uint16_t version;
+	uint16_t nchannels;
+	uint32_t scan_size;
+	int32_t ts_offset;
+	double rate;
+	struct {
+		uint8_t channel;
+		uint8_t offset;
+		uint8_t bytes;
+		uint8_t bits;
+		uint8_t shift;
+		uint8_t flags;		/* Bit 0: signed, bit 1: big endian */
+		uint8_t reserved[2];
+		float scale;
+		float raw_offset;
+	} chans[ADC_IIO_MAX_CHANNELS];
+};
+
+/*
+ * adc_iio_open() - Configures and enables the triggered buffer of an ADC
+ *
+ * Enables the scan elements of the given channels (and the timestamp if the
+ * device provides it), selects the trigger, sets the sampling rate and
+ * enables the buffer. The sysfs reads of the channels (ldx_adc_read_sample())
+ * fail while the buffer is enabled.
+ *
+ * @iio:	Capture to initialize.
+ * @chip:	ADC chip, the N of /sys/bus/iio/devices/iio:deviceN.
+ * @channels:	Channels to capture.
+ * @n:		Number of channels.
+ * @cfg:	Capture configuration.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int adc_iio_open(struct adc_iio *iio, unsigned int chip,
+		 const unsigned int *channels, unsigned int n,
+		 const struct adc_iio_cfg *cfg);
+
+/*
+ * adc_iio_read() - Reads the next batch of scans
+ *
+ * Blocks until the kernel buffer has data. The scans are valid until the
+ * next call.
+ *
+ * @iio:	Capture.
+ * @scans:	Variable to store the pointer to the first scan.
+ *
+ * Return: The number of scans read, -errno on error.
+ */
+ssize_t adc_iio_read(struct adc_iio *iio, const uint8_t **scans);
+
+/*
+ * adc_iio_unpack() - Extracts the samples of a batch of scans
+ *
+ * @iio:	Capture.
+ * @scans:	Scans read with adc_iio_read().
+ * @n:		Number of scans.
+ * @out:	Buffer of n * nchannels samples, interleaved in scan order.
+ */
+void adc_iio_unpack(const struct adc_iio *iio, const uint8_t *scans,
+		    size_t n, int32_t *out);
+
+/*
+ * adc_iio_write_hdr() - Writes the header of a capture file
+ *
+ * @iio:	Capture.
+ * @fd:		File descriptor of the capture file.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int adc_iio_write_hdr(const struct adc_iio *iio, int fd);
+
+/*
+ * adc_iio_close() - Disables the buffer and frees the capture resources
+ *
+ * @iio:	Capture.
+ */
+void adc_iio_close(struct adc_iio *iio);
+
+/*
+ * adc_iio_sample() - Extracts the sample of a channel from a scan
+ *
+ * @iio:	Capture.
+ * @scan:	Scan.
+ * @i:		Channel position in the scan.
+ *
+ * Return: The raw sample, sign extended.
+ */
+static inline int32_t adc_iio_sample(const struct adc_iio *iio,
+				     const uint8_t *scan, unsigned int i)
+{
+	const struct adc_iio_chan *c = &iio->chans[i];
+	uint32_t v;
+	uint16_t v16;
+
+	switch (c->bytes) {
+	case 1:
+		v = scan[c->offset];
+		break;
+	case 2:
+		memcpy(&v16, scan + c->offset, 2);
+		v = c->be ? be16toh(v16) : le16toh(v16);
+		break;
+	default:
+		memcpy(&v, scan + c->offset, 4);
+		v = c->be ? be32toh(v) : le32toh(v);
+		break;
+	}
+
+	v >>= c->shift;
+	if (c->bits < 32) {
+		v &= (1U << c->bits) - 1;
+		if (c->is_signed && (v & (1U << (c->bits - 1))))
+			v |= ~((1U << c->bits) - 1);
+	}
+
+	return (int32_t)v;
+}
+
+/*
+ * adc_iio_timestamp() - Returns the timestamp of a scan
+ *
+ * @iio:	Capture.
+ * @scan:	Scan.
+ *
+ * Return: The timestamp in ns, 0 if the timestamps are disabled.
+ */
+static inline int64_t adc_iio_timestamp(const struct adc_iio *iio,
+					const uint8_t *scan)
+{
+	int64_t ts;
+
+	if (iio->ts_offset < 0)
+		return 0;
+
+	memcpy(&ts, scan + iio->ts_offset, sizeof(ts));
+
+	return ts;
+}
+
+#endif /* ADC_IIO_H_ */
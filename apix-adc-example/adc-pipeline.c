@@ -0,0 +1,259 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "adc-pipeline.h"
+
+#define RING_MASK		(ADC_PIPE_RING_SIZE - 1)
+
+/* Bits of growth allowed in the CIC filter for 32-bit samples */
+#define CIC_MAX_GAIN		2147483648.0
+
+/*
+ * emit_window() - Emits the statistics of the current window and resets it
+ *
+ * @pipe:	Pipeline.
+ */
+static void emit_window(struct adc_pipe *pipe)
+{
+	struct adc_window *w = &pipe->win;
+
+	w->mean = pipe->sum / w->count;
+	w->rms = sqrt(pipe->sum_sq / w->count);
+	pipe->cfg.on_window(w, pipe->cfg.arg);
+
+	w->count = 0;
+	pipe->sum = 0;
+	pipe->sum_sq = 0;
+}
+
+/*
+ * update_window() - Accounts a sample in the window statistics
+ *
+ * @pipe:	Pipeline.
+ * @mv:		Sample, in mV.
+ * @ts:		Time of the sample.
+ */
+static void update_window(struct adc_pipe *pipe, float mv, uint64_t ts)
+{
+	struct adc_window *w = &pipe->win;
+
+	if (!w->count) {
+		w->ts = ts;
+		w->min = mv;
+		w->max = mv;
+	}
+	w->min = mv < w->min ? mv : w->min;
+	w->max = mv > w->max ? mv : w->max;
+	pipe->sum += mv;
+	pipe->sum_sq += (double)mv * mv;
+
+	if (++w->count == pipe->cfg.window)
+		emit_window(pipe);
+}
+
+/*
+ * update_cic() - Feeds a sample to the CIC decimator
+ *
+ * The integrators and combs wrap around modulo 2^64, which is harmless as
+ * long as the output fits in the register.
+ *
+ * @pipe:	Pipeline.
+ * @raw:	Raw sample.
+ * @ts:		Time of the sample.
+ */
+static void update_cic(struct adc_pipe *pipe, int32_t raw, uint64_t ts)
+{
+	unsigned int k, order = pipe->cfg.order;
+	uint64_t y, prev;
+	float mv;
+
+	pipe->integ[0] += (uint64_t)(int64_t)raw;
+	for (k = 1; k < order; k++)
+		pipe->integ[k] += pipe->integ[k - 1];
+
+	if (++pipe->phase < pipe->cfg.decim)
+		return;
+	pipe->phase = 0;
+
+	y = pipe->integ[order - 1];
+	for (k = 0; k < order; k++) {
+		prev = pipe->comb[k];
+		pipe->comb[k] = y;
+		y -= prev;
+	}
+
+	mv = (int64_t)y / pipe->gain * pipe->conv.scale[0] + pipe->conv.offset[0];
+	pipe->cfg.on_decimated(ts, mv, pipe->cfg.arg);
+}
+
+/*
+ * process_samples() - Processes the queued samples
+ *
+ * @pipe:	Pipeline.
+ *
+ * Return: The number of samples processed.
+ */
+static unsigned int process_samples(struct adc_pipe *pipe)
+{
+	int32_t raw[ADC_PIPE_CHUNK];
+	float mv[ADC_PIPE_CHUNK];
+	uint64_t ts[ADC_PIPE_CHUNK];
+	uint32_t head, tail;
+	unsigned int i, n;
+
+	tail = atomic_load_explicit(&pipe->tail, memory_order_relaxed);
+	head = atomic_load_explicit(&pipe->head, memory_order_acquire);
+	n = head - tail;
+	if (n > ADC_PIPE_CHUNK)
+		n = ADC_PIPE_CHUNK;
+	if (!n)
+		return 0;
+
+	for (i = 0; i < n; i++) {
+		raw[i] = pipe->raw[(tail + i) & RING_MASK];
+		ts[i] = pipe->ts[(tail + i) & RING_MASK];
+	}
+	atomic_store_explicit(&pipe->tail, tail + n, memory_order_release);
+
+	adc_conv_run(&pipe->conv, raw, mv, n);
+
+	for (i = 0; i < n; i++) {
+		if (pipe->cfg.window)
+			update_window(pipe, mv[i], ts[i]);
+		if (pipe->cfg.decim > 1)
+			update_cic(pipe, raw[i], ts[i]);
+	}
+
+	return n;
+}
+
+/*
+ * pipe_thread() - Consumer of the samples
+ *
+ * @arg:	Pipeline (struct adc_pipe).
+ */
+static void *pipe_thread(void *arg)
+{
+	struct adc_pipe *pipe = arg;
+	uint64_t val;
+
+	for (;;) {
+		if (process_samples(pipe))
+			continue;
+
+		/* Sleep until the producer queues a sample or it is stopped */
+		atomic_store(&pipe->sleeping, true);
+		if (atomic_load(&pipe->head) != atomic_load(&pipe->tail)) {
+			atomic_store(&pipe->sleeping, false);
+			continue;
+		}
+		if (!atomic_load(&pipe->running))
+			break;
+		if (read(pipe->efd, &val, sizeof(val)) < 0 && errno != EINTR)
+			break;
+		atomic_store(&pipe->sleeping, false);
+	}
+
+	return NULL;
+}
+
+int adc_pipe_start(struct adc_pipe *pipe, const struct adc_pipe_cfg *cfg,
+		   adc_t *adc)
+{
+	unsigned int k;
+	int ret;
+
+	if (!cfg->window && cfg->decim <= 1)
+		return -EINVAL;
+	if (cfg->decim > 1 && (!cfg->order || cfg->order > ADC_PIPE_MAX_ORDER))
+		return -EINVAL;
+
+	memset(pipe, 0, sizeof(*pipe));
+	pipe->cfg = *cfg;
+
+	/* Gain of the CIC filter, R^N with a differential delay of 1 */
+	pipe->gain = 1;
+	for (k = 0; cfg->decim > 1 && k < cfg->order; k++)
+		pipe->gain *= cfg->decim;
+	if (pipe->gain > CIC_MAX_GAIN)
+		return -ERANGE;
+
+	ret = adc_conv_init(&pipe->conv, 1);
+	if (!ret)
+		ret = adc_conv_set_from_adc(&pipe->conv, 0, adc);
+	if (ret)
+		return ret;
+
+	pipe->efd = eventfd(0, EFD_CLOEXEC);
+	if (pipe->efd < 0)
+		return -errno;
+
+	atomic_store(&pipe->running, true);
+	ret = pthread_create(&pipe->thread, NULL, pipe_thread, pipe);
+	if (ret) {
+		close(pipe->efd);
+		return -ret;
+	}
+	pipe->started = true;
+
+	return 0;
+}
+
+void adc_pipe_push(struct adc_pipe *pipe, int32_t raw, uint64_t ts)
+{
+	uint32_t head = atomic_load_explicit(&pipe->head, memory_order_relaxed);
+	uint64_t val = 1;
+
+	if (head - atomic_load_explicit(&pipe->tail, memory_order_acquire) ==
+	    ADC_PIPE_RING_SIZE) {
+		pipe->dropped++;
+		return;
+	}
+
+	pipe->raw[head & RING_MASK] = raw;
+	pipe->ts[head & RING_MASK] = ts;
+	atomic_store(&pipe->head, head + 1);
+
+	/* Only wake up the consumer when it is waiting */
+	if (atomic_load(&pipe->sleeping) &&
+	    atomic_exchange(&pipe->sleeping, false))
+		if (write(pipe->efd, &val, sizeof(val)) < 0)
+			return;
+}
+
+void adc_pipe_stop(struct adc_pipe *pipe)
+{
+	uint64_t val = 1;
+
+	if (!pipe->started)
+		return;
+
+	atomic_store(&pipe->running, false);
+	if (write(pipe->efd, &val, sizeof(val)) < 0)
+		pthread_cancel(pipe->thread);
+	pthread_join(pipe->thread, NULL);
+	close(pipe->efd);
+	pipe->started = false;
+
+	if (pipe->cfg.window && pipe->win.count)
+		emit_window(pipe);
+}
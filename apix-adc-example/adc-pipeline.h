@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ADC_PIPELINE_H_
+#define ADC_PIPELINE_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "adc-convert.h"
+
+#define ADC_PIPE_RING_SIZE	4096	/* Samples, power of 2 */
+#define ADC_PIPE_CHUNK		256	/* Samples converted at once */
+#define ADC_PIPE_MAX_ORDER	5	/* Maximum order of the CIC filter */
+
+/* Statistics of a window of samples */
+struct adc_window {
+	uint64_t ts;		/* CLOCK_MONOTONIC time of the first sample */
+	unsigned int count;
+	float min, max, mean, rms;	/* mV */
+};
+
+struct adc_pipe_cfg {
+	unsigned int window;	/* Samples per window, 0 to disable */
+	unsigned int decim;	/* Decimation factor, 0 or 1 to disable */
+	unsigned int order;	/* CIC order, 1 for a moving average */
+	void (*on_window)(const struct adc_window *w, void *arg);
+	void (*on_decimated)(uint64_t ts, float mv, void *arg);
+	void *arg;
+};
+
+/*
+ * Pipeline between the sampling callback (single producer) and a consumer
+ * thread. All the memory is in the structure, nothing is allocated.
+ */
+struct adc_pipe {
+	/* Ring of samples, written by the producer */
+	int32_t raw[ADC_PIPE_RING_SIZE];
+	uint64_t ts[ADC_PIPE_RING_SIZE];
+	_Atomic uint32_t head __attribute__((aligned(64)));
+	uint64_t dropped;	/* Samples lost because the ring was full */
+
+	/* Read position, written by the consumer */
+	_Atomic uint32_t tail __attribute__((aligned(64)));
+	_Atomic bool sleeping;	/* Consumer waiting on the eventfd */
+	_Atomic bool running;
+	int efd;
+	pthread_t thread;
+	bool started;
+
+	struct adc_pipe_cfg cfg;
+	struct adc_conv conv;
+
+	/* Window statistics */
+	struct adc_window win;
+	double sum, sum_sq;
+
+	/* CIC decimator: integrators and combs, modulo 2^64 */
+	uint64_t integ[ADC_PIPE_MAX_ORDER];
+	uint64_t comb[ADC_PIPE_MAX_ORDER];
+	unsigned int phase;
+	double gain;
+};
+
+/*
+ * adc_pipe_start() - Starts the consumer thread of a pipeline
+ *
+ * @pipe:	Pipeline to start.
+ * @cfg:	Windows, decimation and output callbacks, called from the
+ *		consumer thread.
+ * @adc:	ADC channel, to convert the samples to mV.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int adc_pipe_start(struct adc_pipe *pipe, const struct adc_pipe_cfg *cfg,
+		   adc_t *adc);
+
+/*
+ * adc_pipe_push() - Queues a sample, without blocking or locking
+ *
+ * Must be called from a single thread. The sample is dropped if the ring is
+ * full.
+ *
+ * @pipe:	Pipeline.
+ * @raw:	Raw sample.
+ * @ts:		CLOCK_MONOTONIC time of the sample, in ns.
+ */
+void adc_pipe_push(struct adc_pipe *pipe, int32_t raw, uint64_t ts);
+
+/*
+ * adc_pipe_stop() - Processes the queued samples and stops the pipeline
+ *
+ * The partial window, if any, is emitted.
+ *
+ * @pipe:	Pipeline.
+ */
+void adc_pipe_stop(struct adc_pipe *pipe);
+
+#endif /* ADC_PIPELINE_H_ */
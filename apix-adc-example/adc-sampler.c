@@ -0,0 +1,187 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+#include "adc-sampler.h"
+
+/*
+ * read_scan() - Reads all the channels of a scan sampler
+ *
+ * @s:		Sampler.
+ * @ts:		Deadline of the scan.
+ */
+static void read_scan(struct adc_sampler *s, uint64_t ts)
+{
+	uint64_t read_ts[ADC_SAMPLER_MAX_ADCS];
+	int samples[ADC_SAMPLER_MAX_ADCS];
+	unsigned int i;
+
+	for (i = 0; i < s->nadcs; i++) {
+		samples[i] = ldx_adc_read_sample(s->adcs[i]);
+		read_ts[i] = adc_now_ns();
+	}
+
+	s->scan_cb(samples, read_ts, ts, s->arg);
+}
+
+/*
+ * sampler_thread() - Reads a sample on every deadline
+ *
+ * @arg:	Sampler (struct adc_sampler).
+ */
+static void *sampler_thread(void *arg)
+{
+	struct adc_sampler *s = arg;
+	struct timespec ts;
+	uint64_t deadline, now;
+
+	deadline = adc_now_ns() + s->period_ns;
+
+	for (;;) {
+		ts.tv_sec = deadline / NSEC_PER_SEC;
+		ts.tv_nsec = deadline % NSEC_PER_SEC;
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts,
+				       NULL) == EINTR)
+			;
+
+		if (s->scan_cb)
+			read_scan(s, deadline);
+		else
+			s->cb(ldx_adc_read_sample(s->adc), s->arg);
+
+		/* Skip the deadlines already missed, keep the phase */
+		deadline += s->period_ns;
+		now = adc_now_ns();
+		if (deadline <= now) {
+			uint64_t skip = (now - deadline) / s->period_ns + 1;
+
+			deadline += skip * s->period_ns;
+			s->overruns += skip;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * sampler_run() - Starts the thread of a sampler
+ *
+ * @s:		Sampler, already configured.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int sampler_run(struct adc_sampler *s)
+{
+	int ret;
+
+	ret = pthread_create(&s->thread, NULL, sampler_thread, s);
+	if (ret)
+		return -ret;
+	s->started = true;
+
+	return 0;
+}
+
+int adc_sampler_start(struct adc_sampler *s, adc_t *adc, uint64_t period_ns,
+		      ldx_adc_read_cb_t cb, void *arg)
+{
+	if (!period_ns)
+		return -EINVAL;
+
+	memset(s, 0, sizeof(*s));
+	s->adc = adc;
+	s->period_ns = period_ns;
+	s->cb = cb;
+	s->arg = arg;
+
+	return sampler_run(s);
+}
+
+int adc_sampler_start_scan(struct adc_sampler *s, adc_t **adcs,
+			   unsigned int n, uint64_t period_ns,
+			   adc_scan_cb_t cb, void *arg)
+{
+	if (!period_ns || !n || n > ADC_SAMPLER_MAX_ADCS)
+		return -EINVAL;
+
+	memset(s, 0, sizeof(*s));
+	s->adcs = adcs;
+	s->nadcs = n;
+	s->period_ns = period_ns;
+	s->scan_cb = cb;
+	s->arg = arg;
+
+	return sampler_run(s);
+}
+
+void adc_sampler_stop(struct adc_sampler *s)
+{
+	if (!s->started)
+		return;
+
+	/* The thread only blocks in clock_nanosleep(), a cancellation point */
+	pthread_cancel(s->thread);
+	pthread_join(s->thread, NULL);
+	s->started = false;
+}
+
+void adc_jitter_init(struct adc_jitter *j, uint64_t period_ns)
+{
+	memset(j, 0, sizeof(*j));
+	j->period_ns = period_ns;
+}
+
+void adc_jitter_update(struct adc_jitter *j, uint64_t ts_ns)
+{
+	int64_t dt, dev;
+
+	if (j->count) {
+		dt = ts_ns - j->last;
+		if (j->count == 1 || dt < j->min_dt)
+			j->min_dt = dt;
+		if (dt > j->max_dt)
+			j->max_dt = dt;
+		dev = dt - (int64_t)j->period_ns;
+		j->sum_dev2 += (double)dev * dev;
+	} else {
+		j->first = ts_ns;
+	}
+
+	j->last = ts_ns;
+	j->count++;
+}
+
+void adc_jitter_print(const struct adc_jitter *j, FILE *f)
+{
+	uint64_t intervals = j->count - 1;
+	double secs;
+
+	if (j->count < 2) {
+		fprintf(f, "Not enough samples to compute the sampling rate\n");
+		return;
+	}
+
+	secs = (double)(j->last - j->first) / NSEC_PER_SEC;
+	fprintf(f, "Sampling rate: %.3f Hz (nominal %.3f Hz)\n",
+		intervals / secs, (double)NSEC_PER_SEC / j->period_ns);
+	fprintf(f, "Interval: min %.1f us, avg %.1f us, max %.1f us, "
+		"jitter (RMS) %.1f us\n",
+		j->min_dt / 1e3, secs * 1e6 / intervals, j->max_dt / 1e3,
+		sqrt(j->sum_dev2 / intervals) / 1e3);
+}
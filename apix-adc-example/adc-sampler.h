@@ -0,0 +1,148 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ADC_SAMPLER_H_
+#define ADC_SAMPLER_H_
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "libdigiapix/adc.h"
+
+#define NSEC_PER_SEC		1000000000ULL
+
+#define ADC_SAMPLER_MAX_ADCS	16
+
+/*
+ * Callback of a scan of several channels.
+ *
+ * @samples:	Sample of every channel, negative on error.
+ * @read_ts:	CLOCK_MONOTONIC time at which every read completed, in ns.
+ * @ts:		Time of the scan (its deadline), in ns.
+ * @arg:	Argument given when starting the sampler.
+ */
+typedef void (*adc_scan_cb_t)(const int *samples, const uint64_t *read_ts,
+			      uint64_t ts, void *arg);
+
+/* Sampling thread driven by absolute deadlines */
+struct adc_sampler {
+	adc_t *adc;
+	uint64_t period_ns;
+	ldx_adc_read_cb_t cb;
+	adc_t **adcs;		/* Channels of a scan sampler */
+	unsigned int nadcs;
+	adc_scan_cb_t scan_cb;
+	void *arg;
+	pthread_t thread;
+	bool started;
+	uint64_t overruns;	/* Deadlines skipped because the loop was late */
+};
+
+/* Timing statistics of the samples */
+struct adc_jitter {
+	uint64_t period_ns;	/* Nominal period */
+	uint64_t first, last;
+	uint64_t count;
+	int64_t min_dt, max_dt;
+	double sum_dev2;	/* Sum of the squared deviations from the period */
+};
+
+/*
+ * adc_sampler_start() - Starts sampling a channel with a sub-second period
+ *
+ * Equivalent to ldx_adc_start_sampling() with a period in nanoseconds. The
+ * samples are read from a thread that sleeps until absolute deadlines, so
+ * the reading time and the callback do not add drift to the period.
+ *
+ * @s:		Sampler to start.
+ * @adc:	ADC channel.
+ * @period_ns:	Sampling period, in ns.
+ * @cb:		Function called with every sample.
+ * @arg:	Argument for the callback.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int adc_sampler_start(struct adc_sampler *s, adc_t *adc, uint64_t period_ns,
+		      ldx_adc_read_cb_t cb, void *arg);
+
+/*
+ * adc_sampler_start_scan() - Starts sampling several channels in one tick
+ *
+ * All the channels are read back to back on every deadline, from a single
+ * thread, and reported together with one timestamp.
+ *
+ * @s:		Sampler to start.
+ * @adcs:	ADC channels, the array must remain valid while sampling.
+ * @n:		Number of channels, up to ADC_SAMPLER_MAX_ADCS.
+ * @period_ns:	Sampling period, in ns.
+ * @cb:		Function called with every scan.
+ * @arg:	Argument for the callback.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int adc_sampler_start_scan(struct adc_sampler *s, adc_t **adcs,
+			   unsigned int n, uint64_t period_ns,
+			   adc_scan_cb_t cb, void *arg);
+
+/*
+ * adc_sampler_stop() - Stops a sampler
+ *
+ * @s:		Sampler.
+ */
+void adc_sampler_stop(struct adc_sampler *s);
+
+/*
+ * adc_jitter_init() - Initializes the timing statistics
+ *
+ * @j:		Statistics.
+ * @period_ns:	Nominal sampling period, in ns.
+ */
+void adc_jitter_init(struct adc_jitter *j, uint64_t period_ns);
+
+/*
+ * adc_jitter_update() - Accounts the time of a sample
+ *
+ * @j:		Statistics.
+ * @ts_ns:	CLOCK_MONOTONIC time of the sample, in ns.
+ */
+void adc_jitter_update(struct adc_jitter *j, uint64_t ts_ns);
+
+/*
+ * adc_jitter_print() - Prints the achieved rate and the jitter
+ *
+ * @j:		Statistics.
+ * @f:		Output stream.
+ */
+void adc_jitter_print(const struct adc_jitter *j, FILE *f);
+
+/*
+ * adc_now_ns() - Returns the monotonic time in nanoseconds
+ *
+ * Return: The current CLOCK_MONOTONIC time in ns.
+ */
+static inline uint64_t adc_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+#endif /* ADC_SAMPLER_H_ */
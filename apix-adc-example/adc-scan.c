@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adc-scan.h"
+
+#define CACHE_LINE		64
+
+int adc_scan_buf_init(struct adc_scan_buf *buf, unsigned int nchannels,
+		      size_t capacity)
+{
+	size_t stride;
+	unsigned int i;
+	int ret;
+
+	if (!nchannels || nchannels > ADC_IIO_MAX_CHANNELS || !capacity)
+		return -EINVAL;
+
+	memset(buf, 0, sizeof(*buf));
+
+	/* Keep every array aligned to a cache line */
+	stride = (capacity * sizeof(int32_t) + CACHE_LINE - 1) &
+		 ~(size_t)(CACHE_LINE - 1);
+	if (stride / sizeof(int32_t) < capacity)
+		return -EOVERFLOW;
+
+	ret = posix_memalign(&buf->mem, CACHE_LINE,
+			     capacity * sizeof(uint64_t) + nchannels * stride +
+			     CACHE_LINE);
+	if (ret)
+		return -ret;
+
+	buf->nchannels = nchannels;
+	buf->capacity = capacity;
+	buf->ts = buf->mem;
+	buf->data[0] = (int32_t *)(((uintptr_t)(buf->ts + capacity) +
+				    CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1));
+	for (i = 1; i < nchannels; i++)
+		buf->data[i] = (int32_t *)((uint8_t *)buf->data[i - 1] + stride);
+
+	return 0;
+}
+
+int adc_scan_buf_append(struct adc_scan_buf *buf, const int *samples,
+			uint64_t ts)
+{
+	unsigned int i;
+
+	if (buf->count == buf->capacity)
+		return -ENOSPC;
+
+	buf->ts[buf->count] = ts;
+	for (i = 0; i < buf->nchannels; i++)
+		buf->data[i][buf->count] = samples[i];
+	buf->count++;
+
+	return 0;
+}
+
+size_t adc_scan_buf_append_iio(struct adc_scan_buf *buf,
+			       const struct adc_iio *iio, const uint8_t *scans,
+			       size_t n)
+{
+	const uint8_t *scan;
+	unsigned int i;
+	size_t s;
+
+	if (n > buf->capacity - buf->count)
+		n = buf->capacity - buf->count;
+
+	/* One channel at a time, so every column is written sequentially */
+	for (i = 0; i < buf->nchannels; i++) {
+		int32_t *col = buf->data[i] + buf->count;
+
+		for (s = 0, scan = scans; s < n; s++, scan += iio->scan_size)
+			col[s] = adc_iio_sample(iio, scan, i);
+	}
+
+	for (s = 0, scan = scans; s < n; s++, scan += iio->scan_size)
+		buf->ts[buf->count + s] = adc_iio_timestamp(iio, scan);
+
+	buf->count += n;
+
+	return n;
+}
+
+void adc_scan_buf_free(struct adc_scan_buf *buf)
+{
+	free(buf->mem);
+	memset(buf, 0, sizeof(*buf));
+}
+
+void adc_skew_init(struct adc_skew *sk, unsigned int nchannels)
+{
+	memset(sk, 0, sizeof(*sk));
+	sk->nchannels = nchannels;
+}
+
+void adc_skew_update(struct adc_skew *sk, const uint64_t *read_ts,
+		     uint64_t ts)
+{
+	uint64_t delay, spread;
+	unsigned int i;
+
+	for (i = 0; i < sk->nchannels; i++) {
+		delay = read_ts[i] > ts ? read_ts[i] - ts : 0;
+		sk->sum[i] += delay;
+		if (delay > sk->max[i])
+			sk->max[i] = delay;
+	}
+
+	spread = read_ts[sk->nchannels - 1] - read_ts[0];
+	if (spread > sk->max_spread)
+		sk->max_spread = spread;
+	sk->count++;
+}
+
+void adc_skew_print(const struct adc_skew *sk, const unsigned int *channels,
+		    FILE *f)
+{
+	double first;
+	unsigned int i;
+
+	if (!sk->count)
+		return;
+
+	first = sk->sum[0] / sk->count;
+	fprintf(f, "Inter-channel skew (%llu scans):\n",
+		(unsigned long long)sk->count);
+	for (i = 0; i < sk->nchannels; i++)
+		fprintf(f, "  ch%-2u read %8.1f us after the tick (max %8.1f us), "
+			"skew %+8.1f us\n", channels[i],
+			sk->sum[i] / sk->count / 1e3, sk->max[i] / 1e3,
+			(sk->sum[i] / sk->count - first) / 1e3);
+	fprintf(f, "  Maximum spread of a scan: %.1f us\n",
+		sk->max_spread / 1e3);
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ADC_SCAN_H_
+#define ADC_SCAN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "adc-iio.h"
+
+/*
+ * Buffer of scans stored as a struct of arrays: one timestamp array and one
+ * contiguous, cache line aligned array per channel.
+ */
+struct adc_scan_buf {
+	unsigned int nchannels;
+	size_t capacity;		/* Scans */
+	size_t count;
+	uint64_t *ts;			/* Time of every scan, in ns */
+	int32_t *data[ADC_IIO_MAX_CHANNELS];
+	void *mem;
+};
+
+/* Delay of the read of every channel from the time of the scan */
+struct adc_skew {
+	unsigned int nchannels;
+	uint64_t count;
+	double sum[ADC_IIO_MAX_CHANNELS];	/* From the scan time */
+	uint64_t max[ADC_IIO_MAX_CHANNELS];
+	uint64_t max_spread;		/* Between the first and last channel */
+};
+
+/*
+ * adc_scan_buf_init() - Allocates a buffer of scans
+ *
+ * @buf:	Buffer to initialize.
+ * @nchannels:	Channels of every scan.
+ * @capacity:	Number of scans.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int adc_scan_buf_init(struct adc_scan_buf *buf, unsigned int nchannels,
+		      size_t capacity);
+
+/*
+ * adc_scan_buf_append() - Appends a scan to a buffer
+ *
+ * @buf:	Buffer.
+ * @samples:	Sample of every channel.
+ * @ts:		Time of the scan.
+ *
+ * Return: 0 on success, -ENOSPC if the buffer is full.
+ */
+int adc_scan_buf_append(struct adc_scan_buf *buf, const int *samples,
+			uint64_t ts);
+
+/*
+ * adc_scan_buf_append_iio() - Appends the scans of an IIO capture to a buffer
+ *
+ * The samples are deinterleaved directly from the scans of the device.
+ *
+ * @buf:	Buffer, with the channels of the capture.
+ * @iio:	Capture.
+ * @scans:	Scans read with adc_iio_read().
+ * @n:		Number of scans.
+ *
+ * Return: The number of scans appended, fewer than n if the buffer is full.
+ */
+size_t adc_scan_buf_append_iio(struct adc_scan_buf *buf,
+			       const struct adc_iio *iio, const uint8_t *scans,
+			       size_t n);
+
+/*
+ * adc_scan_buf_free() - Frees a buffer of scans
+ *
+ * @buf:	Buffer.
+ */
+void adc_scan_buf_free(struct adc_scan_buf *buf);
+
+/*
+ * adc_skew_init() - Initializes the inter-channel skew statistics
+ *
+ * @sk:		Statistics.
+ * @nchannels:	Channels of every scan.
+ */
+void adc_skew_init(struct adc_skew *sk, unsigned int nchannels);
+
+/*
+ * adc_skew_update() - Accounts the read times of a scan
+ *
+ * @sk:		Statistics.
+ * @read_ts:	Time at which the read of every channel completed.
+ * @ts:		Time of the scan.
+ */
+void adc_skew_update(struct adc_skew *sk, const uint64_t *read_ts,
+		     uint64_t ts);
+
+/*
+ * adc_skew_print() - Prints the inter-channel skew report
+ *
+ * @sk:		Statistics.
+ * @channels:	Channel number of every position of the scan.
+ * @f:		Output stream.
+ */
+void adc_skew_print(const struct adc_skew *sk, const unsigned int *channels,
+		    FILE *f);
+
+#endif /* ADC_SCAN_H_ */
@@ -0,0 +1,475 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "adc-seglog.h"
+
+#define SEG_NAME_FMT		"adc-%08llu.seg"
+#define NSEGS			3
+
+_Static_assert(sizeof(struct adc_seg_hdr) <= ADC_SEG_HDR_SIZE,
+	       "segment header too large");
+
+/*
+ * seg_path() - Builds the path of a segment file
+ *
+ * @log:	Log.
+ * @seq:	Segment number.
+ * @path:	Buffer of PATH_MAX bytes.
+ */
+static void seg_path(const struct adc_seglog *log, uint64_t seq, char *path)
+{
+	int len;
+
+	len = snprintf(path, PATH_MAX, "%s/", log->dir);
+	snprintf(path + len, PATH_MAX - len, SEG_NAME_FMT,
+		 (unsigned long long)seq);
+}
+
+/*
+ * scan_dir() - Continues the numbering of the segments of the directory
+ *
+ * The segments that exceed the number of files to keep are deleted.
+ *
+ * @log:	Log.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int scan_dir(struct adc_seglog *log)
+{
+	char path[PATH_MAX];
+	unsigned long long seq;
+	struct dirent *de;
+	DIR *d;
+
+	d = opendir(log->dir);
+	if (!d)
+		return -errno;
+
+	log->next_seq = 0;
+	while ((de = readdir(d)))
+		if (sscanf(de->d_name, SEG_NAME_FMT, &seq) == 1 &&
+		    seq >= log->next_seq)
+			log->next_seq = seq + 1;
+
+	rewinddir(d);
+	while ((de = readdir(d))) {
+		if (sscanf(de->d_name, SEG_NAME_FMT, &seq) != 1 ||
+		    seq + log->cfg.keep >= log->next_seq)
+			continue;
+		seg_path(log, seq, path);
+		unlink(path);
+	}
+	closedir(d);
+
+	return 0;
+}
+
+/*
+ * seg_prepare() - Creates and maps the next segment file
+ *
+ * @log:	Log.
+ * @seg:	Free segment slot.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int seg_prepare(struct adc_seglog *log, struct adc_seg *seg)
+{
+	const struct adc_seglog_cfg *cfg = &log->cfg;
+	uint64_t seq = log->next_seq;
+	struct adc_seg_hdr *hdr;
+	char path[PATH_MAX];
+	unsigned int i;
+	int ret;
+
+	seg_path(log, seq, path);
+	seg->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (seg->fd < 0)
+		return -errno;
+
+	/* Allocate the blocks now, a write to a hole of the mapping could fail */
+	ret = posix_fallocate(seg->fd, 0, cfg->seg_size);
+	if (ret)
+		goto err;
+
+	seg->map = mmap(NULL, cfg->seg_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED, seg->fd, 0);
+	if (seg->map == MAP_FAILED) {
+		ret = errno;
+		goto err;
+	}
+
+	seg->hdr = hdr = (struct adc_seg_hdr *)seg->map;
+	seg->data = seg->map + ADC_SEG_HDR_SIZE;
+	seg->capacity = (cfg->seg_size - ADC_SEG_HDR_SIZE) / log->scan_size;
+	atomic_store(&seg->written, 0);
+	seg->synced = 0;
+
+	memcpy(hdr->magic, ADC_SEG_MAGIC, sizeof(hdr->magic));
+	hdr->version = ADC_SEG_VERSION;
+	hdr->nchannels = cfg->nchannels;
+	hdr->hdr_size = ADC_SEG_HDR_SIZE;
+	hdr->scan_size = log->scan_size;
+	hdr->seq = seq;
+	hdr->capacity = seg->capacity;
+	hdr->index_step = (seg->capacity + ADC_SEG_INDEX_LEN - 1) /
+			  ADC_SEG_INDEX_LEN;
+	hdr->rate = cfg->rate;
+	for (i = 0; i < cfg->nchannels; i++) {
+		hdr->channels[i] = log->channels[i];
+		hdr->scale[i] = log->scale[i];
+		hdr->offset[i] = log->offset[i];
+	}
+	msync(seg->map, ADC_SEG_HDR_SIZE, MS_SYNC);
+
+	/* Rotate out the oldest segment, the new one is not used yet */
+	if (seq > cfg->keep) {
+		seg_path(log, seq - cfg->keep - 1, path);
+		unlink(path);
+	}
+
+	log->next_seq++;
+	atomic_store(&seg->state, ADC_SEG_READY);
+
+	return 0;
+
+err:
+	close(seg->fd);
+	seg_path(log, seq, path);
+	unlink(path);
+
+	return -ret;
+}
+
+/*
+ * seg_sync() - Syncs the scans written to a segment and commits them
+ *
+ * The count of the header is only updated once the scans are in storage, so
+ * after a power loss the header never covers scans that were not written.
+ *
+ * @log:	Log.
+ * @seg:	Active or full segment.
+ */
+static void seg_sync(struct adc_seglog *log, struct adc_seg *seg)
+{
+	uint64_t written = atomic_load_explicit(&seg->written,
+						memory_order_acquire);
+	long page = sysconf(_SC_PAGESIZE);
+	size_t start, end;
+
+	if (written == seg->synced)
+		return;
+
+	start = (ADC_SEG_HDR_SIZE + seg->synced * log->scan_size) &
+		~(size_t)(page - 1);
+	end = ADC_SEG_HDR_SIZE + written * log->scan_size;
+	if (msync(seg->map + start, end - start, MS_SYNC)) {
+		log->error = -errno;
+		return;
+	}
+
+	seg->hdr->count = written;
+	msync(seg->map, ADC_SEG_HDR_SIZE, MS_SYNC);
+	seg->synced = written;
+}
+
+/*
+ * seg_close() - Syncs and unmaps a segment
+ *
+ * @log:	Log.
+ * @seg:	Active or full segment.
+ */
+static void seg_close(struct adc_seglog *log, struct adc_seg *seg)
+{
+	seg_sync(log, seg);
+	seg->hdr->closed = 1;
+	msync(seg->map, ADC_SEG_HDR_SIZE, MS_SYNC);
+
+	munmap(seg->map, log->cfg.seg_size);
+	close(seg->fd);
+	atomic_store(&seg->state, ADC_SEG_FREE);
+}
+
+/*
+ * seg_discard() - Deletes a segment that was never used
+ *
+ * @log:	Log.
+ * @seg:	Ready segment.
+ */
+static void seg_discard(struct adc_seglog *log, struct adc_seg *seg)
+{
+	char path[PATH_MAX];
+
+	seg_path(log, seg->hdr->seq, path);
+	munmap(seg->map, log->cfg.seg_size);
+	close(seg->fd);
+	unlink(path);
+	atomic_store(&seg->state, ADC_SEG_FREE);
+}
+
+/*
+ * seglog_maintain() - Syncs, closes and preallocates the segments
+ *
+ * @log:	Log.
+ */
+static void seglog_maintain(struct adc_seglog *log)
+{
+	struct adc_seg *free_seg = NULL;
+	bool ready = false;
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < NSEGS; i++) {
+		struct adc_seg *seg = &log->segs[i];
+
+		switch (atomic_load(&seg->state)) {
+		case ADC_SEG_FULL:
+			seg_close(log, seg);
+			free_seg = seg;
+			break;
+		case ADC_SEG_ACTIVE:
+			seg_sync(log, seg);
+			break;
+		case ADC_SEG_READY:
+			ready = true;
+			break;
+		default:
+			free_seg = seg;
+			break;
+		}
+	}
+
+	if (!ready && free_seg) {
+		ret = seg_prepare(log, free_seg);
+		if (ret)
+			log->error = ret;
+	}
+}
+
+/*
+ * seglog_thread() - Background maintenance of the log
+ *
+ * @arg:	Log (struct adc_seglog).
+ */
+static void *seglog_thread(void *arg)
+{
+	struct adc_seglog *log = arg;
+	struct pollfd pfd = { .fd = log->efd, .events = POLLIN };
+	uint64_t val;
+
+	while (atomic_load(&log->running)) {
+		if (poll(&pfd, 1, log->cfg.sync_ms) > 0 &&
+		    read(log->efd, &val, sizeof(val)) < 0)
+			break;
+		seglog_maintain(log);
+	}
+
+	return NULL;
+}
+
+/*
+ * seglog_wake() - Wakes up the background thread
+ *
+ * @log:	Log.
+ */
+static void seglog_wake(struct adc_seglog *log)
+{
+	uint64_t val = 1;
+
+	if (write(log->efd, &val, sizeof(val)) < 0)
+		log->error = -errno;
+}
+
+/*
+ * seglog_activate() - Starts writing to the ready segment
+ *
+ * @log:	Log.
+ * @ts:		Time of the first scan.
+ *
+ * Return: The new active segment, NULL if none is ready.
+ */
+static struct adc_seg *seglog_activate(struct adc_seglog *log, uint64_t ts)
+{
+	struct adc_seg *seg;
+	struct timespec now_rt, now_mono;
+	unsigned int i;
+
+	for (i = 0; i < NSEGS; i++) {
+		seg = &log->segs[(log->cur + i) % NSEGS];
+		if (atomic_load_explicit(&seg->state, memory_order_acquire) ==
+		    ADC_SEG_READY)
+			break;
+	}
+	if (i == NSEGS)
+		return NULL;
+
+	clock_gettime(CLOCK_REALTIME, &now_rt);
+	clock_gettime(CLOCK_MONOTONIC, &now_mono);
+	seg->hdr->start_monotonic = ts;
+	seg->hdr->start_realtime = now_rt.tv_sec * 1000000000LL +
+				   now_rt.tv_nsec -
+				   (now_mono.tv_sec * 1000000000LL +
+				    now_mono.tv_nsec - (int64_t)ts);
+
+	log->cur = (log->cur + i) % NSEGS;
+	atomic_store(&seg->state, ADC_SEG_ACTIVE);
+
+	/* Preallocate the next segment */
+	seglog_wake(log);
+
+	return seg;
+}
+
+int adc_seglog_open(struct adc_seglog *log, const struct adc_seglog_cfg *cfg)
+{
+	unsigned int i;
+	int ret;
+
+	if (!cfg->nchannels || cfg->nchannels > ADC_IIO_MAX_CHANNELS ||
+	    !cfg->keep || !cfg->sync_ms)
+		return -EINVAL;
+
+	memset(log, 0, sizeof(*log));
+	log->cfg = *cfg;
+	log->scan_size = cfg->nchannels * sizeof(int32_t);
+	if (cfg->seg_size < ADC_SEG_HDR_SIZE + ADC_SEG_INDEX_LEN * log->scan_size)
+		return -EINVAL;
+	for (i = 0; i < NSEGS; i++)
+		atomic_store(&log->segs[i].state, ADC_SEG_FREE);
+
+	/* Keep a copy of the arrays of the configuration */
+	for (i = 0; i < cfg->nchannels; i++) {
+		log->channels[i] = cfg->channels[i];
+		log->scale[i] = cfg->scale ? cfg->scale[i] : 1;
+		log->offset[i] = cfg->offset ? cfg->offset[i] : 0;
+	}
+	log->cfg.channels = log->channels;
+	log->cfg.scale = log->scale;
+	log->cfg.offset = log->offset;
+
+	log->dir = strdup(cfg->dir);
+	if (!log->dir)
+		return -ENOMEM;
+	log->cfg.dir = log->dir;
+
+	ret = scan_dir(log);
+	if (!ret)
+		ret = seg_prepare(log, &log->segs[0]);
+	if (ret)
+		goto err;
+
+	log->efd = eventfd(0, EFD_CLOEXEC);
+	if (log->efd < 0) {
+		ret = -errno;
+		seg_discard(log, &log->segs[0]);
+		goto err;
+	}
+
+	atomic_store(&log->running, true);
+	ret = pthread_create(&log->thread, NULL, seglog_thread, log);
+	if (ret) {
+		ret = -ret;
+		close(log->efd);
+		seg_discard(log, &log->segs[0]);
+		goto err;
+	}
+	log->started = true;
+
+	return 0;
+
+err:
+	free(log->dir);
+	log->dir = NULL;
+
+	return ret;
+}
+
+void adc_seglog_append(struct adc_seglog *log, const int32_t *samples,
+		       uint64_t ts)
+{
+	struct adc_seg *seg = &log->segs[log->cur];
+	uint64_t w;
+
+	if (atomic_load_explicit(&seg->state, memory_order_relaxed) !=
+	    ADC_SEG_ACTIVE) {
+		seg = seglog_activate(log, ts);
+		if (!seg) {
+			log->dropped++;
+			return;
+		}
+	}
+
+	w = atomic_load_explicit(&seg->written, memory_order_relaxed);
+	if (w == seg->capacity) {
+		atomic_store(&seg->state, ADC_SEG_FULL);
+		seg = seglog_activate(log, ts);
+		if (!seg) {
+			log->dropped++;
+			return;
+		}
+		w = 0;
+	}
+
+	memcpy(seg->data + w * log->scan_size, samples, log->scan_size);
+	if (w % seg->hdr->index_step == 0)
+		seg->hdr->index[w / seg->hdr->index_step] = ts;
+	atomic_store_explicit(&seg->written, w + 1, memory_order_release);
+}
+
+void adc_seglog_close(struct adc_seglog *log)
+{
+	unsigned int i;
+
+	if (!log->started)
+		return;
+
+	atomic_store(&log->running, false);
+	seglog_wake(log);
+	pthread_join(log->thread, NULL);
+	close(log->efd);
+	log->started = false;
+
+	for (i = 0; i < NSEGS; i++) {
+		struct adc_seg *seg = &log->segs[i];
+
+		switch (atomic_load(&seg->state)) {
+		case ADC_SEG_ACTIVE:
+		case ADC_SEG_FULL:
+			seg_close(log, seg);
+			break;
+		case ADC_SEG_READY:
+			seg_discard(log, seg);
+			break;
+		default:
+			break;
+		}
+	}
+
+	free(log->dir);
+	log->dir = NULL;
+}
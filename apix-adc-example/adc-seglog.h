@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ADC_SEGLOG_H_
+#define ADC_SEGLOG_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "adc-iio.h"
+
+#define ADC_SEG_MAGIC		"DSEG"
+#define ADC_SEG_VERSION		1
+#define ADC_SEG_HDR_SIZE	4096
+#define ADC_SEG_INDEX_LEN	448
+
+#define ADC_SEG_DEF_SIZE_MB	16
+#define ADC_SEG_DEF_KEEP	8
+#define ADC_SEG_DEF_SYNC_MS	1000
+
+/*
+ * Header of a segment file, in the first ADC_SEG_HDR_SIZE bytes and in
+ * native byte order. It is followed by 'capacity' scans of 'nchannels'
+ * int32_t raw samples. Only the first 'count' scans are valid: the count is
+ * updated after the scans are synced to storage.
+ */
+struct adc_seg_hdr {
+	char magic[4];
+	uint16_t version;
+	uint16_t nchannels;
+	uint32_t hdr_size;
+	uint32_t scan_size;		/* Bytes */
+	uint64_t seq;			/* Segment number */
+	uint64_t capacity;		/* Scans */
+	uint64_t count;			/* Scans synced to storage */
+	uint32_t index_step;		/* Scans between index entries */
+	uint32_t closed;		/* The segment was completed */
+	int64_t start_realtime;		/* Time of the first scan, in ns */
+	uint64_t start_monotonic;
+	double rate;			/* Nominal scans per second */
+	uint8_t channels[ADC_IIO_MAX_CHANNELS];
+	float scale[ADC_IIO_MAX_CHANNELS];	/* mV = raw * scale + offset */
+	float offset[ADC_IIO_MAX_CHANNELS];
+	uint64_t index[ADC_SEG_INDEX_LEN];	/* Monotonic time of scan i * step */
+};
+
+struct adc_seglog_cfg {
+	const char *dir;
+	uint64_t seg_size;		/* Bytes per segment file */
+	unsigned int keep;		/* Segment files to keep */
+	unsigned int sync_ms;		/* Time between syncs */
+	unsigned int nchannels;
+	const unsigned int *channels;
+	const float *scale;		/* mV per LSB of every channel, or NULL */
+	const float *offset;		/* mV of a raw value of 0, or NULL */
+	double rate;
+};
+
+enum adc_seg_state {
+	ADC_SEG_FREE,
+	ADC_SEG_READY,			/* Preallocated, waiting to be used */
+	ADC_SEG_ACTIVE,			/* Being written */
+	ADC_SEG_FULL,			/* Waiting to be closed */
+};
+
+struct adc_seg {
+	_Atomic int state;
+	int fd;
+	uint8_t *map;
+	struct adc_seg_hdr *hdr;
+	uint8_t *data;
+	uint64_t capacity;
+	_Atomic uint64_t written;	/* Scans copied to the mapping */
+	uint64_t synced;		/* Scans synced to storage */
+};
+
+/*
+ * Rolling log of ADC scans. A single writer copies the scans into the
+ * mapping of the active segment; a background thread syncs them
+ * periodically, closes the full segments, deletes the oldest ones and
+ * preallocates the next one.
+ */
+struct adc_seglog {
+	struct adc_seglog_cfg cfg;
+	char *dir;
+	unsigned int channels[ADC_IIO_MAX_CHANNELS];
+	float scale[ADC_IIO_MAX_CHANNELS];
+	float offset[ADC_IIO_MAX_CHANNELS];
+	struct adc_seg segs[3];
+	unsigned int cur;
+	uint64_t next_seq;
+	uint32_t scan_size;
+	uint64_t dropped;		/* Scans lost with no segment ready */
+	int efd;
+	_Atomic bool running;
+	pthread_t thread;
+	bool started;
+	int error;			/* Last error of the background thread */
+};
+
+/*
+ * adc_seglog_open() - Opens a rolling log of scans
+ *
+ * The first segment is preallocated before returning.
+ *
+ * @log:	Log to open.
+ * @cfg:	Log configuration.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int adc_seglog_open(struct adc_seglog *log, const struct adc_seglog_cfg *cfg);
+
+/*
+ * adc_seglog_append() - Appends a scan to the log
+ *
+ * Must be called from a single thread. It never blocks: the scan is copied
+ * into the mapping of the active segment, and dropped if the segment is
+ * full and the next one is not ready yet.
+ *
+ * @log:	Log.
+ * @samples:	Raw sample of every channel.
+ * @ts:		CLOCK_MONOTONIC time of the scan, in ns.
+ */
+void adc_seglog_append(struct adc_seglog *log, const int32_t *samples,
+		       uint64_t ts);
+
+/*
+ * adc_seglog_close() - Syncs the pending scans and closes the log
+ *
+ * @log:	Log.
+ */
+void adc_seglog_close(struct adc_seglog *log);
+
+#endif /* ADC_SEGLOG_H_ */
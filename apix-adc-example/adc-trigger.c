@@ -0,0 +1,256 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adc-trigger.h"
+
+#define MIN_RING_SIZE		64
+#define BLOCK			8	/* Samples evaluated without branches */
+
+/*
+ * hit() - Evaluates the trigger condition on a pair of samples
+ *
+ * @mode:	Trigger mode.
+ * @lo:		Threshold, lower limit of the window.
+ * @hi:		Upper limit of the window.
+ * @p:		Previous sample.
+ * @x:		Current sample.
+ *
+ * Return: 1 if the trigger fires at the current sample, 0 otherwise.
+ */
+static inline unsigned int hit(enum adc_trig_mode mode, int32_t lo, int32_t hi,
+			       int32_t p, int32_t x)
+{
+	switch (mode) {
+	case ADC_TRIG_RISING:
+		return (p < lo) & (x >= lo);
+	case ADC_TRIG_FALLING:
+		return (p > lo) & (x <= lo);
+	default:
+		return (p >= lo) & (p <= hi) & ((x < lo) | (x > hi));
+	}
+}
+
+/*
+ * find() - Finds the first trigger in a range of samples of the ring
+ *
+ * The conditions of a block of samples are combined in a mask without
+ * branches, only the mask is tested. Inlined with a constant mode, so
+ * every mode gets its own loop.
+ *
+ * @trig:	Engine.
+ * @a:		First sample to evaluate, greater than 0.
+ * @b:		End of the range.
+ * @mode:	Trigger mode.
+ *
+ * Return: The sample of the trigger, 'b' if there is none.
+ */
+static inline __attribute__((always_inline))
+uint64_t find(const struct adc_trig *trig, uint64_t a, uint64_t b,
+	      enum adc_trig_mode mode)
+{
+	const int32_t *r = trig->ring;
+	const uint32_t m = trig->mask;
+	const int32_t lo = trig->cfg.level, hi = trig->cfg.high;
+	unsigned int hits, k;
+	uint64_t i;
+
+	for (i = a; i + BLOCK <= b; i += BLOCK) {
+		hits = 0;
+		for (k = 0; k < BLOCK; k++)
+			hits |= hit(mode, lo, hi, r[(i + k - 1) & m],
+				    r[(i + k) & m]) << k;
+		if (hits)
+			return i + __builtin_ctz(hits);
+	}
+
+	for (; i < b; i++)
+		if (hit(mode, lo, hi, r[(i - 1) & m], r[i & m]))
+			return i;
+
+	return b;
+}
+
+/*
+ * find_trigger() - Finds the first trigger in a range of samples
+ *
+ * @trig:	Engine.
+ * @a:		First sample to evaluate, greater than 0.
+ * @b:		End of the range.
+ *
+ * Return: The sample of the trigger, 'b' if there is none.
+ */
+static uint64_t find_trigger(const struct adc_trig *trig, uint64_t a,
+			     uint64_t b)
+{
+	switch (trig->cfg.mode) {
+	case ADC_TRIG_RISING:
+		return find(trig, a, b, ADC_TRIG_RISING);
+	case ADC_TRIG_FALLING:
+		return find(trig, a, b, ADC_TRIG_FALLING);
+	default:
+		return find(trig, a, b, ADC_TRIG_WINDOW);
+	}
+}
+
+/*
+ * ring_copy() - Copies samples out of the ring
+ *
+ * @trig:	Engine.
+ * @from:	First sample.
+ * @n:		Number of samples.
+ * @out:	Destination buffer.
+ */
+static void ring_copy(const struct adc_trig *trig, uint64_t from, size_t n,
+		      int32_t *out)
+{
+	uint32_t pos = from & trig->mask;
+	size_t first = trig->mask + 1 - pos;
+
+	if (first > n)
+		first = n;
+	memcpy(out, trig->ring + pos, first * sizeof(*out));
+	memcpy(out + first, trig->ring, (n - first) * sizeof(*out));
+}
+
+/*
+ * emit_event() - Passes the captured event to the callback
+ *
+ * @trig:	Engine.
+ */
+static void emit_event(struct adc_trig *trig)
+{
+	struct adc_trig_event ev = {
+		.seq = trig->events++,
+		.index = trig->trigger,
+		.ts = trig->ring_ts[trig->trigger & trig->mask],
+		.pre = trig->cfg.pre,
+		.post = trig->cfg.post,
+		.samples = trig->event_buf,
+	};
+
+	ring_copy(trig, trig->trigger - ev.pre, ev.pre + ev.post,
+		  trig->event_buf);
+	trig->cfg.on_event(&ev, trig->cfg.arg);
+}
+
+/*
+ * evaluate() - Runs the trigger state machine over the new samples
+ *
+ * @trig:	Engine.
+ */
+static void evaluate(struct adc_trig *trig)
+{
+	uint64_t start;
+
+	for (;;) {
+		if (trig->state == ADC_TRIG_CAPTURING) {
+			if (trig->total < trig->trigger + trig->cfg.post)
+				return;
+			emit_event(trig);
+			trig->state = ADC_TRIG_ARMED;
+			trig->search = trig->trigger + (trig->cfg.post ? : 1);
+		}
+
+		/* A trigger needs its pre-trigger samples and a previous one */
+		start = trig->search;
+		if (start < trig->cfg.pre)
+			start = trig->cfg.pre;
+		if (start < 1)
+			start = 1;
+		if (start >= trig->total) {
+			trig->search = start;
+			return;
+		}
+
+		trig->search = find_trigger(trig, start, trig->total);
+		if (trig->search == trig->total)
+			return;
+
+		trig->trigger = trig->search;
+		trig->state = ADC_TRIG_CAPTURING;
+	}
+}
+
+int adc_trig_init(struct adc_trig *trig, const struct adc_trig_cfg *cfg)
+{
+	uint32_t span = cfg->pre + cfg->post, size = MIN_RING_SIZE;
+
+	if (!span || span > ADC_TRIG_MAX_SAMPLES || !cfg->on_event ||
+	    (cfg->mode == ADC_TRIG_WINDOW && cfg->high < cfg->level))
+		return -EINVAL;
+
+	memset(trig, 0, sizeof(*trig));
+	trig->cfg = *cfg;
+
+	/* Room for the event and for the chunk being added */
+	while (size < 2 * span)
+		size <<= 1;
+	trig->mask = size - 1;
+	trig->chunk = size - span;
+
+	trig->ring = malloc(size * sizeof(*trig->ring));
+	trig->ring_ts = calloc(size, sizeof(*trig->ring_ts));
+	trig->event_buf = malloc(span * sizeof(*trig->event_buf));
+	if (!trig->ring || !trig->ring_ts || !trig->event_buf) {
+		adc_trig_free(trig);
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+void adc_trig_process(struct adc_trig *trig, const int32_t *samples,
+		      const uint64_t *ts, size_t n)
+{
+	uint32_t pos, first;
+	size_t c;
+
+	while (n) {
+		c = n < trig->chunk ? n : trig->chunk;
+		pos = trig->total & trig->mask;
+		first = trig->mask + 1 - pos;
+		if (first > c)
+			first = c;
+
+		memcpy(trig->ring + pos, samples, first * sizeof(*samples));
+		memcpy(trig->ring, samples + first, (c - first) * sizeof(*samples));
+		if (ts) {
+			memcpy(trig->ring_ts + pos, ts, first * sizeof(*ts));
+			memcpy(trig->ring_ts, ts + first, (c - first) * sizeof(*ts));
+			ts += c;
+		}
+		trig->total += c;
+
+		evaluate(trig);
+
+		samples += c;
+		n -= c;
+	}
+}
+
+void adc_trig_free(struct adc_trig *trig)
+{
+	free(trig->ring);
+	free(trig->ring_ts);
+	free(trig->event_buf);
+	trig->ring = NULL;
+	trig->ring_ts = NULL;
+	trig->event_buf = NULL;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ADC_TRIGGER_H_
+#define ADC_TRIGGER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ADC_TRIG_MAX_SAMPLES	(1 << 20)	/* Pre + post samples */
+
+enum adc_trig_mode {
+	ADC_TRIG_RISING,	/* Crosses 'level' upwards */
+	ADC_TRIG_FALLING,	/* Crosses 'level' downwards */
+	ADC_TRIG_WINDOW,	/* Leaves the [level, high] window */
+};
+
+/* Captured event, valid during the callback */
+struct adc_trig_event {
+	uint64_t seq;		/* Event number */
+	uint64_t index;		/* Sample number of the trigger */
+	uint64_t ts;		/* Time of the trigger sample, 0 if unknown */
+	unsigned int pre;	/* Samples before the trigger */
+	unsigned int post;	/* Samples from the trigger on */
+	const int32_t *samples;	/* pre + post samples */
+};
+
+struct adc_trig_cfg {
+	enum adc_trig_mode mode;
+	int32_t level;		/* Raw threshold, lower limit of the window */
+	int32_t high;		/* Upper limit of the window */
+	unsigned int pre;
+	unsigned int post;
+	void (*on_event)(const struct adc_trig_event *ev, void *arg);
+	void *arg;
+};
+
+enum adc_trig_state {
+	ADC_TRIG_ARMED,
+	ADC_TRIG_CAPTURING,
+};
+
+/*
+ * Trigger engine. The samples go through a ring that always holds the
+ * pre-trigger history; all the memory is allocated by adc_trig_init().
+ */
+struct adc_trig {
+	struct adc_trig_cfg cfg;
+	int32_t *ring;
+	uint64_t *ring_ts;
+	uint32_t mask;
+	uint32_t chunk;		/* Samples processed at once */
+	uint64_t total;		/* Samples received */
+	uint64_t search;	/* Next sample to evaluate */
+	uint64_t trigger;	/* Sample of the trigger being captured */
+	enum adc_trig_state state;
+	int32_t *event_buf;
+	uint64_t events;
+};
+
+/*
+ * adc_trig_init() - Allocates a trigger engine
+ *
+ * @trig:	Engine to initialize.
+ * @cfg:	Trigger configuration.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int adc_trig_init(struct adc_trig *trig, const struct adc_trig_cfg *cfg);
+
+/*
+ * adc_trig_process() - Evaluates a batch of samples
+ *
+ * The callback of the configuration is called, from this function, for
+ * every completed event. No memory is allocated.
+ *
+ * @trig:	Engine.
+ * @samples:	Raw samples.
+ * @ts:		Time of every sample, or NULL.
+ * @n:		Number of samples.
+ */
+void adc_trig_process(struct adc_trig *trig, const int32_t *samples,
+		      const uint64_t *ts, size_t n);
+
+/*
+ * adc_trig_free() - Frees a trigger engine
+ *
+ * @trig:	Engine.
+ */
+void adc_trig_free(struct adc_trig *trig);
+
+#endif /* ADC_TRIGGER_H_ */
@@ -15,15 +15,28 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <libgen.h>
 #include <limits.h>
+#include <math.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "libdigiapix/adc.h"
 
+#include "adc-convert.h"
+#include "adc-iio.h"
+#include "adc-pipeline.h"
+#include "adc-sampler.h"
+#include "adc-scan.h"
+#include "adc-seglog.h"
+#include "adc-trigger.h"
+
 #define ARG_ADC_CHIP			0
 #define ARG_ADC_CHANNEL			1
 
@@ -31,13 +44,57 @@
 #define DEFAULT_TIME_INTERVAl		1
 #define DEFAULT_NUMBER_OF_SAMPLES	10
 
+/* Reads per second in streaming mode */
+#define STREAM_READS_PER_SEC		20
+#define STREAM_MAX_BATCH		4096
+
+/* Samples saved before and after a trigger */
+#define DEFAULT_TRIG_SAMPLES		100
+
+/* Scans kept in memory in multi-channel mode */
+#define SCAN_BUF_MAX_SCANS		65536
+
 struct adc_sampling_cb_data {
 	adc_t *adc;
 	int number_of_samples;
+	pthread_mutex_t lock;
+	pthread_cond_t done;		/* Signaled with the last sample */
+	struct adc_jitter jitter;
+	struct adc_pipe *pipe;		/* NULL to print every sample */
+	struct adc_skew skew;		/* Multi-channel sampling */
+	struct adc_seglog *log;		/* NULL if not logging to files */
+	struct adc_trig *trig;		/* NULL if the trigger is disabled */
+};
+
+struct trigger_opts {
+	bool enabled;
+	struct adc_trig_cfg cfg;
+	float level_mv, high_mv;
+	const char *file;		/* NULL to print the events */
 };
 
 static adc_t *adc;
-struct adc_sampling_cb_data cb_data;
+struct adc_sampling_cb_data cb_data = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+static struct adc_sampler sampler;
+static struct adc_pipe stats_pipe;
+static adc_t *scan_adcs[ADC_IIO_MAX_CHANNELS];
+static unsigned int nscan_adcs;
+static struct adc_scan_buf scan_buf;
+static struct adc_seglog seglog;
+static struct trigger_opts trig_opts = {
+	.cfg = {
+		.pre = DEFAULT_TRIG_SAMPLES,
+		.post = DEFAULT_TRIG_SAMPLES,
+	},
+};
+static struct adc_trig trig;
+static struct adc_conv trig_conv;
+static FILE *trig_file;
+static uint64_t start_ns;
+static struct adc_iio iio = { .fd = -1 };
+static bool streaming = false;
 
 /*
  * usage_and_exit() - Show usage information and exit with 'exitval' return
@@ -56,20 +113,52 @@ static void usage_and_exit(char *name, int exitval)
 		"                     %d seconds is used as Interval\n"
 		"                     %d is used as Samples\n"
 		"\n"
-		"Usage: %s <adc-alias> <interval> <number_of_samples>\n"
+		"Usage: %s [options] <adc-alias> <interval> <number_of_samples>\n"
 		"<adc-alias>          ADC alias\n"
-		"<interval>           Time interval for sampling\n"
+		"<interval>           Time interval for sampling in seconds, decimals\n"
+		"                     or ms/us units are allowed (e.g. 10ms)\n"
 		"<number_of_samples>  Number of samples to get\n"
 		"\n"
-		"Usage: %s <adc-chip> <adc-channel> <interval> <number_of_samples>\n"
+		"Usage: %s [options] <adc-chip> <adc-channel> <interval> <number_of_samples>\n"
 		"<adc-chip-number>    ADC chip number\n"
 		"<adc-channel-number> ADC channel number\n"
-		"<interval>           Time interval for sampling\n"
+		"<interval>           Time interval for sampling in seconds, decimals\n"
+		"                     or ms/us units are allowed (e.g. 10ms)\n"
 		"<number_of_samples>  Number of samples to get\n"
 		"\n"
+		"Options:\n"
+		"-S <rate>            Stream the samples from the IIO triggered buffer\n"
+		"                     at <rate> scans/s (<interval> is ignored and\n"
+		"                     <number_of_samples> is the number of scans)\n"
+		"-c <channels>        Comma-separated list of additional channels to\n"
+		"                     sample (or stream) in the same scans\n"
+		"-T <trigger>         IIO trigger to stream with (default: the current\n"
+		"                     trigger of the ADC)\n"
+		"-w <file>            Write the streamed scans to a binary file\n"
+		"-W <samples>         Print the min/max/mean/RMS of windows of <samples>\n"
+		"                     instead of every sample\n"
+		"-D <factor>          Decimate the samples by <factor>\n"
+		"-N <order>           Order of the CIC decimation filter (default 1,\n"
+		"                     a moving average; up to %d)\n"
+		"-L <dir>             Log the samples to rolling segment files in <dir>\n"
+		"                     instead of printing them\n"
+		"-Z <MB>              Size of every segment file (default %d MB)\n"
+		"-K <count>           Segment files to keep (default %d)\n"
+		"-t <trigger>         Only save the samples around trigger events:\n"
+		"                     rising:<mV>, falling:<mV> or window:<mV>:<mV>\n"
+		"                     (first channel in streaming mode)\n"
+		"-p <pre>[,<post>]    Samples saved before and after every trigger\n"
+		"                     (default %d,%d)\n"
+		"-e <file>            Write the trigger events to <file>\n"
+		"-B <samples>         Benchmark the batch conversion to mV against\n"
+		"                     the per-sample conversion (e.g. 10000000)\n"
+		"-h                   Help\n"
+		"\n"
 		"Alias for ADC can be configured in the library config file\n"
 		"\n", name, DEFAULT_ADC_ALIAS, DEFAULT_TIME_INTERVAl,
-		      DEFAULT_NUMBER_OF_SAMPLES, name, name);
+		      DEFAULT_NUMBER_OF_SAMPLES, name, name, ADC_PIPE_MAX_ORDER,
+		      ADC_SEG_DEF_SIZE_MB, ADC_SEG_DEF_KEEP, DEFAULT_TRIG_SAMPLES,
+		      DEFAULT_TRIG_SAMPLES);
 
 	exit(exitval);
 }
@@ -79,9 +168,30 @@ static void usage_and_exit(char *name, int exitval)
  */
 static void cleanup(void)
 {
+	if (streaming) {
+		adc_iio_close(&iio);
+		streaming = false;
+	}
+
+	adc_sampler_stop(&sampler);
+	adc_pipe_stop(&stats_pipe);
+	adc_seglog_close(&seglog);
+
+	adc_trig_free(&trig);
+	if (trig_file && trig_file != stdout)
+		fclose(trig_file);
+	trig_file = NULL;
+
+	while (nscan_adcs)
+		ldx_adc_free(scan_adcs[--nscan_adcs]);
+	adc_scan_buf_free(&scan_buf);
+
 	/* Free adc */
-	ldx_adc_stop_sampling(adc);
-	ldx_adc_free(adc);
+	if (adc) {
+		ldx_adc_stop_sampling(adc);
+		ldx_adc_free(adc);
+		adc = NULL;
+	}
 }
 
 /*
@@ -155,6 +265,7 @@ static int parse_argument(char *argv, int arg_type)
 static int adc_sampling_cb(int sample, void *arg)
 {
 	struct adc_sampling_cb_data *data = arg;
+	uint64_t ts = adc_now_ns();
 	float sample_mv = 0;
 
 	if (sample < 0) {
@@ -163,7 +274,26 @@ static int adc_sampling_cb(int sample, void *arg)
 		return EXIT_FAILURE;
 	}
 
-	data->number_of_samples--;
+	pthread_mutex_lock(&data->lock);
+	if (data->number_of_samples <= 0) {
+		/* The sampling is being stopped */
+		pthread_mutex_unlock(&data->lock);
+		return EXIT_SUCCESS;
+	}
+	adc_jitter_update(&data->jitter, ts);
+	if (--data->number_of_samples == 0)
+		pthread_cond_signal(&data->done);
+	pthread_mutex_unlock(&data->lock);
+
+	if (data->log)
+		adc_seglog_append(data->log, &sample, ts);
+	if (data->pipe)
+		adc_pipe_push(data->pipe, sample, ts);
+	if (data->trig)
+		adc_trig_process(data->trig, &sample, &ts, 1);
+	if (data->log || data->pipe || data->trig)
+		return EXIT_SUCCESS;
+
 	sample_mv = ldx_adc_convert_sample_to_mv(data->adc, sample);
 
 	printf("ADC sample acquired: %d (raw) - %2.f (mV)\n", sample, sample_mv);
@@ -171,29 +301,808 @@ static int adc_sampling_cb(int sample, void *arg)
 	return EXIT_SUCCESS;
 }
 
+/*
+ * adc_scan_cb() - ADC callback for multi-channel sampling
+ *
+ * @samples:	Sample of every channel.
+ * @read_ts:	Time at which every read completed.
+ * @ts:		Time of the scan.
+ * @arg:	ADC sampling data (struct adc_sampling_cb_data).
+ */
+static void adc_scan_cb(const int *samples, const uint64_t *read_ts,
+			uint64_t ts, void *arg)
+{
+	struct adc_sampling_cb_data *data = arg;
+	unsigned int i;
+
+	pthread_mutex_lock(&data->lock);
+	if (data->number_of_samples <= 0) {
+		/* The sampling is being stopped */
+		pthread_mutex_unlock(&data->lock);
+		return;
+	}
+	adc_jitter_update(&data->jitter, read_ts[0]);
+	adc_skew_update(&data->skew, read_ts, ts);
+	adc_scan_buf_append(&scan_buf, samples, ts);
+	if (--data->number_of_samples == 0)
+		pthread_cond_signal(&data->done);
+	pthread_mutex_unlock(&data->lock);
+
+	if (data->log) {
+		adc_seglog_append(data->log, samples, ts);
+		return;
+	}
+
+	printf("ADC scan acquired:");
+	for (i = 0; i < nscan_adcs; i++) {
+		if (samples[i] < 0)
+			printf(" [error %d]", samples[i]);
+		else
+			printf(" %d (%2.f mV)", samples[i],
+			       ldx_adc_convert_sample_to_mv(scan_adcs[i],
+							    samples[i]));
+	}
+	printf("\n");
+}
+
+/*
+ * print_window() - Prints the statistics of a window of samples
+ *
+ * @w:		Window statistics.
+ * @arg:	Unused.
+ */
+static void print_window(const struct adc_window *w, void *arg)
+{
+	printf("[%10.3f s] %u samples: min %.1f mV, max %.1f mV, "
+	       "mean %.1f mV, RMS %.1f mV\n", (w->ts - start_ns) / 1e9,
+	       w->count, w->min, w->max, w->mean, w->rms);
+}
+
+/*
+ * print_decimated() - Prints a decimated sample
+ *
+ * @ts:		Time of the last input sample.
+ * @mv:		Decimated sample, in mV.
+ * @arg:	Unused.
+ */
+static void print_decimated(uint64_t ts, float mv, void *arg)
+{
+	printf("[%10.3f s] Decimated sample: %.2f mV\n",
+	       (ts - start_ns) / 1e9, mv);
+}
+
+/*
+ * write_event() - Writes the samples of a trigger event
+ *
+ * @ev:		Trigger event.
+ * @arg:	Unused.
+ */
+static void write_event(const struct adc_trig_event *ev, void *arg)
+{
+	unsigned int i;
+	int32_t raw;
+
+	fprintf(trig_file, "# Event %llu: trigger at sample %llu, %.6f s\n",
+		(unsigned long long)ev->seq, (unsigned long long)ev->index,
+		ev->ts ? (ev->ts - start_ns) / 1e9 : 0);
+	for (i = 0; i < ev->pre + ev->post; i++) {
+		raw = ev->samples[i];
+		fprintf(trig_file, "%d %d %.1f\n", (int)i - (int)ev->pre, raw,
+			raw * trig_conv.scale[0] + trig_conv.offset[0]);
+	}
+	fflush(trig_file);
+}
+
+/*
+ * parse_trigger() - Parses a trigger specification
+ *
+ * @str:	rising:<mV>, falling:<mV> or window:<mV>:<mV>.
+ * @opts:	Trigger options to fill.
+ *
+ * Return: 0 on success, -1 on error.
+ */
+static int parse_trigger(const char *str, struct trigger_opts *opts)
+{
+	const char *arg = strchr(str, ':');
+	char *end;
+
+	if (!arg)
+		return -1;
+
+	if (!strncmp(str, "rising:", 7))
+		opts->cfg.mode = ADC_TRIG_RISING;
+	else if (!strncmp(str, "falling:", 8))
+		opts->cfg.mode = ADC_TRIG_FALLING;
+	else if (!strncmp(str, "window:", 7))
+		opts->cfg.mode = ADC_TRIG_WINDOW;
+	else
+		return -1;
+
+	opts->level_mv = strtof(arg + 1, &end);
+	if (end == arg + 1)
+		return -1;
+	if (opts->cfg.mode == ADC_TRIG_WINDOW) {
+		if (*end != ':')
+			return -1;
+		arg = end + 1;
+		opts->high_mv = strtof(arg, &end);
+		if (end == arg || opts->high_mv < opts->level_mv)
+			return -1;
+	}
+
+	return *end ? -1 : 0;
+}
+
+/*
+ * parse_trigger_samples() - Parses the number of samples of the events
+ *
+ * @str:	<pre>[,<post>].
+ * @cfg:	Trigger configuration to fill.
+ *
+ * Return: 0 on success, -1 on error.
+ */
+static int parse_trigger_samples(const char *str, struct adc_trig_cfg *cfg)
+{
+	char *end;
+
+	cfg->pre = strtoul(str, &end, 10);
+	if (*end == ',')
+		cfg->post = strtoul(end + 1, &end, 10);
+
+	return *end || !(cfg->pre + cfg->post) ? -1 : 0;
+}
+
+/*
+ * start_trigger() - Starts the trigger engine
+ *
+ * The thresholds are converted to raw values with 'trig_conv', which must
+ * be initialized.
+ *
+ * Return: 0 on success, -1 on error.
+ */
+static int start_trigger(void)
+{
+	struct adc_trig_cfg *cfg = &trig_opts.cfg;
+	int ret;
+
+	cfg->level = lroundf((trig_opts.level_mv - trig_conv.offset[0]) /
+			     trig_conv.scale[0]);
+	cfg->high = lroundf((trig_opts.high_mv - trig_conv.offset[0]) /
+			    trig_conv.scale[0]);
+	cfg->on_event = write_event;
+
+	trig_file = trig_opts.file ? fopen(trig_opts.file, "w") : stdout;
+	if (!trig_file) {
+		printf("Unable to open '%s' (%s)\n", trig_opts.file,
+		       strerror(errno));
+		return -1;
+	}
+
+	ret = adc_trig_init(&trig, cfg);
+	if (ret) {
+		printf("Failed to start the trigger (%s)\n", strerror(-ret));
+		return -1;
+	}
+	cb_data.trig = &trig;
+
+	return 0;
+}
+
+/*
+ * parse_interval() - Parses a sampling interval
+ *
+ * @str:	Interval in seconds, or with a "ms" or "us" suffix.
+ *
+ * Return: The interval in ns, 0 on error.
+ */
+static uint64_t parse_interval(const char *str)
+{
+	double value;
+	char *end;
+
+	value = strtod(str, &end);
+	if (end == str || value <= 0)
+		return 0;
+
+	if (!strcmp(end, "ms"))
+		value /= 1e3;
+	else if (!strcmp(end, "us"))
+		value /= 1e6;
+	else if (*end && strcmp(end, "s"))
+		return 0;
+
+	return value * NSEC_PER_SEC;
+}
+
+/*
+ * wait_samples() - Waits until all the samples have been acquired
+ *
+ * @data:	ADC sampling data.
+ */
+static void wait_samples(struct adc_sampling_cb_data *data)
+{
+	struct timespec ts;
+	int ret;
+
+	pthread_mutex_lock(&data->lock);
+	while (data->number_of_samples > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		ts.tv_sec++;
+		ret = pthread_cond_timedwait(&data->done, &data->lock, &ts);
+		if (ret == ETIMEDOUT && data->number_of_samples > 0)
+			printf("Waiting for samples, %d samples remaining\n",
+			       data->number_of_samples);
+	}
+	pthread_mutex_unlock(&data->lock);
+}
+
+/*
+ * parse_channels() - Parses a comma-separated list of channels
+ *
+ * @str:	List of channels.
+ * @channels:	Array to append the channels to.
+ * @n:		Number of channels in the array, updated.
+ *
+ * Return: 0 on success, -1 on error.
+ */
+static int parse_channels(const char *str, unsigned int *channels,
+			  unsigned int *n)
+{
+	char *end;
+
+	while (*str) {
+		if (*n == ADC_IIO_MAX_CHANNELS)
+			return -1;
+
+		channels[(*n)++] = strtoul(str, &end, 10);
+		if (end == str || (*end && *end != ','))
+			return -1;
+		str = *end ? end + 1 : end;
+	}
+
+	return 0;
+}
+
+/*
+ * write_all() - Writes a buffer to a file, retrying partial writes
+ *
+ * @fd:		File descriptor.
+ * @buf:	Data to write.
+ * @len:	Length of the data.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int write_all(int fd, const void *buf, size_t len)
+{
+	const uint8_t *p = buf;
+	ssize_t n;
+
+	while (len) {
+		n = write(fd, p, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		p += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+/*
+ * stream_samples() - Captures scans from the IIO triggered buffer
+ *
+ * The scans are read in large batches. They are either written to a file
+ * exactly as the device provides them or reduced to a per-second summary,
+ * nothing is printed per sample.
+ *
+ * @chip:	ADC chip.
+ * @channels:	Channels to capture.
+ * @nchannels:	Number of channels.
+ * @cfg:	Capture configuration.
+ * @file:	Capture file, NULL to print a summary every second.
+ * @nscans:	Number of scans to capture.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int stream_samples(unsigned int chip, const unsigned int *channels,
+			  unsigned int nchannels, const struct adc_iio_cfg *cfg,
+			  const char *file, unsigned long nscans)
+{
+	int32_t min[ADC_IIO_MAX_CHANNELS], max[ADC_IIO_MAX_CHANNELS];
+	uint64_t start, last, now, total = 0, second = 0;
+	struct adc_jitter ts_jitter;
+	const uint8_t *scans;
+	int out_fd = -1, ret = EXIT_FAILURE;
+	unsigned int i;
+	ssize_t n, s;
+
+	ret = adc_iio_open(&iio, chip, channels, nchannels, cfg);
+	if (ret) {
+		printf("Failed to enable the IIO buffer of ADC %u (%s)\n", chip,
+		       strerror(-ret));
+		return EXIT_FAILURE;
+	}
+	streaming = true;
+	ret = EXIT_FAILURE;
+
+	if (file) {
+		out_fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (out_fd < 0 || adc_iio_write_hdr(&iio, out_fd)) {
+			printf("Unable to write capture file '%s' (%s)\n", file,
+			       strerror(errno));
+			goto out;
+		}
+	} else {
+		ret = adc_scan_buf_init(&scan_buf, nchannels, iio.batch);
+		if (ret) {
+			printf("Unable to allocate memory for the samples\n");
+			ret = EXIT_FAILURE;
+			goto out;
+		}
+		ret = EXIT_FAILURE;
+
+		if (trig_opts.enabled) {
+			adc_conv_init_iio(&trig_conv, &iio);
+			if (start_trigger())
+				goto out;
+		}
+	}
+	adc_jitter_init(&ts_jitter, NSEC_PER_SEC / (iio.rate ? iio.rate :
+						    cfg->rate));
+
+	printf("Streaming %u channel(s) of ADC %u, %u bytes per scan%s...\n",
+	       nchannels, chip, iio.scan_size,
+	       iio.ts_offset >= 0 ? " (with timestamp)" : "");
+
+	start = last = adc_now_ns();
+	for (i = 0; i < nchannels; i++) {
+		min[i] = INT32_MAX;
+		max[i] = INT32_MIN;
+	}
+
+	while (total < nscans) {
+		n = adc_iio_read(&iio, &scans);
+		if (n < 0) {
+			printf("Failed to read the IIO buffer (%s)\n",
+			       strerror(-n));
+			goto out;
+		}
+		if ((unsigned long)n > nscans - total)
+			n = nscans - total;
+
+		if (out_fd >= 0) {
+			if (write_all(out_fd, scans, (size_t)n * iio.scan_size)) {
+				printf("Failed to write capture file\n");
+				goto out;
+			}
+		} else {
+			scan_buf.count = 0;
+			adc_scan_buf_append_iio(&scan_buf, &iio, scans, n);
+			if (cb_data.trig)
+				adc_trig_process(cb_data.trig, scan_buf.data[0],
+						 iio.ts_offset >= 0 ?
+						 scan_buf.ts : NULL, n);
+			for (i = 0; i < nchannels; i++) {
+				const int32_t *col = scan_buf.data[i];
+
+				for (s = 0; s < n; s++) {
+					if (col[s] < min[i])
+						min[i] = col[s];
+					if (col[s] > max[i])
+						max[i] = col[s];
+				}
+			}
+		}
+		for (s = 0; iio.ts_offset >= 0 && s < n; s++)
+			adc_jitter_update(&ts_jitter, adc_iio_timestamp(&iio,
+					  scans + s * iio.scan_size));
+		total += n;
+		second += n;
+
+		now = adc_now_ns();
+		if (now - last >= 1000000000ULL) {
+			printf("%llu scans, %.0f scans/s",
+			       (unsigned long long)total,
+			       second * 1e9 / (now - last));
+			for (i = 0; out_fd < 0 && i < nchannels; i++) {
+				const struct adc_iio_chan *c = &iio.chans[i];
+
+				printf(", ch%u %.0f-%.0f mV", c->channel,
+				       (min[i] + c->raw_offset) * c->scale,
+				       (max[i] + c->raw_offset) * c->scale);
+				min[i] = INT32_MAX;
+				max[i] = INT32_MIN;
+			}
+			printf("\n");
+			last = now;
+			second = 0;
+		}
+	}
+
+	now = adc_now_ns();
+	printf("Captured %llu scans in %.3f s (%.0f scans/s)\n",
+	       (unsigned long long)total, (now - start) / 1e9,
+	       total * 1e9 / (now - start));
+	/*
+	 * The buffer only has one timestamp per scan. Sequential converters
+	 * sample the channels one after the other, but all within the scan,
+	 * so the shortest interval between scans bounds the skew.
+	 */
+	if (nchannels > 1 && iio.ts_offset >= 0 && ts_jitter.count > 1)
+		printf("Inter-channel skew: not measurable from the buffer (one "
+		       "timestamp per scan), below %.1f us (shortest scan "
+		       "interval)\n", ts_jitter.min_dt / 1e3);
+	else if (nchannels > 1)
+		printf("Inter-channel skew: not measurable from the buffer\n");
+	if (iio.ts_offset >= 0) {
+		printf("Scan timestamps: ");
+		adc_jitter_print(&ts_jitter, stdout);
+	}
+	if (cb_data.trig)
+		printf("%llu trigger events captured\n",
+		       (unsigned long long)trig.events);
+	ret = EXIT_SUCCESS;
+
+out:
+	if (out_fd >= 0)
+		close(out_fd);
+	adc_scan_buf_free(&scan_buf);
+	adc_iio_close(&iio);
+	streaming = false;
+
+	return ret;
+}
+
+/*
+ * open_seglog() - Opens the log of samples
+ *
+ * @cfg:	Log configuration, completed with the channels.
+ * @adcs:	ADC channels.
+ * @channels:	Channel numbers.
+ * @n:		Number of channels.
+ * @interval_ns: Sampling interval.
+ *
+ * Return: 0 on success, -1 on error.
+ */
+static int open_seglog(struct adc_seglog_cfg *cfg, adc_t **adcs,
+		       const unsigned int *channels, unsigned int n,
+		       uint64_t interval_ns)
+{
+	struct adc_conv conv;
+	unsigned int i;
+	int ret;
+
+	/* Store the coefficients to convert the raw samples to mV */
+	adc_conv_init(&conv, n);
+	for (i = 0; i < n; i++)
+		adc_conv_set_from_adc(&conv, i, adcs[i]);
+
+	cfg->nchannels = n;
+	cfg->channels = channels;
+	cfg->scale = conv.scale;
+	cfg->offset = conv.offset;
+	cfg->rate = (double)NSEC_PER_SEC / interval_ns;
+
+	ret = adc_seglog_open(&seglog, cfg);
+	if (ret) {
+		printf("Unable to open the log in '%s' (%s)\n", cfg->dir,
+		       strerror(-ret));
+		return -1;
+	}
+	cb_data.log = &seglog;
+
+	return 0;
+}
+
+/*
+ * close_seglog() - Closes the log of samples and prints its summary
+ *
+ * @dir:	Directory of the log.
+ */
+static void close_seglog(const char *dir)
+{
+	if (!cb_data.log)
+		return;
+
+	adc_seglog_close(&seglog);
+	printf("Samples logged to '%s'", dir);
+	if (seglog.dropped)
+		printf(", %llu scans dropped",
+		       (unsigned long long)seglog.dropped);
+	if (seglog.error)
+		printf(", error: %s", strerror(-seglog.error));
+	printf("\n");
+	cb_data.log = NULL;
+}
+
+/*
+ * sample_scans() - Samples several channels through sysfs in the same ticks
+ *
+ * @chip:	ADC chip.
+ * @channels:	Channels to sample.
+ * @nchannels:	Number of channels.
+ * @interval_ns: Sampling interval.
+ * @nscans:	Number of scans to get.
+ * @log_cfg:	Configuration of the log of samples, NULL to print them.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int sample_scans(unsigned int chip, const unsigned int *channels,
+			unsigned int nchannels, uint64_t interval_ns,
+			unsigned int nscans, struct adc_seglog_cfg *log_cfg)
+{
+	struct adc_conv conv;
+	unsigned int i;
+	size_t s;
+	int ret;
+
+	for (i = 0; i < nchannels; i++) {
+		scan_adcs[i] = ldx_adc_request(chip, channels[i]);
+		if (!scan_adcs[i]) {
+			printf("Failed to initialize ADC channel %u\n",
+			       channels[i]);
+			return EXIT_FAILURE;
+		}
+		nscan_adcs++;
+	}
+
+	/* Long captures only keep the first scans in memory */
+	if (nscans > SCAN_BUF_MAX_SCANS)
+		nscans = SCAN_BUF_MAX_SCANS;
+	ret = adc_scan_buf_init(&scan_buf, nchannels, nscans);
+	if (ret) {
+		printf("Unable to allocate memory for %u scans\n", nscans);
+		return EXIT_FAILURE;
+	}
+	adc_skew_init(&cb_data.skew, nchannels);
+
+	if (log_cfg && open_seglog(log_cfg, scan_adcs, channels, nchannels,
+				   interval_ns))
+		return EXIT_FAILURE;
+
+	ret = adc_sampler_start_scan(&sampler, scan_adcs, nchannels,
+				     interval_ns, &adc_scan_cb, &cb_data);
+	if (ret) {
+		printf("Failed to initialize the sampling data\n");
+		return EXIT_FAILURE;
+	}
+
+	wait_samples(&cb_data);
+	adc_sampler_stop(&sampler);
+	if (log_cfg)
+		close_seglog(log_cfg->dir);
+
+	adc_jitter_print(&cb_data.jitter, stdout);
+	if (sampler.overruns)
+		printf("Overruns: %llu sampling deadlines missed\n",
+		       (unsigned long long)sampler.overruns);
+	adc_skew_print(&cb_data.skew, channels, stdout);
+
+	/* Per-channel averages, every channel is a contiguous array */
+	adc_conv_init(&conv, nchannels);
+	for (i = 0; i < nchannels; i++) {
+		const int32_t *col = scan_buf.data[i];
+		double sum = 0;
+
+		adc_conv_set_from_adc(&conv, i, scan_adcs[i]);
+		for (s = 0; s < scan_buf.count; s++)
+			sum += col[s];
+		printf("ch%u: mean %.1f mV\n", channels[i],
+		       sum / scan_buf.count * conv.scale[i] + conv.offset[i]);
+	}
+
+	return EXIT_SUCCESS;
+}
+
+/*
+ * bench_convert() - Compares the batch conversion with the library one
+ *
+ * @adc:	ADC channel.
+ * @n:		Number of samples to convert.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int bench_convert(adc_t *adc, size_t n)
+{
+	struct adc_conv conv;
+	uint64_t t0, t_lib, t_batch;
+	int32_t *raw;
+	float *mv_lib, *mv_batch, err = 0;
+	uint32_t x = 0x12345678;
+	int ret = EXIT_FAILURE;
+	size_t i;
+
+	raw = malloc(n * sizeof(*raw));
+	mv_lib = malloc(n * sizeof(*mv_lib));
+	mv_batch = malloc(n * sizeof(*mv_batch));
+	if (!raw || !mv_lib || !mv_batch) {
+		printf("Unable to allocate memory for %zu samples\n", n);
+		goto out;
+	}
+
+	if (adc_conv_init(&conv, 1) || adc_conv_set_from_adc(&conv, 0, adc)) {
+		printf("The conversion of the ADC is not linear\n");
+		goto out;
+	}
+
+	/* 12-bit pseudo-random samples */
+	for (i = 0; i < n; i++) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		raw[i] = x & 0xfff;
+	}
+
+	/* Do not account the page faults of the first write */
+	memset(mv_lib, 0, n * sizeof(*mv_lib));
+	memset(mv_batch, 0, n * sizeof(*mv_batch));
+
+	printf("Converting %zu samples...\n", n);
+
+	t0 = adc_now_ns();
+	for (i = 0; i < n; i++)
+		mv_lib[i] = ldx_adc_convert_sample_to_mv(adc, raw[i]);
+	t_lib = adc_now_ns() - t0;
+
+	t0 = adc_now_ns();
+	adc_conv_run(&conv, raw, mv_batch, n);
+	t_batch = adc_now_ns() - t0;
+
+	for (i = 0; i < n; i++) {
+		float d = mv_lib[i] - mv_batch[i];
+
+		if (d < 0)
+			d = -d;
+		if (d > err)
+			err = d;
+	}
+
+	printf("Per-sample (library): %8.3f ms, %8.2f Msamples/s\n",
+	       t_lib / 1e6, n * 1e3 / t_lib);
+	printf("Batch (%s):%*s %8.3f ms, %8.2f Msamples/s\n", adc_conv_impl(),
+	       (int)(13 - strlen(adc_conv_impl())), "", t_batch / 1e6,
+	       n * 1e3 / t_batch);
+	printf("Speedup: %.1fx, max difference %g mV\n",
+	       (double)t_lib / t_batch, err);
+	ret = EXIT_SUCCESS;
+
+out:
+	free(raw);
+	free(mv_lib);
+	free(mv_batch);
+
+	return ret;
+}
+
 int main(int argc, char *argv[])
 {
-	int channel = 0, chip = 0, interval = 0, number_of_samples = 0;
+	int channel = 0, chip = 0, number_of_samples = 0;
+	uint64_t interval_ns = 0;
 	char *name = basename(argv[0]);
+	unsigned int channels[ADC_IIO_MAX_CHANNELS], nchannels = 1;
+	struct adc_iio_cfg stream_cfg = {
+		.buffer_len = ADC_IIO_DEF_BUFFER_LEN,
+	};
+	char *extra_channels = NULL, *stream_file = NULL;
+	unsigned long bench_samples = 0;
+	struct adc_seglog_cfg log_cfg = {
+		.seg_size = ADC_SEG_DEF_SIZE_MB << 20,
+		.keep = ADC_SEG_DEF_KEEP,
+		.sync_ms = ADC_SEG_DEF_SYNC_MS,
+	};
+	struct adc_pipe_cfg pipe_cfg = {
+		.order = 1,
+		.on_window = print_window,
+		.on_decimated = print_decimated,
+	};
+	pthread_condattr_t cond_attr;
+	int opt, nargs, ret;
+
+	while ((opt = getopt(argc, argv, "S:c:T:w:W:D:N:L:Z:K:t:p:e:B:h")) > 0) {
+		switch (opt) {
+		case 'S':
+			stream_cfg.rate = strtod(optarg, NULL);
+			if (stream_cfg.rate <= 0) {
+				printf("Streaming rate must be greater than 0\n");
+				return EXIT_FAILURE;
+			}
+			break;
+
+		case 'c':
+			extra_channels = optarg;
+			break;
+
+		case 'T':
+			stream_cfg.trigger = optarg;
+			break;
+
+		case 'w':
+			stream_file = optarg;
+			break;
+
+		case 'W':
+			pipe_cfg.window = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'D':
+			pipe_cfg.decim = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'N':
+			pipe_cfg.order = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'L':
+			log_cfg.dir = optarg;
+			break;
+
+		case 'Z':
+			log_cfg.seg_size = strtoull(optarg, NULL, 10) << 20;
+			break;
+
+		case 'K':
+			log_cfg.keep = strtoul(optarg, NULL, 10);
+			break;
+
+		case 't':
+			if (parse_trigger(optarg, &trig_opts)) {
+				printf("Invalid trigger '%s'\n", optarg);
+				return EXIT_FAILURE;
+			}
+			trig_opts.enabled = true;
+			break;
+
+		case 'p':
+			if (parse_trigger_samples(optarg, &trig_opts.cfg)) {
+				printf("Invalid number of trigger samples\n");
+				return EXIT_FAILURE;
+			}
+			break;
+
+		case 'e':
+			trig_opts.file = optarg;
+			break;
+
+		case 'B':
+			bench_samples = strtoul(optarg, NULL, 10);
+			if (!bench_samples) {
+				printf("Number of samples must be greater than 0\n");
+				return EXIT_FAILURE;
+			}
+			break;
+
+		case 'h':
+			usage_and_exit(name, EXIT_SUCCESS);
+			break;
+
+		default:
+			usage_and_exit(name, EXIT_FAILURE);
+		}
+	}
+	argv += optind - 1;
+	nargs = argc - optind;
 
 	/* Check input parameters */
-	if (argc == 1) {
+	if (nargs == 0) {
 		/* Use default values */
 		chip = ldx_adc_get_chip(DEFAULT_ADC_ALIAS);
 		channel = ldx_adc_get_channel(DEFAULT_ADC_ALIAS);
-		interval = DEFAULT_TIME_INTERVAl;
+		interval_ns = DEFAULT_TIME_INTERVAl * NSEC_PER_SEC;
 		number_of_samples = DEFAULT_NUMBER_OF_SAMPLES;
-	} else if (argc == 4) {
+	} else if (nargs == 3) {
 		/* Parse command line arguments */
 		chip = parse_argument(argv[1], ARG_ADC_CHIP);
 		channel = parse_argument(argv[1], ARG_ADC_CHANNEL);
-		interval = atoi(argv[2]);
+		interval_ns = parse_interval(argv[2]);
 		number_of_samples = atoi(argv[3]);
-	} else if (argc == 5) {
+	} else if (nargs == 4) {
 		/* Parse command line arguments */
 		chip = parse_argument(argv[1], ARG_ADC_CHIP);
 		channel = parse_argument(argv[2], ARG_ADC_CHANNEL);
-		interval = atoi(argv[3]);
+		interval_ns = parse_interval(argv[3]);
 		number_of_samples = atoi(argv[4]);
 	} else {
 		usage_and_exit(name, EXIT_FAILURE);
@@ -209,7 +1118,7 @@ int main(int argc, char *argv[])
 		return EXIT_FAILURE;
 	}
 
-	if (interval <= 0) {
+	if (!interval_ns) {
 		printf("Time interval must be greater than 0\n");
 		return EXIT_FAILURE;
 	}
@@ -220,11 +1129,59 @@ int main(int argc, char *argv[])
 	}
 
 	cb_data.number_of_samples = number_of_samples;
+	adc_jitter_init(&cb_data.jitter, interval_ns);
+
+	/* The timeouts of the wait must not depend on the wall clock */
+	pthread_condattr_init(&cond_attr);
+	pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&cb_data.done, &cond_attr);
+	pthread_condattr_destroy(&cond_attr);
 
 	/* Register signals and exit cleanup function */
 	atexit(cleanup);
 	register_signals();
 
+	channels[0] = channel;
+	if (extra_channels &&
+	    parse_channels(extra_channels, channels, &nchannels)) {
+		printf("Invalid channel list (up to %d channels)\n",
+		       ADC_IIO_MAX_CHANNELS);
+		return EXIT_FAILURE;
+	}
+
+	if (stream_cfg.rate > 0) {
+		if (log_cfg.dir) {
+			printf("Use -w to save the streamed scans\n");
+			return EXIT_FAILURE;
+		}
+		if (stream_file && trig_opts.enabled) {
+			printf("The trigger can't be used with -w\n");
+			return EXIT_FAILURE;
+		}
+
+		stream_cfg.batch = stream_cfg.rate / STREAM_READS_PER_SEC;
+		if (stream_cfg.batch < 1)
+			stream_cfg.batch = 1;
+		if (stream_cfg.batch > STREAM_MAX_BATCH)
+			stream_cfg.batch = STREAM_MAX_BATCH;
+
+		return stream_samples(chip, channels, nchannels, &stream_cfg,
+				      stream_file, number_of_samples);
+	}
+
+	if (nchannels > 1) {
+		if (pipe_cfg.window || pipe_cfg.decim > 1 || bench_samples ||
+		    trig_opts.enabled) {
+			printf("Statistics, decimation, trigger and benchmark "
+			       "only support one channel\n");
+			return EXIT_FAILURE;
+		}
+
+		return sample_scans(chip, channels, nchannels, interval_ns,
+				    number_of_samples,
+				    log_cfg.dir ? &log_cfg : NULL);
+	}
+
 	adc = ldx_adc_request(chip, channel);
 
 	if (!adc) {
@@ -234,16 +1191,60 @@ int main(int argc, char *argv[])
 
 	cb_data.adc = adc;
 
-	if (ldx_adc_start_sampling(adc, &adc_sampling_cb, interval, &cb_data)) {
-		printf("Failed to initialize the sampling data\n");
+	if (bench_samples)
+		return bench_convert(adc, bench_samples);
+
+	if (pipe_cfg.window || pipe_cfg.decim > 1) {
+		ret = adc_pipe_start(&stats_pipe, &pipe_cfg, adc);
+		if (ret) {
+			printf("Failed to start the statistics pipeline (%s)\n",
+			       strerror(-ret));
+			return EXIT_FAILURE;
+		}
+		cb_data.pipe = &stats_pipe;
+	}
+
+	if (log_cfg.dir && open_seglog(&log_cfg, &adc, channels, 1,
+				       interval_ns))
 		return EXIT_FAILURE;
+
+	if (trig_opts.enabled) {
+		adc_conv_init(&trig_conv, 1);
+		adc_conv_set_from_adc(&trig_conv, 0, adc);
+		if (start_trigger())
+			return EXIT_FAILURE;
 	}
 
-	while (cb_data.number_of_samples > 0) {
-		printf("Waiting for samples, %d samples remaining\n",
-				cb_data.number_of_samples);
-		sleep(1);
+	/* The library timer only supports whole seconds */
+	start_ns = adc_now_ns();
+	if (interval_ns % NSEC_PER_SEC == 0)
+		ret = ldx_adc_start_sampling(adc, &adc_sampling_cb,
+					     interval_ns / NSEC_PER_SEC, &cb_data);
+	else
+		ret = adc_sampler_start(&sampler, adc, interval_ns,
+					&adc_sampling_cb, &cb_data);
+	if (ret) {
+		printf("Failed to initialize the sampling data\n");
+		return EXIT_FAILURE;
 	}
 
+	wait_samples(&cb_data);
+
+	adc_sampler_stop(&sampler);
+	ldx_adc_stop_sampling(adc);
+	adc_pipe_stop(&stats_pipe);
+	close_seglog(log_cfg.dir);
+	if (stats_pipe.dropped)
+		printf("Dropped %llu samples, the processing is too slow\n",
+		       (unsigned long long)stats_pipe.dropped);
+	if (cb_data.trig)
+		printf("%llu trigger events captured\n",
+		       (unsigned long long)trig.events);
+
+	adc_jitter_print(&cb_data.jitter, stdout);
+	if (sampler.overruns)
+		printf("Overruns: %llu sampling deadlines missed\n",
+		       (unsigned long long)sampler.overruns);
+
 	return EXIT_SUCCESS;
 }
@@ -0,0 +1,527 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <libgen.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <libdigiapix/can.h>
+
+#include "can-filter.h"
+#include "can-utils.h"
+
+#define MAX_RECEPTION_BUFFER	512*1024
+
+#define DEFAULT_BUDGET_US	100
+#define MAX_REWRITE_RULES	64
+
+/* Marks the standard IDs without rewrite rule, never a valid ID to forward */
+#define NO_REWRITE		CAN_ERR_FLAG
+
+#ifndef CANFD_FDF
+#define CANFD_FDF		0x04
+#endif
+
+struct rewrite_rule {
+	canid_t from;
+	canid_t to;
+};
+
+static can_if_t *rx_if, *tx_if;
+static bool running = true;
+static bool rx_canfd = false, tx_canfd = false;
+static struct can_filter *canfilter;
+static struct can_filter_set filter_set;
+
+static canid_t sff_rewrite[CAN_SFF_MASK + 1];
+static struct rewrite_rule eff_rules[MAX_REWRITE_RULES];
+static int neff_rules;
+
+static int rt_prio = 0, rt_cpu = -1;
+static uint64_t budget_ns = DEFAULT_BUDGET_US * 1000ULL;
+
+/* Only written from the reception callback */
+static uint64_t forwarded, dropped_filter, dropped_fd, dropped_busy, dropped_err;
+static int64_t lat_min, lat_max, lat_sum;
+static uint64_t lat_over;
+
+/*
+ * usage_and_exit() - Show usage information and exit with 'exitval' return
+ *		      value
+ *
+ * @name:	Application name.
+ * @exitval:	The exit code.
+ */
+static void usage_and_exit(char *name, int exitval)
+{
+	printf(
+		"Example application that forwards the frames of a CAN bus to another\n"
+		"\n"
+		"Usage: %s -i <can-iface> -x <can-iface> -b <bitrate> [options]\n\n"
+		"-i <can-iface>      Interface to receive the frames from\n"
+		"-x <can-iface>      Interface to forward the frames to\n"
+		"-b <bitrate>        Bitrate to use (Hz)\n"
+		"-B <bitrate>        Bitrate of the forwarding interface (Hz)\n"
+		"                    (default: same as -b)\n"
+		"-o                  Enable CAN FD support in both interfaces\n"
+		"--- CAN FD options ---\n"
+		"  -d <dbitrate>      Maximum data bitrate for CAN FD (Hz)\n"
+		"  -c                 Classic CAN in the forwarding interface, the\n"
+		"                     CAN FD frames received are dropped\n"
+		"---\n"
+		"-f <filters>        Comma-separated filter list in the format\n"
+		"                    id:mask (id and mask values in hex)\n"
+		"-F <max-filters>    Maximum number of kernel filters, above it the\n"
+		"                    filters are checked with a lookup table\n"
+		"                    (default %d)\n"
+		"-r <rules>          Comma-separated ID rewrite list in the format\n"
+		"                    from=to (hex, 8 digits for extended IDs)\n"
+		"-P <priority>       Run the forwarding path with SCHED_FIFO and\n"
+		"                    this priority\n"
+		"-C <cpu>            Pin the forwarding path to this CPU\n"
+		"-L <budget>         Latency budget in us (default %d)\n"
+		"-h                  Help\n"
+		"\n"
+		"Examples:\n"
+		"%s -i can0 -x can1 -b 500000\n"
+		"%s -i can0 -x can1 -b 500000 -B 250000 -f 100:700 -r 123=456\n"
+		"%s -i can0 -x can1 -b 1000000 -P 80 -C 3\n"
+		"\n", name, CAN_FILTER_DEF_KERNEL_MAX, DEFAULT_BUDGET_US,
+		name, name, name);
+
+	exit(exitval);
+}
+
+/*
+ * cleanup() - Frees all the allocated memory before exiting
+ */
+static void cleanup(void)
+{
+	running = false;
+
+	/* Stop the reception first, the callback uses the TX interface */
+	if (rx_if) {
+		ldx_can_free(rx_if);
+		rx_if = NULL;
+	}
+
+	if (tx_if) {
+		ldx_can_free(tx_if);
+		tx_if = NULL;
+	}
+
+	free(canfilter);
+	canfilter = NULL;
+}
+
+/*
+ * sigaction_handler() - Handler to execute after receiving a signal
+ *
+ * @signum:	Received signal.
+ */
+static void sigaction_handler(int signum)
+{
+	/* Stop the bridge and print the final counters */
+	running = false;
+}
+
+/*
+ * register_signals() - Registers program signals
+ */
+static void register_signals(void)
+{
+	struct sigaction action;
+
+	action.sa_handler = sigaction_handler;
+	action.sa_flags = 0;
+	sigemptyset(&action.sa_mask);
+
+	sigaction(SIGHUP, &action, NULL);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+}
+
+/*
+ * is_canfd_frame() - Checks if a received frame is a CAN FD frame
+ *
+ * @frame:	Received frame.
+ *
+ * Return: true if the frame is a CAN FD frame, false otherwise.
+ */
+static bool is_canfd_frame(struct canfd_frame *frame)
+{
+	return rx_canfd && (frame->len > CAN_MAX_DLEN ||
+		frame->flags & (CANFD_BRS | CANFD_ESI | CANFD_FDF));
+}
+
+/*
+ * parse_id() - Parses a CAN ID in candump notation
+ *
+ * @str:	String with the ID in hex, 8 digits for extended IDs.
+ * @end:	Variable to store the end of the parsed ID.
+ *
+ * Return: The CAN ID including CAN_EFF_FLAG, NO_REWRITE on error.
+ */
+static canid_t parse_id(const char *str, char **end)
+{
+	canid_t id = strtoul(str, end, 16);
+
+	switch (*end - str) {
+	case 8:
+		return (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+	case 1:
+	case 2:
+	case 3:
+		if (id <= CAN_SFF_MASK)
+			return id;
+		/* fall through */
+	default:
+		return NO_REWRITE;
+	}
+}
+
+/*
+ * parse_rewrite_rules() - Parses the comma-separated list of rewrite rules
+ *
+ * @str:	String with the rules.
+ *
+ * Return: 0 on success, -EINVAL if a rule is not valid.
+ */
+static int parse_rewrite_rules(const char *str)
+{
+	const char *p = str;
+	canid_t from, to;
+	char *end;
+
+	while (p && *p) {
+		from = parse_id(p, &end);
+		if (from == NO_REWRITE || *end != '=')
+			return -EINVAL;
+
+		to = parse_id(end + 1, &end);
+		if (to == NO_REWRITE || (*end && *end != ','))
+			return -EINVAL;
+
+		if (from & CAN_EFF_FLAG) {
+			if (neff_rules == MAX_REWRITE_RULES)
+				return -EINVAL;
+			eff_rules[neff_rules].from = from;
+			eff_rules[neff_rules].to = to;
+			neff_rules++;
+		} else {
+			sff_rewrite[from] = to;
+		}
+
+		p = *end ? end + 1 : NULL;
+	}
+
+	return 0;
+}
+
+/*
+ * rewrite_id() - Applies the rewrite rules to a frame, in place
+ *
+ * @frame:	Frame to forward.
+ */
+static inline void rewrite_id(struct canfd_frame *frame)
+{
+	canid_t rtr = frame->can_id & CAN_RTR_FLAG;
+	canid_t to = NO_REWRITE;
+	int i;
+
+	if (!(frame->can_id & CAN_EFF_FLAG)) {
+		to = sff_rewrite[frame->can_id & CAN_SFF_MASK];
+	} else {
+		for (i = 0; i < neff_rules; i++) {
+			if (eff_rules[i].from == (frame->can_id & ~CAN_RTR_FLAG)) {
+				to = eff_rules[i].to;
+				break;
+			}
+		}
+	}
+
+	if (to != NO_REWRITE)
+		frame->can_id = to | rtr;
+}
+
+/*
+ * bridge_rx_callback() - Forwards a received frame to the TX interface
+ *
+ * The frame is modified and sent from the buffer the library passes to the
+ * callback, nothing is copied or allocated on the forwarding path.
+ *
+ * @frame:	Received frame.
+ * @tv:		Reception timestamp.
+ */
+static void bridge_rx_callback(struct canfd_frame *frame, struct timeval *tv)
+{
+	static bool rt_configured = false;
+	int64_t latency;
+	int ret;
+
+	/* The callback runs in a library thread, configure it from inside */
+	if (!rt_configured) {
+		rt_configured = true;
+		ret = thread_set_realtime(rt_prio, rt_cpu);
+		if (ret)
+			printf("Unable to configure the forwarding thread (%s)\n",
+			       strerror(-ret));
+	}
+
+	if (!can_filter_match(&filter_set, frame->can_id)) {
+		dropped_filter++;
+		return;
+	}
+
+	if (!tx_canfd && is_canfd_frame(frame)) {
+		dropped_fd++;
+		return;
+	}
+
+	rewrite_id(frame);
+
+	/*
+	 * Never wait for room in the TX queue, a full queue means the
+	 * destination bus is slower and waiting would only add latency to
+	 * the following frames.
+	 */
+	ret = ldx_can_tx_frame(tx_if, frame);
+	if (ret) {
+		if (ret == -CAN_ERROR_TX_RETRY_LATER)
+			dropped_busy++;
+		else
+			dropped_err++;
+		return;
+	}
+
+	/* The library timestamp is the kernel reception time (realtime) */
+	latency = now_ns(CLOCK_REALTIME) -
+		  ((int64_t)tv->tv_sec * NSEC_PER_SEC + tv->tv_usec * 1000);
+	if (!forwarded || latency < lat_min)
+		lat_min = latency;
+	if (latency > lat_max)
+		lat_max = latency;
+	lat_sum += latency;
+	if (latency > (int64_t)budget_ns)
+		lat_over++;
+	forwarded++;
+}
+
+/*
+ * print_counters() - Prints the forwarding counters and the added latency
+ */
+static void print_counters(void)
+{
+	uint64_t count = forwarded;
+
+	printf("Forwarded %llu, dropped: %llu filtered, %llu CAN FD, %llu TX busy, %llu TX error\n",
+	       (unsigned long long)count, (unsigned long long)dropped_filter,
+	       (unsigned long long)dropped_fd, (unsigned long long)dropped_busy,
+	       (unsigned long long)dropped_err);
+
+	if (count)
+		printf("Added latency: min %.1f us, avg %.1f us, max %.1f us, %llu over %llu us\n",
+		       lat_min / 1e3, (double)lat_sum / count / 1e3,
+		       lat_max / 1e3, (unsigned long long)lat_over,
+		       (unsigned long long)(budget_ns / 1000));
+}
+
+/*
+ * init_iface() - Requests and configures an interface through the library
+ *
+ * @iface:	Name of the CAN interface.
+ * @ifcfg:	Interface configuration.
+ *
+ * Return: The interface, NULL on error.
+ */
+static can_if_t *init_iface(const char *iface, can_if_cfg_t *ifcfg)
+{
+	can_if_t *cif;
+
+	printf("Initializing CAN interface %s... ", iface);
+	cif = ldx_can_request_by_name(iface);
+	if (!cif || ldx_can_init(cif, ifcfg)) {
+		printf("ERROR\n");
+		if (cif)
+			ldx_can_free(cif);
+		return NULL;
+	}
+	printf("OK\n");
+
+	return cif;
+}
+
+int main(int argc, char **argv)
+{
+	char *name = basename(argv[0]);
+	char *rx_iface = NULL, *tx_iface = NULL;
+	can_if_cfg_t rx_cfg, tx_cfg;
+	struct can_filter deffilter = { .can_id = 0, .can_mask = 0 };
+	struct can_filter *cfilter = &deffilter;
+	int nfilters = 0, max_kernel_filters = CAN_FILTER_DEF_KERNEL_MAX;
+	uint32_t tx_bitrate = 0;
+	bool tx_classic = false;
+	int opt, ret, i;
+
+	if (argc <= 3)
+		usage_and_exit(name, EXIT_FAILURE);
+
+	ldx_can_set_defconfig(&rx_cfg);
+
+	for (i = 0; i <= (int)CAN_SFF_MASK; i++)
+		sff_rewrite[i] = NO_REWRITE;
+
+	while ((opt = getopt(argc, argv, "i:x:b:B:d:ocf:F:r:P:C:L:h")) > 0) {
+		switch (opt) {
+		case 'i':
+			rx_iface = optarg;
+			break;
+
+		case 'x':
+			tx_iface = optarg;
+			break;
+
+		case 'b':
+			rx_cfg.bitrate = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'B':
+			tx_bitrate = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'd':
+			rx_cfg.dbitrate = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'o':
+			rx_cfg.canfd_enabled = true;
+			break;
+
+		case 'c':
+			tx_classic = true;
+			break;
+
+		case 'f':
+			free(canfilter);
+			nfilters = can_filter_parse(optarg, &canfilter);
+			if (nfilters < 0) {
+				printf("Unable to parse filter information\n\n");
+				usage_and_exit(name, EXIT_FAILURE);
+			}
+			break;
+
+		case 'F':
+			max_kernel_filters = atoi(optarg);
+			break;
+
+		case 'r':
+			if (parse_rewrite_rules(optarg)) {
+				printf("Invalid rewrite rules '%s'\n\n", optarg);
+				usage_and_exit(name, EXIT_FAILURE);
+			}
+			break;
+
+		case 'P':
+			rt_prio = atoi(optarg);
+			break;
+
+		case 'C':
+			rt_cpu = atoi(optarg);
+			break;
+
+		case 'L':
+			budget_ns = strtoull(optarg, NULL, 10) * 1000;
+			break;
+
+		case 'h':
+			usage_and_exit(name, EXIT_SUCCESS);
+			break;
+
+		default:
+			usage_and_exit(name, EXIT_FAILURE);
+		}
+	}
+
+	if (!rx_iface || !tx_iface || !strcmp(rx_iface, tx_iface)) {
+		printf("Two different interfaces are required\n\n");
+		usage_and_exit(name, EXIT_FAILURE);
+	}
+
+	/* Register signals and exit cleanup function */
+	atexit(cleanup);
+	register_signals();
+
+	if (rt_prio > 0 && mlockall(MCL_CURRENT | MCL_FUTURE))
+		printf("Unable to lock the memory (%s)\n", strerror(errno));
+
+	rx_canfd = rx_cfg.canfd_enabled;
+	tx_canfd = rx_canfd && !tx_classic;
+	rx_cfg.rx_buf_len = MAX_RECEPTION_BUFFER;
+
+	tx_cfg = rx_cfg;
+	tx_cfg.canfd_enabled = tx_canfd;
+	if (tx_bitrate)
+		tx_cfg.bitrate = tx_bitrate;
+
+	tx_if = init_iface(tx_iface, &tx_cfg);
+	if (!tx_if)
+		return EXIT_FAILURE;
+
+	rx_if = init_iface(rx_iface, &rx_cfg);
+	if (!rx_if)
+		return EXIT_FAILURE;
+
+	if (nfilters > 0) {
+		can_filter_optimize(canfilter, nfilters, max_kernel_filters,
+				    &filter_set);
+		cfilter = can_filter_kernel_list(&filter_set, &nfilters);
+		printf("Filters: %d requested, %d after merging%s\n",
+		       filter_set.nrequested, filter_set.nfilters,
+		       filter_set.use_bitmap ?
+		       ", using a userspace lookup table" : "");
+	} else {
+		nfilters = 1;
+	}
+
+	ret = ldx_can_register_rx_handler(rx_if, bridge_rx_callback, cfilter,
+					  nfilters);
+	if (ret < 0) {
+		printf("Failed to register rx msg handler\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("Forwarding frames %s -> %s...\n", rx_iface, tx_iface);
+
+	while (running) {
+		sleep(5);
+		if (running)
+			print_counters();
+	}
+
+	/* Stop the reception before reading the final counters */
+	ldx_can_free(rx_if);
+	rx_if = NULL;
+
+	printf("\n");
+	print_counters();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <net/if.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "can-capture.h"
+#include "can-utils.h"
+
+/* Number of frames the ring can hold, must be a power of two */
+#define CAPTURE_RING_SIZE	8192
+#define CAPTURE_RING_MASK	(CAPTURE_RING_SIZE - 1)
+
+/* Size of the staging buffer used to batch the file writes */
+#define CAPTURE_WBUF_SIZE	(256 * 1024)
+/* Maximum size of an encoded frame in any of the formats */
+#define CAPTURE_MAX_REC_SIZE	256
+
+/* Writer thread poll period when the ring is empty */
+#define CAPTURE_IDLE_NS		10000000L	/* 10 ms */
+/* Maximum time data can stay in the staging buffer before being written */
+#define CAPTURE_FLUSH_NS	250000000L	/* 250 ms */
+
+#define CACHELINE_SIZE		64
+
+struct capture_slot {
+	struct timespec ts;
+	struct canfd_frame frame;
+	bool fd;
+};
+
+struct can_capture {
+	/* Producer side, only written by the CAN reception thread */
+	_Atomic uint32_t head __attribute__((aligned(CACHELINE_SIZE)));
+	_Atomic uint64_t dropped;
+
+	/* Consumer side, only written by the writer thread */
+	_Atomic uint32_t tail __attribute__((aligned(CACHELINE_SIZE)));
+	uint64_t written;
+
+	atomic_bool stop __attribute__((aligned(CACHELINE_SIZE)));
+	pthread_t thread;
+	int fd;
+	int error;
+	enum can_capture_format format;
+	char iface[IFNAMSIZ];
+	uint8_t *wbuf;
+	size_t wlen;
+
+	struct capture_slot ring[CAPTURE_RING_SIZE];
+};
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+/*
+ * put_hex() - Writes 'ndigits' upper case hex digits of 'val' to 'p'
+ *
+ * @p:		Output buffer.
+ * @val:	Value to encode.
+ * @ndigits:	Number of digits to write.
+ *
+ * Return: Pointer to the next free position of the output buffer.
+ */
+static char *put_hex(char *p, uint32_t val, int ndigits)
+{
+	int i;
+
+	for (i = ndigits - 1; i >= 0; i--) {
+		p[i] = hex_digits[val & 0xf];
+		val >>= 4;
+	}
+
+	return p + ndigits;
+}
+
+/*
+ * encode_bin() - Encodes a frame as a binary capture record
+ *
+ * @slot:	Ring slot with the frame to encode.
+ * @out:	Output buffer, at least CAPTURE_MAX_REC_SIZE bytes long.
+ *
+ * Return: Number of bytes written to the output buffer.
+ */
+static size_t encode_bin(const struct capture_slot *slot, uint8_t *out)
+{
+	struct can_capture_rec *rec = (struct can_capture_rec *)out;
+	uint8_t len = slot->frame.len;
+	size_t size = CAN_CAPTURE_REC_SIZE(len);
+
+	memset(rec, 0, size);
+	rec->ts_sec = slot->ts.tv_sec;
+	rec->ts_nsec = slot->ts.tv_nsec;
+	rec->can_id = slot->frame.can_id;
+	rec->len = len;
+	rec->flags = slot->frame.flags;
+	rec->type = slot->fd ? CAN_CAPTURE_TYPE_CANFD : CAN_CAPTURE_TYPE_CAN;
+	memcpy(out + sizeof(*rec), slot->frame.data, len);
+
+	return size;
+}
+
+/*
+ * encode_log() - Encodes a frame as a candump log line
+ *
+ * The line format is '(<sec>.<usec>) <iface> <id>#<data>' for CAN frames and
+ * '(<sec>.<usec>) <iface> <id>##<flags><data>' for CAN FD frames.
+ *
+ * @cap:	Capture handle.
+ * @slot:	Ring slot with the frame to encode.
+ * @out:	Output buffer, at least CAPTURE_MAX_REC_SIZE bytes long.
+ *
+ * Return: Number of bytes written to the output buffer.
+ */
+static size_t encode_log(const can_capture_t *cap,
+			 const struct capture_slot *slot, uint8_t *out)
+{
+	const struct canfd_frame *frame = &slot->frame;
+	char *p = (char *)out;
+	int i;
+
+	p += sprintf(p, "(%010llu.%06lu) %s ",
+		     (unsigned long long)slot->ts.tv_sec,
+		     slot->ts.tv_nsec / 1000, cap->iface);
+
+	if (frame->can_id & CAN_ERR_FLAG)
+		p = put_hex(p, frame->can_id & (CAN_ERR_MASK | CAN_ERR_FLAG), 8);
+	else if (frame->can_id & CAN_EFF_FLAG)
+		p = put_hex(p, frame->can_id & CAN_EFF_MASK, 8);
+	else
+		p = put_hex(p, frame->can_id & CAN_SFF_MASK, 3);
+
+	*p++ = '#';
+	if (slot->fd) {
+		*p++ = '#';
+		*p++ = hex_digits[frame->flags & 0xf];
+	} else if (frame->can_id & CAN_RTR_FLAG) {
+		*p++ = 'R';
+		goto end;
+	}
+
+	for (i = 0; i < frame->len; i++)
+		p = put_hex(p, frame->data[i], 2);
+
+end:
+	*p++ = '\n';
+
+	return p - (char *)out;
+}
+
+/*
+ * flush_wbuf() - Writes the staging buffer to the capture file
+ *
+ * @cap:	Capture handle.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int flush_wbuf(can_capture_t *cap)
+{
+	size_t off = 0;
+	ssize_t ret;
+
+	while (off < cap->wlen) {
+		ret = write(cap->fd, cap->wbuf + off, cap->wlen - off);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		off += ret;
+	}
+	cap->wlen = 0;
+
+	return 0;
+}
+
+/*
+ * writer_thread() - Drains the ring into the capture file
+ *
+ * @arg:	Capture handle.
+ */
+static void *writer_thread(void *arg)
+{
+	can_capture_t *cap = arg;
+	struct timespec idle = { 0, CAPTURE_IDLE_NS };
+	uint64_t last_flush, now;
+	uint32_t head, tail;
+	bool stopping;
+
+	last_flush = now_ns(CLOCK_MONOTONIC);
+
+	for (;;) {
+		stopping = atomic_load_explicit(&cap->stop, memory_order_acquire);
+		head = atomic_load_explicit(&cap->head, memory_order_acquire);
+		tail = atomic_load_explicit(&cap->tail, memory_order_relaxed);
+
+		while (tail != head) {
+			const struct capture_slot *slot = &cap->ring[tail & CAPTURE_RING_MASK];
+
+			if (cap->wlen + CAPTURE_MAX_REC_SIZE > CAPTURE_WBUF_SIZE) {
+				if (!cap->error)
+					cap->error = flush_wbuf(cap);
+				cap->wlen = 0;
+				last_flush = now_ns(CLOCK_MONOTONIC);
+			}
+
+			if (cap->format == CAN_CAPTURE_FMT_LOG)
+				cap->wlen += encode_log(cap, slot, cap->wbuf + cap->wlen);
+			else
+				cap->wlen += encode_bin(slot, cap->wbuf + cap->wlen);
+
+			tail++;
+			cap->written++;
+			/* Release the slot as soon as it has been copied out */
+			atomic_store_explicit(&cap->tail, tail, memory_order_release);
+		}
+
+		now = now_ns(CLOCK_MONOTONIC);
+		if (cap->wlen &&
+		    (stopping || now - last_flush >= CAPTURE_FLUSH_NS)) {
+			if (!cap->error)
+				cap->error = flush_wbuf(cap);
+			cap->wlen = 0;
+			last_flush = now;
+		}
+
+		if (stopping)
+			break;
+
+		nanosleep(&idle, NULL);
+	}
+
+	return NULL;
+}
+
+can_capture_t *can_capture_open(const char *path, const char *iface,
+				enum can_capture_format format)
+{
+	can_capture_t *cap;
+	int ret;
+
+	cap = calloc(1, sizeof(*cap));
+	if (!cap) {
+		printf("Unable to allocate memory for the capture ring\n");
+		return NULL;
+	}
+
+	cap->wbuf = malloc(CAPTURE_WBUF_SIZE);
+	if (!cap->wbuf) {
+		printf("Unable to allocate memory for the capture buffer\n");
+		goto free_cap;
+	}
+
+	cap->format = format;
+	strncpy(cap->iface, iface, sizeof(cap->iface) - 1);
+	atomic_init(&cap->head, 0);
+	atomic_init(&cap->tail, 0);
+	atomic_init(&cap->dropped, 0);
+	atomic_init(&cap->stop, false);
+
+	cap->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (cap->fd < 0) {
+		printf("Unable to create capture file '%s' (%s)\n", path,
+		       strerror(errno));
+		goto free_wbuf;
+	}
+
+	if (format == CAN_CAPTURE_FMT_BIN) {
+		struct can_capture_hdr hdr = {
+			.magic = CAN_CAPTURE_MAGIC,
+			.version = CAN_CAPTURE_VERSION,
+			.hdr_size = sizeof(struct can_capture_hdr),
+		};
+
+		memcpy(cap->wbuf, &hdr, sizeof(hdr));
+		cap->wlen = sizeof(hdr);
+	}
+
+	ret = pthread_create(&cap->thread, NULL, writer_thread, cap);
+	if (ret) {
+		printf("Unable to create capture writer thread (%d)\n", ret);
+		goto close_fd;
+	}
+
+	return cap;
+
+close_fd:
+	close(cap->fd);
+free_wbuf:
+	free(cap->wbuf);
+free_cap:
+	free(cap);
+
+	return NULL;
+}
+
+bool can_capture_push(can_capture_t *cap, const struct canfd_frame *frame,
+		      const struct timespec *ts, bool fd)
+{
+	uint32_t head = atomic_load_explicit(&cap->head, memory_order_relaxed);
+	uint32_t tail = atomic_load_explicit(&cap->tail, memory_order_acquire);
+	struct capture_slot *slot;
+
+	if (head - tail >= CAPTURE_RING_SIZE) {
+		atomic_fetch_add_explicit(&cap->dropped, 1, memory_order_relaxed);
+		return false;
+	}
+
+	slot = &cap->ring[head & CAPTURE_RING_MASK];
+	slot->ts = *ts;
+	slot->fd = fd;
+	/* Only copy the used part of the payload */
+	memcpy(&slot->frame, frame, offsetof(struct canfd_frame, data) + frame->len);
+
+	atomic_store_explicit(&cap->head, head + 1, memory_order_release);
+
+	return true;
+}
+
+void can_capture_close(can_capture_t *cap)
+{
+	if (!cap)
+		return;
+
+	atomic_store_explicit(&cap->stop, true, memory_order_release);
+	pthread_join(cap->thread, NULL);
+
+	if (cap->error)
+		printf("Error writing capture file (%s)\n", strerror(-cap->error));
+	printf("Captured %llu frames (%llu dropped)\n",
+	       (unsigned long long)cap->written,
+	       (unsigned long long)atomic_load(&cap->dropped));
+
+	close(cap->fd);
+	free(cap->wbuf);
+	free(cap);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CAN_CAPTURE_H_
+#define CAN_CAPTURE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <linux/can.h>
+
+#define CAN_CAPTURE_MAGIC		0x4e414344	/* "DCAN" */
+#define CAN_CAPTURE_VERSION		1
+
+/* Record types */
+#define CAN_CAPTURE_TYPE_CAN		0
+#define CAN_CAPTURE_TYPE_CANFD		1
+
+#define CAN_CAPTURE_REC_ALIGN		8
+#define CAN_CAPTURE_REC_SIZE(len)	(sizeof(struct can_capture_rec) + \
+	(((len) + CAN_CAPTURE_REC_ALIGN - 1) & ~(CAN_CAPTURE_REC_ALIGN - 1)))
+
+enum can_capture_format {
+	CAN_CAPTURE_FMT_BIN,		/* Binary records, see below */
+	CAN_CAPTURE_FMT_LOG,		/* candump -l compatible text log */
+};
+
+/*
+ * Binary capture file layout: one 'struct can_capture_hdr' followed by a
+ * stream of variable length records. Each record is a 'struct
+ * can_capture_rec' followed by 'len' payload bytes, padded to 8 bytes.
+ * All the fields are stored in host byte order.
+ */
+struct can_capture_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t hdr_size;
+	uint32_t reserved[2];
+};
+
+struct can_capture_rec {
+	uint64_t ts_sec;
+	uint32_t ts_nsec;
+	uint32_t can_id;
+	uint8_t len;
+	uint8_t flags;
+	uint8_t type;
+	uint8_t reserved[5];
+};
+
+typedef struct can_capture can_capture_t;
+
+/*
+ * can_capture_open() - Create the capture file and start the writer thread
+ *
+ * @path:	Path of the capture file to create.
+ * @iface:	Name of the captured interface (used by the text format).
+ * @format:	Output file format.
+ *
+ * Return: The capture handle, NULL on error.
+ */
+can_capture_t *can_capture_open(const char *path, const char *iface,
+				enum can_capture_format format);
+
+/*
+ * can_capture_push() - Queue a frame to be written to the capture file
+ *
+ * This function never blocks and never does I/O, it is meant to be called
+ * from the CAN reception callback. It must always be called from the same
+ * thread. If the ring is full the frame is dropped and accounted.
+ *
+ * @cap:	Capture handle.
+ * @frame:	Received frame.
+ * @ts:		Reception timestamp.
+ * @fd:		Whether the frame is a CAN FD frame.
+ *
+ * Return: true if the frame was queued, false if it was dropped.
+ */
+bool can_capture_push(can_capture_t *cap, const struct canfd_frame *frame,
+		      const struct timespec *ts, bool fd);
+
+/*
+ * can_capture_close() - Flush pending frames, stop the writer thread and
+ *			 close the capture file
+ *
+ * @cap:	Capture handle.
+ */
+void can_capture_close(can_capture_t *cap);
+
+#endif /* CAN_CAPTURE_H_ */
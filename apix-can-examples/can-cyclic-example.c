@@ -0,0 +1,372 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <libgen.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <libdigiapix/can.h>
+
+#include "can-payload.h"
+#include "can-sched.h"
+#include "can-utils.h"
+
+#define DEFAULT_REPORT_SECS	10
+#define MAX_LINE_LEN		512
+
+static can_if_t *can_if;
+static struct can_sched sched = { .sock = -1, .tfd = -1 };
+static bool running = true;
+
+/*
+ * usage_and_exit() - Show usage information and exit with 'exitval' return
+ *		      value
+ *
+ * @name:	Application name.
+ * @exitval:	The exit code.
+ */
+static void usage_and_exit(char *name, int exitval)
+{
+	printf(
+		"Example application that sends a table of cyclic CAN messages\n"
+		"\n"
+		"Usage: %s -i <can-iface> -b <bitrate> -t <table> [options]\n\n"
+		"-i <can-iface>      Name of the CAN interface\n"
+		"-b <bitrate>        Bitrate to use (Hz)\n"
+		"-t <table>          File with the cyclic messages, one per line:\n"
+		"                    <id> <period-ms> [<offset-ms> [<length> [<payload>]]]\n"
+		"                    id in hex (8 digits for extended IDs), payload\n"
+		"                    'counter' (default), 'random' or 'file:<path>'\n"
+		"-o                  Enable CAN FD support (lengths over 8 bytes)\n"
+		"--- CAN FD options ---\n"
+		"  -d <dbitrate>      Maximum data bitrate for CAN FD (Hz)\n"
+		"---\n"
+		"-r <resolution>     Timer wheel resolution in us (default %d)\n"
+		"-R <seconds>        Print the lateness report every <seconds>\n"
+		"                    (default %d, 0 to print it only at exit)\n"
+		"-P <prio>           SCHED_FIFO priority of the scheduler (1-99)\n"
+		"-C <cpu>            CPU to pin the scheduler to\n"
+		"-h                  Help\n"
+		"\n"
+		"Examples:\n"
+		"%s -i can0 -b 500000 -t ecu.table\n"
+		"%s -i can0 -b 500000 -d 2000000 -o -t ecu.table -P 80 -C 1\n"
+		"\n", name, CAN_SCHED_DEF_RES_US, DEFAULT_REPORT_SECS, name, name);
+
+	exit(exitval);
+}
+
+/*
+ * cleanup() - Frees all the allocated memory before exiting
+ */
+static void cleanup(void)
+{
+	can_sched_free(&sched);
+
+	if (can_if) {
+		ldx_can_free(can_if);
+		can_if = NULL;
+	}
+}
+
+/*
+ * sigaction_handler() - Handler to execute after receiving a signal
+ *
+ * @signum:	Received signal.
+ */
+static void sigaction_handler(int signum)
+{
+	/* Stop the scheduler and print the final report */
+	running = false;
+}
+
+/*
+ * register_signals() - Registers program signals
+ */
+static void register_signals(void)
+{
+	struct sigaction action;
+
+	action.sa_handler = sigaction_handler;
+	action.sa_flags = 0;
+	sigemptyset(&action.sa_mask);
+
+	sigaction(SIGHUP, &action, NULL);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+}
+
+/*
+ * parse_msg() - Parses a line of the table of cyclic messages
+ *
+ * @line:	Line of the table, modified.
+ * @canfd:	Whether the interface accepts CAN FD frames.
+ * @brs:	Whether to set the bit rate switch flag of CAN FD frames.
+ * @cfg:	Payload configuration to fill.
+ * @period_ns:	Variable to store the period.
+ * @offset_ns:	Variable to store the offset.
+ *
+ * Return: 1 if a message was parsed, 0 for empty and comment lines, -1 on
+ *	   error.
+ */
+static int parse_msg(char *line, bool canfd, bool brs,
+		     struct can_payload_cfg *cfg, uint64_t *period_ns,
+		     uint64_t *offset_ns)
+{
+	char *tok[5], *saveptr = NULL, *end;
+	double period, offset = 0;
+	unsigned long len = CAN_MAX_DLEN;
+	int n;
+
+	for (n = 0; n < 5; n++) {
+		tok[n] = strtok_r(n ? NULL : line, " \t\r\n", &saveptr);
+		if (!tok[n])
+			break;
+	}
+	if (!n || tok[0][0] == '#')
+		return 0;
+	if (n < 2)
+		return -1;
+
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->mode = CAN_PAYLOAD_COUNTER;
+	cfg->id = strtoul(tok[0], &end, 16);
+	if (*end)
+		return -1;
+	if (end - tok[0] == 8)
+		cfg->flags |= EXT_ID_MASK;
+	else if (cfg->id > CAN_SFF_MASK)
+		return -1;
+
+	period = strtod(tok[1], &end);
+	if (*end || period <= 0)
+		return -1;
+
+	if (n > 2) {
+		offset = strtod(tok[2], &end);
+		if (*end || offset < 0)
+			return -1;
+	}
+
+	if (n > 3) {
+		len = strtoul(tok[3], &end, 10);
+		if (*end || len > (canfd ? CANFD_MAX_DLEN : CAN_MAX_DLEN))
+			return -1;
+	}
+	cfg->len = len;
+	cfg->fd = len > CAN_MAX_DLEN;
+	cfg->brs = cfg->fd && brs;
+
+	if (n > 4) {
+		if (!strcmp(tok[4], "random")) {
+			cfg->mode = CAN_PAYLOAD_PRNG;
+		} else if (!strncmp(tok[4], "file:", 5)) {
+			cfg->mode = CAN_PAYLOAD_REPLAY;
+			cfg->file = tok[4] + 5;
+		} else if (strcmp(tok[4], "counter")) {
+			return -1;
+		}
+	}
+
+	/* Different random sequences for every ID */
+	cfg->seed = CAN_PAYLOAD_DEF_SEED ^ ((uint64_t)cfg->id << 17);
+
+	*period_ns = period * 1000000;
+	*offset_ns = offset * 1000000;
+
+	return 1;
+}
+
+/*
+ * load_table() - Adds the messages of a table file to the scheduler
+ *
+ * @path:	Path of the table file.
+ * @canfd:	Whether the interface accepts CAN FD frames.
+ * @brs:	Whether to set the bit rate switch flag of CAN FD frames.
+ *
+ * Return: 0 on success, -1 on error.
+ */
+static int load_table(const char *path, bool canfd, bool brs)
+{
+	char line[MAX_LINE_LEN];
+	struct can_payload_cfg cfg;
+	uint64_t period_ns, offset_ns;
+	unsigned int lineno = 0;
+	FILE *f;
+	int ret = 0;
+
+	f = fopen(path, "r");
+	if (!f) {
+		printf("Unable to open table '%s' (%s)\n", path, strerror(errno));
+		return -1;
+	}
+
+	while (fgets(line, sizeof(line), f)) {
+		lineno++;
+		ret = parse_msg(line, canfd, brs, &cfg, &period_ns, &offset_ns);
+		if (ret < 0) {
+			printf("%s:%u: invalid cyclic message\n", path, lineno);
+			break;
+		}
+		if (!ret)
+			continue;
+
+		ret = can_sched_add(&sched, &cfg, period_ns, offset_ns);
+		if (ret) {
+			printf("%s:%u: unable to add the message (%s)\n", path,
+			       lineno, strerror(-ret));
+			ret = -1;
+			break;
+		}
+	}
+
+	fclose(f);
+
+	return ret < 0 ? -1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+	char *name = basename(argv[0]);
+	char *iface = NULL, *table = NULL;
+	unsigned int report_secs = DEFAULT_REPORT_SECS;
+	unsigned int res_us = CAN_SCHED_DEF_RES_US;
+	int rt_prio = 0, rt_cpu = -1;
+	can_if_cfg_t ifcfg;
+	int opt, ret;
+
+	if (argc <= 3) {
+		usage_and_exit(name, EXIT_FAILURE);
+	}
+
+	ldx_can_set_defconfig(&ifcfg);
+
+	while ((opt = getopt(argc, argv, "i:b:t:od:r:R:P:C:h")) > 0) {
+		switch (opt) {
+		case 'i':
+			iface = optarg;
+			break;
+
+		case 'b':
+			ifcfg.bitrate = strtoul(optarg, NULL, 10);
+			break;
+
+		case 't':
+			table = optarg;
+			break;
+
+		case 'o':
+			ifcfg.canfd_enabled = true;
+			break;
+
+		case 'd':
+			ifcfg.dbitrate = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'r':
+			res_us = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'R':
+			report_secs = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'P':
+			rt_prio = atoi(optarg);
+			break;
+
+		case 'C':
+			rt_cpu = atoi(optarg);
+			break;
+
+		case 'h':
+			usage_and_exit(name, EXIT_SUCCESS);
+			break;
+
+		default:
+			usage_and_exit(name, EXIT_FAILURE);
+		}
+	}
+
+	if (!iface || !table || !res_us)
+		usage_and_exit(name, EXIT_FAILURE);
+
+	printf("Requesting CAN interface %s... ", iface);
+	can_if = ldx_can_request_by_name(iface);
+	if (!can_if) {
+		printf("ERROR\n");
+		return EXIT_FAILURE;
+	}
+	printf("OK\n");
+
+	/* Register signals and exit cleanup function */
+	atexit(cleanup);
+	register_signals();
+
+	printf("Initializing CAN interface... ");
+	ret = ldx_can_init(can_if, &ifcfg);
+	if (ret) {
+		printf("ERROR\n");
+		return EXIT_FAILURE;
+	}
+	printf("OK\n");
+
+	ret = can_sched_init(&sched, iface, ifcfg.canfd_enabled,
+			     res_us * 1000ULL);
+	if (ret) {
+		printf("Unable to initialize the scheduler (%s)\n",
+		       strerror(-ret));
+		return EXIT_FAILURE;
+	}
+
+	if (load_table(table, ifcfg.canfd_enabled, ifcfg.dbitrate != 0))
+		return EXIT_FAILURE;
+	if (!sched.nmsgs) {
+		printf("No cyclic messages in '%s'\n", table);
+		return EXIT_FAILURE;
+	}
+
+	ret = thread_set_realtime(rt_prio, rt_cpu);
+	if (ret)
+		printf("Unable to set the scheduler priority/affinity (%s)\n",
+		       strerror(-ret));
+
+	printf("Sending %u cyclic messages...\n", sched.nmsgs);
+	can_sched_start(&sched);
+
+	ret = 0;
+	while (running) {
+		ret = can_sched_run(&sched, report_secs ? report_secs * 1000 :
+				    1000);
+		if (ret) {
+			printf("Failed to send CAN frames (%s)\n",
+			       strerror(-ret));
+			break;
+		}
+
+		if (running && report_secs)
+			can_sched_report(&sched, stdout);
+	}
+
+	printf("\n");
+	can_sched_report(&sched, stdout);
+
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include <linux/errqueue.h>
+
+#include "can-evloop.h"
+
+/* Reception batch, shared by all the interfaces of the loop */
+static struct canfd_frame frames[CAN_EVLOOP_BATCH];
+static struct iovec iovs[CAN_EVLOOP_BATCH];
+static struct mmsghdr msgs[CAN_EVLOOP_BATCH];
+static char ctrl[CAN_EVLOOP_BATCH][CMSG_SPACE(sizeof(struct scm_timestamping))];
+
+int can_evloop_init(struct can_evloop *loop)
+{
+	int i;
+
+	memset(loop, 0, sizeof(*loop));
+	loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (loop->epfd < 0)
+		return -errno;
+
+	for (i = 0; i < CAN_EVLOOP_BATCH; i++) {
+		iovs[i].iov_base = &frames[i];
+		iovs[i].iov_len = sizeof(frames[i]);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	loop->report_start = now_ns(CLOCK_MONOTONIC);
+
+	return 0;
+}
+
+int can_evloop_add(struct can_evloop *loop, const char *name, int sock,
+		   can_evloop_handler_t handler, void *arg)
+{
+	struct can_evloop_if *lif;
+	struct epoll_event ev;
+
+	if (loop->nifs >= CAN_EVLOOP_MAX_IFS)
+		return -ENOSPC;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u32 = loop->nifs;
+	if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, sock, &ev) < 0)
+		return -errno;
+
+	lif = &loop->ifs[loop->nifs++];
+	memset(lif, 0, sizeof(*lif));
+	lif->name = name;
+	lif->sock = sock;
+	lif->handler = handler;
+	lif->arg = arg;
+
+	return 0;
+}
+
+/*
+ * service_if() - Reads and dispatches one batch of frames of an interface
+ *
+ * @lif:	Interface.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int service_if(struct can_evloop_if *lif)
+{
+	struct can_rx_ts ts;
+	int i, n;
+
+	/* The kernel overwrites the control length of every message */
+	for (i = 0; i < CAN_EVLOOP_BATCH; i++) {
+		msgs[i].msg_hdr.msg_control = ctrl[i];
+		msgs[i].msg_hdr.msg_controllen = sizeof(ctrl[i]);
+	}
+
+	n = recvmmsg(lif->sock, msgs, CAN_EVLOOP_BATCH, MSG_DONTWAIT, NULL);
+	if (n < 0)
+		return errno == EAGAIN || errno == EINTR ? 0 : -errno;
+
+	for (i = 0; i < n; i++) {
+		if (msgs[i].msg_len != CAN_MTU && msgs[i].msg_len != CANFD_MTU)
+			continue;
+
+		can_rx_ts_parse(&msgs[i].msg_hdr, &ts);
+		lif->handler(&frames[i], &ts, msgs[i].msg_len == CANFD_MTU,
+			     lif->arg);
+	}
+	lif->frames += n;
+	lif->total += n;
+
+	return 0;
+}
+
+int can_evloop_run(struct can_evloop *loop, unsigned int timeout_ms)
+{
+	struct epoll_event events[CAN_EVLOOP_MAX_IFS];
+	uint64_t now, start, deadline;
+	int i, n, ret;
+
+	deadline = now_ns(CLOCK_MONOTONIC) + timeout_ms * 1000000ULL;
+
+	for (;;) {
+		now = now_ns(CLOCK_MONOTONIC);
+		if (now >= deadline)
+			return 0;
+
+		n = epoll_wait(loop->epfd, events, CAN_EVLOOP_MAX_IFS,
+			       (deadline - now + 999999) / 1000000);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		if (!n)
+			continue;
+
+		/* Everything between two waits is loop work */
+		start = now_ns(CLOCK_MONOTONIC);
+		loop->wakeups++;
+		for (i = 0; i < n; i++) {
+			ret = service_if(&loop->ifs[events[i].data.u32]);
+			if (ret)
+				return ret;
+		}
+		loop->busy_ns += now_ns(CLOCK_MONOTONIC) - start;
+	}
+}
+
+void can_evloop_report(struct can_evloop *loop, FILE *f)
+{
+	uint64_t now = now_ns(CLOCK_MONOTONIC);
+	double secs = (double)(now - loop->report_start) / NSEC_PER_SEC;
+	uint64_t frames = 0;
+	unsigned int i;
+
+	if (secs <= 0)
+		return;
+
+	for (i = 0; i < loop->nifs; i++) {
+		struct can_evloop_if *lif = &loop->ifs[i];
+
+		fprintf(f, "%-10s %9.1f frames/s (%llu frames)\n", lif->name,
+			lif->frames / secs, (unsigned long long)lif->total);
+		frames += lif->frames;
+		lif->frames = 0;
+	}
+
+	fprintf(f, "Event loop: %.2f%% busy, %.1f wakeups/s, %.1f frames/wakeup\n",
+		100.0 * loop->busy_ns / (now - loop->report_start),
+		loop->wakeups / secs,
+		loop->wakeups ? (double)frames / loop->wakeups : 0.0);
+
+	loop->report_start = now;
+	loop->busy_ns = 0;
+	loop->wakeups = 0;
+}
+
+void can_evloop_close(struct can_evloop *loop)
+{
+	unsigned int i;
+
+	for (i = 0; i < loop->nifs; i++)
+		close(loop->ifs[i].sock);
+	loop->nifs = 0;
+
+	if (loop->epfd >= 0) {
+		close(loop->epfd);
+		loop->epfd = -1;
+	}
+}
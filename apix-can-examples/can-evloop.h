@@ -0,0 +1,121 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CAN_EVLOOP_H_
+#define CAN_EVLOOP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "can-utils.h"
+
+/* Maximum number of interfaces serviced by a loop */
+#define CAN_EVLOOP_MAX_IFS	8
+/* Frames read from an interface per wakeup */
+#define CAN_EVLOOP_BATCH	32
+
+/*
+ * Frame handler of an interface
+ *
+ * @frame:	Received frame.
+ * @ts:		Reception timestamps, zero if the socket was not opened with
+ *		CAN_SOCK_TIMESTAMP.
+ * @fd:		Whether the frame is a CAN FD frame.
+ * @arg:	Argument given to can_evloop_add().
+ */
+typedef void (*can_evloop_handler_t)(struct canfd_frame *frame,
+				     const struct can_rx_ts *ts, bool fd,
+				     void *arg);
+
+struct can_evloop_if {
+	const char *name;
+	int sock;
+	can_evloop_handler_t handler;
+	void *arg;
+	uint64_t frames;		/* Frames since the last report */
+	uint64_t total;
+};
+
+struct can_evloop {
+	int epfd;
+	unsigned int nifs;
+	struct can_evloop_if ifs[CAN_EVLOOP_MAX_IFS];
+
+	/* Loop utilization since the last report */
+	uint64_t report_start;
+	uint64_t busy_ns;
+	uint64_t wakeups;
+};
+
+/*
+ * can_evloop_init() - Initializes an event loop without interfaces
+ *
+ * @loop:	Event loop.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int can_evloop_init(struct can_evloop *loop);
+
+/*
+ * can_evloop_add() - Adds a CAN socket to an event loop
+ *
+ * The loop takes the ownership of the socket and closes it in
+ * can_evloop_close(). The socket should be non-blocking, with its filters
+ * already installed.
+ *
+ * @loop:	Event loop.
+ * @name:	Name of the interface, for the reports.
+ * @sock:	Socket opened with can_socket_open().
+ * @handler:	Function called for every frame of the interface.
+ * @arg:	Argument for the handler.
+ *
+ * Return: 0 on success, -ENOSPC if the loop is full, -errno otherwise.
+ */
+int can_evloop_add(struct can_evloop *loop, const char *name, int sock,
+		   can_evloop_handler_t handler, void *arg);
+
+/*
+ * can_evloop_run() - Services the interfaces of an event loop
+ *
+ * Waits for frames on all the sockets with a single epoll_wait() and reads
+ * them in batches with recvmmsg(), at most one batch per interface and
+ * wakeup so a busy bus cannot starve the others.
+ *
+ * @loop:	Event loop.
+ * @timeout_ms:	Time to run before returning, in ms.
+ *
+ * Return: 0 when the time elapses, -errno on error.
+ */
+int can_evloop_run(struct can_evloop *loop, unsigned int timeout_ms);
+
+/*
+ * can_evloop_report() - Prints the frame rate of every interface and the
+ *			 loop utilization since the last report
+ *
+ * @loop:	Event loop.
+ * @f:		Output stream.
+ */
+void can_evloop_report(struct can_evloop *loop, FILE *f);
+
+/*
+ * can_evloop_close() - Closes the loop and its sockets
+ *
+ * @loop:	Event loop.
+ */
+void can_evloop_close(struct can_evloop *loop);
+
+#endif /* CAN_EVLOOP_H_ */
@@ -0,0 +1,371 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "can-filter.h"
+
+/* Limit of the intermediate lists while merging */
+#define MAX_WORK_FILTERS	65536
+
+/*
+ * covers() - Checks if a filter passes all the frames another filter passes
+ *
+ * @a:		Filter that may cover 'b'.
+ * @b:		Filter that may be covered by 'a'.
+ *
+ * Return: true if every frame that matches 'b' also matches 'a'.
+ */
+static bool covers(const struct can_filter *a, const struct can_filter *b)
+{
+	/* 'a' cannot check bits that 'b' does not fix */
+	if (a->can_mask & ~b->can_mask)
+		return false;
+
+	return !((a->can_id ^ b->can_id) & a->can_mask);
+}
+
+/*
+ * remove_filter() - Removes a filter from a list, not preserving the order
+ *
+ * @filters:	Filter list.
+ * @nfilters:	Number of filters in the list, updated.
+ * @index:	Index of the filter to remove.
+ */
+static void remove_filter(struct can_filter *filters, int *nfilters, int index)
+{
+	filters[index] = filters[*nfilters - 1];
+	(*nfilters)--;
+}
+
+/*
+ * remove_covered() - Removes the filters covered by another filter
+ *
+ * @filters:	Filter list.
+ * @nfilters:	Number of filters in the list, updated.
+ */
+static void remove_covered(struct can_filter *filters, int *nfilters)
+{
+	int i, j;
+
+	for (i = 0; i < *nfilters; i++) {
+		for (j = 0; j < *nfilters; j++) {
+			if (i == j || !covers(&filters[j], &filters[i]))
+				continue;
+
+			remove_filter(filters, nfilters, i);
+			i--;
+			break;
+		}
+	}
+}
+
+static int cmp_filter(const void *a, const void *b)
+{
+	const struct can_filter *fa = a, *fb = b;
+
+	if (fa->can_mask != fb->can_mask)
+		return fa->can_mask < fb->can_mask ? -1 : 1;
+	if (fa->can_id != fb->can_id)
+		return fa->can_id < fb->can_id ? -1 : 1;
+
+	return 0;
+}
+
+/*
+ * sort_unique() - Sorts a filter list by mask and ID and removes duplicates
+ *
+ * @filters:	Filter list.
+ * @nfilters:	Number of filters in the list.
+ *
+ * Return: The number of filters after removing the duplicates.
+ */
+static int sort_unique(struct can_filter *filters, int nfilters)
+{
+	int i, n = 0;
+
+	qsort(filters, nfilters, sizeof(*filters), cmp_filter);
+
+	for (i = 0; i < nfilters; i++) {
+		if (n && !cmp_filter(&filters[n - 1], &filters[i]))
+			continue;
+		filters[n++] = filters[i];
+	}
+
+	return n;
+}
+
+/*
+ * grow_list() - Doubles the size of a filter list, up to MAX_WORK_FILTERS
+ *
+ * @list:	Filter list, reallocated.
+ * @size:	Size of the list, updated.
+ *
+ * Return: 0 on success, -1 if the list cannot grow.
+ */
+static int grow_list(struct can_filter **list, int *size)
+{
+	struct can_filter *tmp;
+	int new_size;
+
+	/* The scratch buffer of merge_pass() has MAX_WORK_FILTERS entries */
+	if (*size >= MAX_WORK_FILTERS)
+		return -1;
+	new_size = *size * 2;
+	if (new_size > MAX_WORK_FILTERS)
+		new_size = MAX_WORK_FILTERS;
+
+	tmp = realloc(*list, new_size * sizeof(**list));
+	if (!tmp)
+		return -1;
+
+	*list = tmp;
+	*size = new_size;
+
+	return 0;
+}
+
+/*
+ * merge_pass() - Merges filters with the same mask and one different ID bit
+ *
+ * Like a Quine-McCluskey step: every pair of filters with the same mask
+ * whose IDs only differ in one bit produces a filter with that bit as
+ * "don't care". The filters that could not be merged are kept.
+ *
+ * @in:		Sorted filter list, without duplicates.
+ * @nin:	Number of filters in the input list.
+ * @out:	Output list, reallocated if needed.
+ * @maxout:	Size of the output list, updated.
+ * @used:	Scratch buffer of at least 'nin' entries.
+ *
+ * Return: The number of filters in the output list, -1 if no filter was
+ *	   merged or the output list cannot grow.
+ */
+static int merge_pass(const struct can_filter *in, int nin,
+		      struct can_filter **out, int *maxout, bool *used)
+{
+	int i, j, nout = 0;
+	bool merged = false;
+	uint32_t diff;
+
+	memset(used, 0, nin * sizeof(*used));
+
+	for (i = 0; i < nin; i++) {
+		/* The list is sorted by mask, only compare inside the group */
+		for (j = i + 1; j < nin && in[j].can_mask == in[i].can_mask; j++) {
+			diff = in[i].can_id ^ in[j].can_id;
+			if (__builtin_popcount(diff) != 1)
+				continue;
+
+			if (nout == *maxout && grow_list(out, maxout))
+				return -1;
+
+			(*out)[nout].can_id = in[i].can_id & ~diff;
+			(*out)[nout].can_mask = in[i].can_mask & ~diff;
+			nout++;
+			used[i] = used[j] = true;
+			merged = true;
+		}
+	}
+
+	if (!merged)
+		return -1;
+
+	for (i = 0; i < nin; i++) {
+		if (used[i])
+			continue;
+		if (nout == *maxout && grow_list(out, maxout))
+			return -1;
+		(*out)[nout++] = in[i];
+	}
+
+	nout = sort_unique(*out, nout);
+	remove_covered(*out, &nout);
+
+	return sort_unique(*out, nout);
+}
+
+/*
+ * build_bitmap() - Computes the lookup bitmap of the standard IDs
+ *
+ * @set:	Filter set.
+ */
+static void build_bitmap(struct can_filter_set *set)
+{
+	uint32_t can_id;
+	unsigned int idx;
+	int i;
+
+	memset(set->sff_bitmap, 0, sizeof(set->sff_bitmap));
+
+	for (idx = 0; idx < CAN_FILTER_SFF_ENTRIES; idx++) {
+		can_id = idx & CAN_SFF_MASK;
+		if (idx >> CAN_FILTER_SFF_RTR_BIT)
+			can_id |= CAN_RTR_FLAG;
+
+		for (i = 0; i < set->nfilters; i++) {
+			if (can_filter_passes(&set->filters[i], can_id)) {
+				set->sff_bitmap[idx / 32] |= 1U << (idx % 32);
+				break;
+			}
+		}
+	}
+}
+
+/*
+ * build_cover() - Computes a single filter that passes all the merged ones
+ *
+ * The cover filter only checks the bits that all the filters check and that
+ * have the same value in all of them. An inverted filter passes almost any
+ * frame, so with inverted filters the cover passes all the frames.
+ *
+ * @set:	Filter set.
+ */
+static void build_cover(struct can_filter_set *set)
+{
+	uint32_t mask = ~0U, diff = 0;
+	int i;
+
+	for (i = 0; i < set->nfilters; i++) {
+		if (set->filters[i].can_id & CAN_INV_FILTER) {
+			mask = 0;
+			break;
+		}
+		mask &= set->filters[i].can_mask;
+		diff |= set->filters[i].can_id ^ set->filters[0].can_id;
+	}
+
+	set->cover.can_mask = mask & ~diff;
+	set->cover.can_id = set->filters[0].can_id & set->cover.can_mask;
+}
+
+/*
+ * merge_filters() - Merges the filter list of a set in place
+ *
+ * The list is left as it is if it cannot be merged.
+ *
+ * @set:	Filter set, with the requested list.
+ */
+static void merge_filters(struct can_filter_set *set)
+{
+	struct can_filter *filters = set->filters;
+	int nfilters = set->nfilters;
+	struct can_filter *work[2] = { NULL, NULL };
+	int maxwork[2];
+	bool *used = NULL;
+	int i, n, cur = 0;
+
+	if (nfilters < 2 || nfilters > MAX_WORK_FILTERS / 2)
+		return;
+
+	for (i = 0; i < nfilters; i++) {
+		if (filters[i].can_id & CAN_INV_FILTER)
+			return;
+	}
+
+	/* Bits not covered by the mask are not relevant */
+	for (i = 0; i < nfilters; i++)
+		filters[i].can_id &= filters[i].can_mask;
+
+	/* Intermediate lists can be larger than the original one */
+	maxwork[0] = maxwork[1] = nfilters * 2;
+	work[0] = malloc(maxwork[0] * sizeof(struct can_filter));
+	work[1] = malloc(maxwork[1] * sizeof(struct can_filter));
+	used = malloc(MAX_WORK_FILTERS * sizeof(*used));
+	if (!work[0] || !work[1] || !used)
+		goto out;
+
+	memcpy(work[0], filters, nfilters * sizeof(*filters));
+	n = sort_unique(work[0], nfilters);
+
+	for (;;) {
+		int nout = merge_pass(work[cur], n, &work[!cur],
+				      &maxwork[!cur], used);
+
+		if (nout < 0)
+			break;
+		cur = !cur;
+		n = nout;
+	}
+
+	remove_covered(work[cur], &n);
+
+	/* Never return a list longer than the requested one */
+	if (n <= nfilters) {
+		memcpy(filters, work[cur], n * sizeof(*filters));
+		set->nfilters = n;
+	} else {
+		n = sort_unique(filters, nfilters);
+		remove_covered(filters, &n);
+		set->nfilters = n;
+	}
+
+out:
+	free(work[0]);
+	free(work[1]);
+	free(used);
+}
+
+void can_filter_optimize(struct can_filter *filters, int nfilters,
+			 int max_kernel, struct can_filter_set *set)
+{
+	memset(set, 0, sizeof(*set));
+	set->filters = filters;
+	set->nfilters = nfilters;
+	set->nrequested = nfilters;
+
+	merge_filters(set);
+
+	/* Merged or not, never install more than 'max_kernel' filters */
+	if (set->nfilters > max_kernel) {
+		set->use_bitmap = true;
+		build_cover(set);
+		build_bitmap(set);
+	}
+}
+
+int can_filter_parse(const char *str, struct can_filter **filters)
+{
+	struct can_filter *list;
+	const char *p;
+	int n = 1, good = 0;
+
+	for (p = str; *p; p++)
+		if (*p == ',')
+			n++;
+
+	list = malloc(n * sizeof(*list));
+	if (!list)
+		return -ENOMEM;
+
+	p = str;
+	while (p) {
+		if (sscanf(p, "%x:%x", &list[good].can_id,
+			   &list[good].can_mask) == 2)
+			good++;
+
+		p = strchr(p, ',');
+		if (p)
+			p++;
+	}
+
+	*filters = list;
+
+	return good;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CAN_FILTER_H_
+#define CAN_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <linux/can.h>
+
+#define CAN_FILTER_DEF_KERNEL_MAX	16
+
+/* Standard IDs lookup table, indexed by the ID and the RTR bit */
+#define CAN_FILTER_SFF_ENTRIES		((CAN_SFF_MASK + 1) * 2)
+#define CAN_FILTER_SFF_RTR_BIT		11
+
+struct can_filter_set {
+	struct can_filter *filters;	/* Merged filters */
+	int nfilters;
+	int nrequested;			/* Number of filters before merging */
+	bool use_bitmap;		/* Userspace lookup required */
+	struct can_filter cover;	/* Kernel filter in bitmap mode */
+	uint32_t sff_bitmap[CAN_FILTER_SFF_ENTRIES / 32];
+};
+
+/*
+ * can_filter_optimize() - Reduces a CAN_RAW filter list
+ *
+ * The filters are merged in place into the fewest equivalent id:mask pairs:
+ * duplicated filters and filters covered by other ones are removed, and
+ * pairs with the same mask whose IDs only differ in one bit are merged.
+ *
+ * If the merged list still has more than 'max_kernel' entries, a single
+ * kernel filter that passes a superset of the frames is computed in 'cover'
+ * and the frames must be checked with can_filter_match(). Standard frames
+ * are then checked with a precomputed bitmap and extended frames against
+ * the merged list.
+ *
+ * Lists with inverted filters (CAN_INV_FILTER), lists too long to merge, or
+ * lists that cannot be merged for lack of memory are not modified, but the
+ * userspace lookup is still used above 'max_kernel' filters.
+ *
+ * @filters:	Filter list, modified in place.
+ * @nfilters:	Number of filters in the list.
+ * @max_kernel:	Maximum number of filters to install in the kernel.
+ * @set:	Resulting filter set.
+ */
+void can_filter_optimize(struct can_filter *filters, int nfilters,
+			 int max_kernel, struct can_filter_set *set);
+
+/*
+ * can_filter_parse() - Parses a comma-separated list of id:mask filters
+ *
+ * The id and mask values are in hex. Entries that cannot be parsed are
+ * skipped.
+ *
+ * @str:	String with the filter list.
+ * @filters:	Variable to store the allocated filter list, to be freed by
+ *		the caller.
+ *
+ * Return: The number of filters parsed, -errno on error.
+ */
+int can_filter_parse(const char *str, struct can_filter **filters);
+
+/*
+ * can_filter_kernel_list() - Returns the filter list to install in the socket
+ *
+ * @set:	Filter set.
+ * @nfilters:	Variable to store the number of filters of the list.
+ *
+ * Return: The filter list.
+ */
+static inline struct can_filter *can_filter_kernel_list(struct can_filter_set *set,
+							int *nfilters)
+{
+	if (set->use_bitmap) {
+		*nfilters = 1;
+		return &set->cover;
+	}
+
+	*nfilters = set->nfilters;
+
+	return set->filters;
+}
+
+/*
+ * can_filter_passes() - Checks a CAN ID against a single CAN_RAW filter
+ *
+ * @filter:	The filter, inverted if CAN_INV_FILTER is set in its ID.
+ * @can_id:	CAN ID of the frame, including the flags.
+ *
+ * Return: true if the filter passes the frame, false otherwise.
+ */
+static inline bool can_filter_passes(const struct can_filter *filter,
+				     uint32_t can_id)
+{
+	bool match = !((can_id ^ (filter->can_id & ~CAN_INV_FILTER)) &
+		       filter->can_mask);
+
+	return filter->can_id & CAN_INV_FILTER ? !match : match;
+}
+
+/*
+ * can_filter_match() - Checks a received frame against the filter set
+ *
+ * Only needed when the set uses the userspace lookup, otherwise the kernel
+ * already applied the filters and the function always returns true.
+ *
+ * @set:	Filter set.
+ * @can_id:	CAN ID of the received frame, including the flags.
+ *
+ * Return: true if the frame passes the filters, false otherwise.
+ */
+static inline bool can_filter_match(const struct can_filter_set *set,
+				    uint32_t can_id)
+{
+	unsigned int idx;
+	int i;
+
+	if (!set->use_bitmap)
+		return true;
+
+	if (!(can_id & CAN_EFF_FLAG)) {
+		idx = (can_id & CAN_SFF_MASK) |
+		      (!!(can_id & CAN_RTR_FLAG) << CAN_FILTER_SFF_RTR_BIT);
+		return set->sff_bitmap[idx / 32] & (1U << (idx % 32));
+	}
+
+	for (i = 0; i < set->nfilters; i++)
+		if (can_filter_passes(&set->filters[i], can_id))
+			return true;
+
+	return false;
+}
+
+#endif /* CAN_FILTER_H_ */
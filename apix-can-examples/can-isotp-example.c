@@ -0,0 +1,376 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <libgen.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <libdigiapix/can.h>
+
+#include "can-isotp.h"
+#include "can-utils.h"
+
+#define DEFAULT_IFACE		"vcan0"
+#define DEFAULT_SIZE		(4 * 1024 * 1024)
+#define DEFAULT_TX_ID		0x7e0
+#define DEFAULT_RX_ID		0x7e8
+/*
+ * The reception thread must keep up with the sender, a block size keeps the
+ * sender from overflowing its socket queue.
+ */
+#define DEFAULT_BS		16
+
+#define MAX_RECEPTION_BUFFER	512*1024
+
+/* Time to wait for the whole message once it has been sent */
+#define RECV_TIMEOUT_MS		5000
+
+static can_if_t *tx_if, *rx_if;
+static isotp_link_t *tx_link, *rx_link;
+static uint8_t *blob, *rx_buf;
+
+/*
+ * usage_and_exit() - Show usage information and exit with 'exitval' return
+ *		      value
+ *
+ * @name:	Application name.
+ * @exitval:	The exit code.
+ */
+static void usage_and_exit(char *name, int exitval)
+{
+	printf(
+		"Example application that measures the ISO-TP (ISO 15765-2) throughput\n"
+		"\n"
+		"Usage: %s [options]\n\n"
+		"-i <can-iface>      Interface that sends the message (default %s)\n"
+		"-e <can-iface>      Interface that receives the message (default:\n"
+		"                    same as -i, valid for virtual CAN interfaces)\n"
+		"-b <bitrate>        Configure the interfaces with this bitrate (Hz).\n"
+		"                    If not set, the interfaces must be already up\n"
+		"-o                  Also measure with CAN FD 64 byte frames\n"
+		"--- CAN FD options ---\n"
+		"  -d <dbitrate>      Maximum data bitrate for CAN FD (Hz)\n"
+		"---\n"
+		"-s <size>           Message size in bytes (default %d)\n"
+		"-I <tx_id>          Sender CAN ID in hex (default %x)\n"
+		"-R <rx_id>          Receiver CAN ID in hex (default %x)\n"
+		"-B <block-size>     Block size requested by the receiver, 0 for no\n"
+		"                    limit (default %d)\n"
+		"-S <stmin>          Raw STmin requested by the receiver (default 0)\n"
+		"-h                  Help\n"
+		"\n"
+		"Examples:\n"
+		"%s -i vcan0 -o\n"
+		"%s -i can0 -e can1 -b 1000000 -d 5000000 -o -B 32\n"
+		"\n", name, DEFAULT_IFACE, DEFAULT_SIZE, DEFAULT_TX_ID,
+		DEFAULT_RX_ID, DEFAULT_BS, name, name);
+
+	exit(exitval);
+}
+
+/*
+ * close_links() - Closes the ISO-TP links and frees the interfaces
+ */
+static void close_links(void)
+{
+	isotp_close(rx_link);
+	rx_link = NULL;
+	isotp_close(tx_link);
+	tx_link = NULL;
+
+	if (rx_if) {
+		ldx_can_free(rx_if);
+		rx_if = NULL;
+	}
+
+	if (tx_if) {
+		ldx_can_free(tx_if);
+		tx_if = NULL;
+	}
+}
+
+/*
+ * cleanup() - Frees all the allocated memory before exiting
+ */
+static void cleanup(void)
+{
+	close_links();
+
+	free(blob);
+	blob = NULL;
+	free(rx_buf);
+	rx_buf = NULL;
+}
+
+/*
+ * sigaction_handler() - Handler to execute after receiving a signal
+ *
+ * @signum:	Received signal.
+ */
+static void sigaction_handler(int signum)
+{
+	/* 'atexit' executes the cleanup function */
+	exit(EXIT_FAILURE);
+}
+
+/*
+ * register_signals() - Registers program signals
+ */
+static void register_signals(void)
+{
+	struct sigaction action;
+
+	action.sa_handler = sigaction_handler;
+	action.sa_flags = 0;
+	sigemptyset(&action.sa_mask);
+
+	sigaction(SIGHUP, &action, NULL);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+}
+
+/*
+ * init_iface() - Requests and configures an interface through the library
+ *
+ * @iface:	Name of the CAN interface.
+ * @ifcfg:	Interface configuration.
+ *
+ * Return: The interface, NULL on error.
+ */
+static can_if_t *init_iface(const char *iface, can_if_cfg_t *ifcfg)
+{
+	can_if_t *cif;
+
+	printf("Initializing CAN interface %s... ", iface);
+	cif = ldx_can_request_by_name(iface);
+	if (!cif || ldx_can_init(cif, ifcfg)) {
+		printf("ERROR\n");
+		if (cif)
+			ldx_can_free(cif);
+		return NULL;
+	}
+	printf("OK\n");
+
+	return cif;
+}
+
+/*
+ * count_frames() - Computes the number of frames of a segmented message
+ *
+ * @size:	Message size.
+ * @dl:		Frame length.
+ *
+ * Return: The number of first and consecutive frames.
+ */
+static size_t count_frames(size_t size, uint8_t dl)
+{
+	size_t ff_data = dl - (size > 4095 ? 6 : 2);
+
+	return 1 + (size - ff_data + dl - 2) / (dl - 1);
+}
+
+/*
+ * run_benchmark() - Transfers the message once and reports the throughput
+ *
+ * @tx_iface:	Interface that sends the message.
+ * @rx_iface:	Interface that receives the message.
+ * @ifcfg:	Configuration of the interfaces.
+ * @cfg:	ISO-TP configuration.
+ * @ids:	Sender and receiver CAN IDs.
+ * @size:	Message size.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int run_benchmark(const char *tx_iface, const char *rx_iface,
+			 can_if_cfg_t *ifcfg, const struct isotp_cfg *cfg,
+			 const uint32_t ids[2], size_t size)
+{
+	uint64_t start, elapsed;
+	ssize_t len;
+	int ret = EXIT_FAILURE;
+
+	/*
+	 * The sender only receives flow control frames. Without bitrate the
+	 * interfaces are not configured, which is what virtual CAN interfaces
+	 * need, and the links use their own sockets instead of the library.
+	 */
+	if (ifcfg->bitrate) {
+		tx_if = init_iface(tx_iface, ifcfg);
+		rx_if = init_iface(rx_iface, ifcfg);
+		if (!tx_if || !rx_if)
+			goto out;
+
+		tx_link = isotp_open(tx_if, ids[0], ids[1], cfg, NULL, 0);
+		rx_link = isotp_open(rx_if, ids[1], ids[0], cfg, rx_buf, size);
+	} else {
+		tx_link = isotp_open_socket(tx_iface, ids[0], ids[1], cfg,
+					    NULL, 0);
+		rx_link = isotp_open_socket(rx_iface, ids[1], ids[0], cfg,
+					    rx_buf, size);
+	}
+	if (!tx_link || !rx_link) {
+		printf("Unable to open the ISO-TP links\n");
+		goto out;
+	}
+
+	memset(rx_buf, 0, size);
+
+	start = now_ns(CLOCK_MONOTONIC);
+	ret = isotp_send(tx_link, blob, size);
+	if (ret) {
+		printf("Failed to send the message (%s)\n", strerror(-ret));
+		ret = EXIT_FAILURE;
+		goto out;
+	}
+
+	len = isotp_recv(rx_link, RECV_TIMEOUT_MS);
+	elapsed = now_ns(CLOCK_MONOTONIC) - start;
+	if (len < 0) {
+		printf("Failed to receive the message (%s)\n", strerror(-len));
+		ret = EXIT_FAILURE;
+		goto out;
+	}
+
+	if ((size_t)len != size || memcmp(rx_buf, blob, size)) {
+		printf("Received message does not match the sent one\n");
+		ret = EXIT_FAILURE;
+		goto out;
+	}
+
+	printf("%-16s %zu bytes in %zu frames, %.3f s, %.1f KB/s\n",
+	       cfg->tx_dl > CAN_MAX_DLEN ? "CAN FD (64 B):" : "CAN 2.0 (8 B):",
+	       size, count_frames(size, cfg->tx_dl),
+	       (double)elapsed / NSEC_PER_SEC,
+	       (double)size / 1024 / ((double)elapsed / NSEC_PER_SEC));
+	ret = EXIT_SUCCESS;
+
+out:
+	close_links();
+
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	char *name = basename(argv[0]);
+	char *tx_iface = DEFAULT_IFACE, *rx_iface = NULL;
+	uint32_t ids[2] = { DEFAULT_TX_ID, DEFAULT_RX_ID };
+	size_t size = DEFAULT_SIZE, i;
+	struct isotp_cfg cfg;
+	can_if_cfg_t ifcfg;
+	bool canfd = false;
+	int opt, ret;
+
+	ldx_can_set_defconfig(&ifcfg);
+	ifcfg.bitrate = 0;
+	ifcfg.rx_buf_len = MAX_RECEPTION_BUFFER;
+	isotp_set_defconfig(&cfg);
+	cfg.bs = DEFAULT_BS;
+
+	while ((opt = getopt(argc, argv, "i:e:b:d:os:I:R:B:S:h")) > 0) {
+		switch (opt) {
+		case 'i':
+			tx_iface = optarg;
+			break;
+
+		case 'e':
+			rx_iface = optarg;
+			break;
+
+		case 'b':
+			ifcfg.bitrate = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'd':
+			ifcfg.dbitrate = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'o':
+			canfd = true;
+			break;
+
+		case 's':
+			size = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'I':
+			ids[0] = strtoul(optarg, NULL, 16);
+			break;
+
+		case 'R':
+			ids[1] = strtoul(optarg, NULL, 16);
+			break;
+
+		case 'B':
+			cfg.bs = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'S':
+			cfg.stmin = strtoul(optarg, NULL, 16);
+			break;
+
+		case 'h':
+			usage_and_exit(name, EXIT_SUCCESS);
+			break;
+
+		default:
+			usage_and_exit(name, EXIT_FAILURE);
+		}
+	}
+
+	if (!rx_iface)
+		rx_iface = tx_iface;
+
+	if (size < CAN_MAX_DLEN || size > ISOTP_MAX_MSG_LEN || ids[0] == ids[1]) {
+		printf("Invalid message size or CAN IDs\n");
+		return EXIT_FAILURE;
+	}
+
+	/* IDs over the standard range are extended IDs */
+	for (i = 0; i < 2; i++)
+		if (ids[i] > CAN_SFF_MASK)
+			ids[i] = (ids[i] & CAN_EFF_MASK) | CAN_EFF_FLAG;
+
+	/* Register signals and exit cleanup function */
+	atexit(cleanup);
+	register_signals();
+
+	blob = malloc(size);
+	rx_buf = malloc(size);
+	if (!blob || !rx_buf) {
+		printf("Unable to allocate memory for %zu bytes\n", size);
+		return EXIT_FAILURE;
+	}
+	for (i = 0; i < size; i++)
+		blob[i] = i * 31 + (i >> 11);
+
+	ifcfg.canfd_enabled = false;
+	cfg.tx_dl = CAN_MAX_DLEN;
+	ret = run_benchmark(tx_iface, rx_iface, &ifcfg, &cfg, ids, size);
+
+	if (!ret && canfd) {
+		ifcfg.canfd_enabled = true;
+		cfg.tx_dl = CANFD_MAX_DLEN;
+		cfg.brs = ifcfg.dbitrate != 0;
+		ret = run_benchmark(tx_iface, rx_iface, &ifcfg, &cfg, ids, size);
+	}
+
+	return ret;
+}
@@ -0,0 +1,762 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "can-isotp.h"
+#include "can-payload.h"
+#include "can-utils.h"
+
+/* Protocol control information types, high nibble of the first byte */
+#define PCI_SF			0x0	/* Single frame */
+#define PCI_FF			0x1	/* First frame */
+#define PCI_CF			0x2	/* Consecutive frame */
+#define PCI_FC			0x3	/* Flow control */
+
+/* Flow status of the flow control frames */
+#define FC_CTS			0x0	/* Continue to send */
+#define FC_WAIT			0x1
+#define FC_OVFLW		0x2	/* Overflow, message too long */
+
+/* Maximum number of consecutive FC_WAIT frames accepted */
+#define MAX_WFT			10
+
+/* Largest message length of a first frame without escape sequence */
+#define FF_DL_12BIT_MAX		4095
+
+/* Wait between retries when the TX queue of the interface is full */
+#define TX_RETRY_NS		50000L
+#define TX_RETRIES		2000
+
+#define ID_MASK			(CAN_EFF_FLAG | CAN_EFF_MASK)
+
+enum rx_state {
+	RX_IDLE,		/* Waiting for a first or single frame */
+	RX_BUSY,		/* Receiving consecutive frames */
+	RX_DONE,		/* Complete message in the buffer */
+	RX_ERROR,		/* Reception aborted */
+};
+
+struct isotp_link {
+	can_if_t *cif;		/* Library interface, NULL for socket links */
+	int fd;			/* CAN_RAW socket of the socket links */
+	pthread_t rx_thread;
+	uint32_t tx_id;
+	uint32_t rx_id;
+	struct isotp_cfg cfg;
+
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+
+	/* Sender side, last flow control frame received */
+	bool fc_pending;
+	uint8_t fc_status;
+	uint8_t fc_bs;
+	uint8_t fc_stmin;
+
+	/* Receiver side */
+	uint8_t *rx_buf;
+	size_t rx_size;
+	enum rx_state rx_state;
+	bool rx_delivered;	/* The message was returned by isotp_recv() */
+	size_t rx_len;
+	size_t rx_off;
+	uint8_t rx_sn;
+	uint8_t rx_bs_count;
+};
+
+static isotp_link_t *links[ISOTP_MAX_LINKS];
+static pthread_mutex_t links_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void isotp_set_defconfig(struct isotp_cfg *cfg)
+{
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->tx_dl = CAN_MAX_DLEN;
+	cfg->padding = ISOTP_DEF_PADDING;
+	cfg->timeout_ms = ISOTP_DEF_TIMEOUT_MS;
+}
+
+/*
+ * stmin_to_ns() - Decodes a raw STmin value
+ *
+ * @stmin:	Raw STmin of a flow control frame.
+ *
+ * Return: The minimum separation time in ns.
+ */
+static uint64_t stmin_to_ns(uint8_t stmin)
+{
+	if (stmin <= 0x7f)
+		return stmin * 1000000ULL;
+	if (stmin >= 0xf1 && stmin <= 0xf9)
+		return (stmin - 0xf0) * 100000ULL;
+
+	/* Reserved values must be handled as the longest time */
+	return 0x7f * 1000000ULL;
+}
+
+/*
+ * deadline_after() - Computes an absolute CLOCK_MONOTONIC deadline
+ *
+ * @ts:		Variable to store the deadline.
+ * @ms:		Time from now, in ms.
+ */
+static void deadline_after(struct timespec *ts, unsigned int ms)
+{
+	uint64_t ns = now_ns(CLOCK_MONOTONIC) + ms * 1000000ULL;
+
+	ts->tv_sec = ns / NSEC_PER_SEC;
+	ts->tv_nsec = ns % NSEC_PER_SEC;
+}
+
+/*
+ * tx_frame() - Pads and sends a frame of the link
+ *
+ * @link:	ISO-TP link.
+ * @frame:	Frame with the data already filled.
+ * @len:	Number of data bytes used.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int tx_frame(isotp_link_t *link, struct canfd_frame *frame, size_t len)
+{
+	struct timespec retry = { 0, TX_RETRY_NS };
+	size_t dlen = len;
+	int retries = TX_RETRIES;
+	int ret;
+
+	/* CAN FD frames always have a valid DLC length, pad up to it */
+	if (link->cfg.tx_dl > CAN_MAX_DLEN)
+		dlen = can_payload_valid_len(len);
+	else if (link->cfg.padding >= 0)
+		dlen = CAN_MAX_DLEN;
+	if (dlen > len)
+		memset(&frame->data[len],
+		       link->cfg.padding >= 0 ? link->cfg.padding : 0,
+		       dlen - len);
+
+	frame->can_id = link->tx_id;
+	frame->len = dlen;
+	frame->flags = link->cfg.tx_dl > CAN_MAX_DLEN && link->cfg.brs ?
+		       CANFD_BRS : 0;
+
+	while (retries--) {
+		if (link->cif) {
+			ret = ldx_can_tx_frame(link->cif, frame);
+			if (ret != -CAN_ERROR_TX_RETRY_LATER)
+				return ret ? -EIO : 0;
+		} else {
+			if (write(link->fd, frame,
+				  link->cfg.tx_dl > CAN_MAX_DLEN ?
+				  CANFD_MTU : CAN_MTU) > 0)
+				return 0;
+			if (errno != ENOBUFS && errno != EAGAIN &&
+			    errno != EINTR)
+				return -errno;
+		}
+		nanosleep(&retry, NULL);
+	}
+
+	return -ENOBUFS;
+}
+
+/*
+ * send_fc() - Sends a flow control frame
+ *
+ * @link:	ISO-TP link.
+ * @status:	Flow status.
+ */
+static void send_fc(isotp_link_t *link, uint8_t status)
+{
+	struct canfd_frame frame;
+
+	frame.data[0] = (PCI_FC << 4) | status;
+	frame.data[1] = link->cfg.bs;
+	frame.data[2] = link->cfg.stmin;
+	tx_frame(link, &frame, 3);
+}
+
+/*
+ * rx_complete() - Finishes the reception of a message and wakes the reader
+ *
+ * @link:	ISO-TP link.
+ * @state:	RX_DONE or RX_ERROR.
+ */
+static void rx_complete(isotp_link_t *link, enum rx_state state)
+{
+	link->rx_state = state;
+	link->rx_delivered = false;
+	pthread_cond_broadcast(&link->cond);
+}
+
+/*
+ * rx_single() - Processes a received single frame
+ *
+ * @link:	ISO-TP link.
+ * @frame:	Received frame.
+ */
+static void rx_single(isotp_link_t *link, const struct canfd_frame *frame)
+{
+	size_t len = frame->data[0] & 0xf, off = 1;
+
+	/* Single frames longer than 7 bytes use an escape sequence */
+	if (!len && frame->len > CAN_MAX_DLEN) {
+		len = frame->data[1];
+		off = 2;
+	}
+
+	if (!len || len + off > frame->len || len > link->rx_size)
+		return;
+
+	memcpy(link->rx_buf, &frame->data[off], len);
+	link->rx_len = len;
+	rx_complete(link, RX_DONE);
+}
+
+/*
+ * rx_first() - Processes a received first frame
+ *
+ * @link:	ISO-TP link.
+ * @frame:	Received frame.
+ */
+static void rx_first(isotp_link_t *link, const struct canfd_frame *frame)
+{
+	size_t len, off;
+
+	if (frame->len < CAN_MAX_DLEN)
+		return;
+
+	len = ((frame->data[0] & 0xf) << 8) | frame->data[1];
+	off = 2;
+	if (!len) {
+		/* Escape sequence, 32-bit message length */
+		len = ((uint32_t)frame->data[2] << 24) |
+		      ((uint32_t)frame->data[3] << 16) |
+		      ((uint32_t)frame->data[4] << 8) | frame->data[5];
+		off = 6;
+	}
+
+	if (len > link->rx_size) {
+		send_fc(link, FC_OVFLW);
+		link->rx_state = RX_IDLE;
+		return;
+	}
+	if (len <= frame->len - off)
+		return;
+
+	memcpy(link->rx_buf, &frame->data[off], frame->len - off);
+	link->rx_len = len;
+	link->rx_off = frame->len - off;
+	link->rx_sn = 1;
+	link->rx_bs_count = 0;
+	link->rx_state = RX_BUSY;
+
+	send_fc(link, FC_CTS);
+}
+
+/*
+ * rx_consecutive() - Processes a received consecutive frame
+ *
+ * @link:	ISO-TP link.
+ * @frame:	Received frame.
+ */
+static void rx_consecutive(isotp_link_t *link, const struct canfd_frame *frame)
+{
+	size_t chunk;
+
+	if (link->rx_state != RX_BUSY || frame->len < 2)
+		return;
+
+	if ((frame->data[0] & 0xf) != (link->rx_sn & 0xf)) {
+		rx_complete(link, RX_ERROR);
+		return;
+	}
+
+	chunk = frame->len - 1;
+	if (chunk > link->rx_len - link->rx_off)
+		chunk = link->rx_len - link->rx_off;
+
+	/* Reassemble straight into the caller buffer */
+	memcpy(link->rx_buf + link->rx_off, &frame->data[1], chunk);
+	link->rx_off += chunk;
+	link->rx_sn++;
+
+	if (link->rx_off == link->rx_len) {
+		rx_complete(link, RX_DONE);
+		return;
+	}
+
+	if (link->cfg.bs && ++link->rx_bs_count == link->cfg.bs) {
+		link->rx_bs_count = 0;
+		send_fc(link, FC_CTS);
+	}
+}
+
+/*
+ * rx_flow_control() - Processes a received flow control frame
+ *
+ * @link:	ISO-TP link.
+ * @frame:	Received frame.
+ */
+static void rx_flow_control(isotp_link_t *link, const struct canfd_frame *frame)
+{
+	if (frame->len < 3)
+		return;
+
+	link->fc_status = frame->data[0] & 0xf;
+	link->fc_bs = frame->data[1];
+	link->fc_stmin = frame->data[2];
+	link->fc_pending = true;
+	pthread_cond_broadcast(&link->cond);
+}
+
+/*
+ * rx_frame() - Processes a frame received on a link
+ *
+ * @link:	ISO-TP link.
+ * @frame:	Received frame.
+ */
+static void rx_frame(isotp_link_t *link, const struct canfd_frame *frame)
+{
+	if (!frame->len)
+		return;
+
+	pthread_mutex_lock(&link->lock);
+
+	switch (frame->data[0] >> 4) {
+	case PCI_SF:
+	case PCI_FF:
+		/* The previous message has not been read yet */
+		if (link->rx_state == RX_DONE)
+			break;
+		if (frame->data[0] >> 4 == PCI_SF)
+			rx_single(link, frame);
+		else
+			rx_first(link, frame);
+		break;
+	case PCI_CF:
+		rx_consecutive(link, frame);
+		break;
+	case PCI_FC:
+		rx_flow_control(link, frame);
+		break;
+	default:
+		break;
+	}
+
+	pthread_mutex_unlock(&link->lock);
+}
+
+/*
+ * isotp_rx_callback() - Library reception callback of all the links
+ *
+ * The library callback does not get any context, so the link is found by
+ * the CAN ID of the frame.
+ *
+ * @frame:	Received frame.
+ * @tv:		Reception timestamp.
+ */
+static void isotp_rx_callback(struct canfd_frame *frame, struct timeval *tv)
+{
+	int i;
+
+	for (i = 0; i < ISOTP_MAX_LINKS; i++) {
+		if (links[i] && links[i]->rx_id == (frame->can_id & ID_MASK)) {
+			rx_frame(links[i], frame);
+			break;
+		}
+	}
+}
+
+/*
+ * rx_thread_fn() - Reception thread of a socket link
+ *
+ * @arg:	ISO-TP link.
+ */
+static void *rx_thread_fn(void *arg)
+{
+	isotp_link_t *link = arg;
+	struct canfd_frame frame;
+	int ret;
+
+	for (;;) {
+		ret = can_socket_recv(link->fd, &frame, NULL);
+		if (ret == -EINTR)
+			continue;
+		if (ret < 0)
+			break;
+
+		/* Only cancel the thread while it waits for frames */
+		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+		rx_frame(link, &frame);
+		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+	}
+
+	return NULL;
+}
+
+/*
+ * wait_fc() - Waits for a flow control frame that allows to continue
+ *
+ * @link:	ISO-TP link, locked.
+ * @bs:		Variable to store the block size.
+ * @stmin_ns:	Variable to store the minimum separation time.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int wait_fc(isotp_link_t *link, uint8_t *bs, uint64_t *stmin_ns)
+{
+	struct timespec deadline;
+	int wft = 0, ret;
+
+	for (;;) {
+		deadline_after(&deadline, link->cfg.timeout_ms);
+		while (!link->fc_pending) {
+			ret = pthread_cond_timedwait(&link->cond, &link->lock,
+						     &deadline);
+			if (ret == ETIMEDOUT)
+				return -ETIMEDOUT;
+		}
+		link->fc_pending = false;
+
+		switch (link->fc_status) {
+		case FC_CTS:
+			*bs = link->fc_bs;
+			*stmin_ns = stmin_to_ns(link->fc_stmin);
+			return 0;
+		case FC_WAIT:
+			if (++wft > MAX_WFT)
+				return -ETIMEDOUT;
+			break;
+		case FC_OVFLW:
+			return -EMSGSIZE;
+		default:
+			return -EPROTO;
+		}
+	}
+}
+
+int isotp_send(isotp_link_t *link, const uint8_t *data, size_t len)
+{
+	uint8_t dl = link->cfg.tx_dl;
+	struct canfd_frame frame;
+	struct timespec next_cf;
+	uint64_t stmin_ns = 0, next_ns;
+	size_t off, chunk, hdr;
+	unsigned int block;
+	uint8_t bs, sn = 1;
+	int ret;
+
+	if (!len || len > ISOTP_MAX_MSG_LEN)
+		return -EINVAL;
+
+	/* Single frame */
+	if (len <= CAN_MAX_DLEN - 1) {
+		frame.data[0] = (PCI_SF << 4) | len;
+		memcpy(&frame.data[1], data, len);
+		return tx_frame(link, &frame, len + 1);
+	}
+	if (dl > CAN_MAX_DLEN && len <= (size_t)dl - 2) {
+		frame.data[0] = PCI_SF << 4;
+		frame.data[1] = len;
+		memcpy(&frame.data[2], data, len);
+		return tx_frame(link, &frame, len + 2);
+	}
+
+	/* First frame, with the escape sequence for long messages */
+	if (len <= FF_DL_12BIT_MAX) {
+		frame.data[0] = (PCI_FF << 4) | (len >> 8);
+		frame.data[1] = len & 0xff;
+		hdr = 2;
+	} else {
+		frame.data[0] = PCI_FF << 4;
+		frame.data[1] = 0;
+		frame.data[2] = len >> 24;
+		frame.data[3] = len >> 16;
+		frame.data[4] = len >> 8;
+		frame.data[5] = len;
+		hdr = 6;
+	}
+	off = dl - hdr;
+	memcpy(&frame.data[hdr], data, off);
+
+	pthread_mutex_lock(&link->lock);
+	link->fc_pending = false;
+	pthread_mutex_unlock(&link->lock);
+
+	ret = tx_frame(link, &frame, dl);
+	if (ret)
+		return ret;
+
+	while (off < len) {
+		pthread_mutex_lock(&link->lock);
+		ret = wait_fc(link, &bs, &stmin_ns);
+		pthread_mutex_unlock(&link->lock);
+		if (ret)
+			return ret;
+
+		block = bs ? bs : UINT32_MAX;
+		next_ns = now_ns(CLOCK_MONOTONIC);
+
+		while (off < len && block--) {
+			if (stmin_ns) {
+				next_cf.tv_sec = next_ns / NSEC_PER_SEC;
+				next_cf.tv_nsec = next_ns % NSEC_PER_SEC;
+				while (clock_nanosleep(CLOCK_MONOTONIC,
+						       TIMER_ABSTIME, &next_cf,
+						       NULL) == EINTR)
+					;
+			}
+
+			chunk = len - off;
+			if (chunk > (size_t)dl - 1)
+				chunk = dl - 1;
+
+			frame.data[0] = (PCI_CF << 4) | (sn++ & 0xf);
+			memcpy(&frame.data[1], data + off, chunk);
+			ret = tx_frame(link, &frame, chunk + 1);
+			if (ret)
+				return ret;
+			off += chunk;
+
+			if (stmin_ns)
+				next_ns = now_ns(CLOCK_MONOTONIC) + stmin_ns;
+		}
+	}
+
+	return 0;
+}
+
+ssize_t isotp_recv(isotp_link_t *link, unsigned int timeout_ms)
+{
+	struct timespec deadline;
+	ssize_t ret;
+
+	deadline_after(&deadline, timeout_ms);
+
+	pthread_mutex_lock(&link->lock);
+
+	/* Release the message returned by the previous call */
+	if (link->rx_state == RX_DONE && link->rx_delivered)
+		link->rx_state = RX_IDLE;
+
+	while (link->rx_state != RX_DONE && link->rx_state != RX_ERROR) {
+		if (pthread_cond_timedwait(&link->cond, &link->lock,
+					   &deadline) == ETIMEDOUT)
+			break;
+	}
+
+	switch (link->rx_state) {
+	case RX_DONE:
+		link->rx_delivered = true;
+		ret = link->rx_len;
+		break;
+	case RX_ERROR:
+		link->rx_state = RX_IDLE;
+		ret = -EPROTO;
+		break;
+	default:
+		/* Abort the message in progress, if any */
+		link->rx_state = RX_IDLE;
+		ret = -ETIMEDOUT;
+		break;
+	}
+
+	pthread_mutex_unlock(&link->lock);
+
+	return ret;
+}
+
+/*
+ * link_alloc() - Allocates and initializes a link
+ *
+ * @tx_id:	CAN ID of the transmitted frames.
+ * @rx_id:	CAN ID of the received frames.
+ * @cfg:	Link configuration.
+ * @rx_buf:	Reception buffer.
+ * @rx_size:	Size of the reception buffer.
+ *
+ * Return: The link, NULL on error.
+ */
+static isotp_link_t *link_alloc(uint32_t tx_id, uint32_t rx_id,
+				const struct isotp_cfg *cfg, uint8_t *rx_buf,
+				size_t rx_size)
+{
+	pthread_condattr_t attr;
+	isotp_link_t *link;
+
+	if (cfg->tx_dl < CAN_MAX_DLEN || cfg->tx_dl > CANFD_MAX_DLEN ||
+	    can_payload_valid_len(cfg->tx_dl) != cfg->tx_dl)
+		return NULL;
+
+	link = calloc(1, sizeof(*link));
+	if (!link)
+		return NULL;
+
+	link->fd = -1;
+	link->tx_id = tx_id & ID_MASK;
+	link->rx_id = rx_id & ID_MASK;
+	link->cfg = *cfg;
+	link->rx_buf = rx_buf;
+	link->rx_size = rx_size;
+
+	/* Timeouts are computed with the monotonic clock */
+	pthread_mutex_init(&link->lock, NULL);
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(&link->cond, &attr);
+	pthread_condattr_destroy(&attr);
+
+	return link;
+}
+
+/*
+ * link_free() - Frees a link allocated with link_alloc()
+ *
+ * @link:	ISO-TP link.
+ */
+static void link_free(isotp_link_t *link)
+{
+	pthread_cond_destroy(&link->cond);
+	pthread_mutex_destroy(&link->lock);
+	free(link);
+}
+
+/*
+ * rx_filter() - Builds the filter that only accepts the frames of a link
+ *
+ * @link:	ISO-TP link.
+ * @filter:	Filter to fill.
+ */
+static void rx_filter(const isotp_link_t *link, struct can_filter *filter)
+{
+	filter->can_id = link->rx_id;
+	filter->can_mask = CAN_EFF_FLAG | CAN_RTR_FLAG |
+			   (link->rx_id & CAN_EFF_FLAG ?
+			    CAN_EFF_MASK : CAN_SFF_MASK);
+}
+
+isotp_link_t *isotp_open(can_if_t *cif, uint32_t tx_id, uint32_t rx_id,
+			 const struct isotp_cfg *cfg, uint8_t *rx_buf,
+			 size_t rx_size)
+{
+	struct can_filter filter;
+	isotp_link_t *link;
+	int i, slot = -1;
+
+	link = link_alloc(tx_id, rx_id, cfg, rx_buf, rx_size);
+	if (!link)
+		return NULL;
+
+	link->cif = cif;
+
+	pthread_mutex_lock(&links_lock);
+	for (i = 0; i < ISOTP_MAX_LINKS; i++) {
+		if (!links[i]) {
+			if (slot < 0)
+				slot = i;
+		} else if (links[i]->rx_id == link->rx_id) {
+			/* Another link already receives these frames */
+			slot = -1;
+			break;
+		}
+	}
+	if (slot >= 0)
+		links[slot] = link;
+	pthread_mutex_unlock(&links_lock);
+
+	if (slot < 0)
+		goto free_link;
+
+	rx_filter(link, &filter);
+	if (ldx_can_register_rx_handler(cif, isotp_rx_callback, &filter, 1) < 0) {
+		pthread_mutex_lock(&links_lock);
+		links[slot] = NULL;
+		pthread_mutex_unlock(&links_lock);
+		goto free_link;
+	}
+
+	return link;
+
+free_link:
+	link_free(link);
+
+	return NULL;
+}
+
+isotp_link_t *isotp_open_socket(const char *iface, uint32_t tx_id,
+				uint32_t rx_id, const struct isotp_cfg *cfg,
+				uint8_t *rx_buf, size_t rx_size)
+{
+	struct can_filter filter;
+	isotp_link_t *link;
+
+	link = link_alloc(tx_id, rx_id, cfg, rx_buf, rx_size);
+	if (!link)
+		return NULL;
+
+	link->fd = can_socket_open(iface, cfg->tx_dl > CAN_MAX_DLEN ?
+					  CAN_SOCK_FD : 0);
+	if (link->fd < 0)
+		goto free_link;
+
+	rx_filter(link, &filter);
+	if (setsockopt(link->fd, SOL_CAN_RAW, CAN_RAW_FILTER, &filter,
+		       sizeof(filter)) < 0)
+		goto close_sock;
+
+	if (pthread_create(&link->rx_thread, NULL, rx_thread_fn, link))
+		goto close_sock;
+
+	return link;
+
+close_sock:
+	close(link->fd);
+free_link:
+	link_free(link);
+
+	return NULL;
+}
+
+void isotp_close(isotp_link_t *link)
+{
+	int i;
+
+	if (!link)
+		return;
+
+	if (!link->cif) {
+		pthread_cancel(link->rx_thread);
+		pthread_join(link->rx_thread, NULL);
+		close(link->fd);
+		link_free(link);
+		return;
+	}
+
+	ldx_can_unregister_rx_handler(link->cif, isotp_rx_callback);
+
+	pthread_mutex_lock(&links_lock);
+	for (i = 0; i < ISOTP_MAX_LINKS; i++)
+		if (links[i] == link)
+			links[i] = NULL;
+	pthread_mutex_unlock(&links_lock);
+
+	link_free(link);
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CAN_ISOTP_H_
+#define CAN_ISOTP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <libdigiapix/can.h>
+
+/* Maximum number of links open at the same time */
+#define ISOTP_MAX_LINKS			8
+
+#define ISOTP_DEF_TIMEOUT_MS		1000
+#define ISOTP_DEF_PADDING		0xCC
+
+/* Largest message the 32-bit first frame escape sequence can announce */
+#define ISOTP_MAX_MSG_LEN		UINT32_MAX
+
+struct isotp_cfg {
+	uint8_t tx_dl;		/* Frame length: 8 (CAN 2.0) or up to 64 (FD) */
+	bool brs;		/* Set the bit rate switch flag in FD frames */
+	uint8_t bs;		/* Block size announced to the sender, 0 = all */
+	uint8_t stmin;		/* Raw STmin announced to the sender */
+	int padding;		/* Padding byte, negative to disable padding */
+	unsigned int timeout_ms;	/* N_Bs/N_Cr timeout */
+};
+
+typedef struct isotp_link isotp_link_t;
+
+/*
+ * isotp_set_defconfig() - Fills an ISO-TP configuration with the defaults
+ *
+ * CAN 2.0 frames, padding enabled, no block size limit and no STmin.
+ *
+ * @cfg:	Configuration to fill.
+ */
+void isotp_set_defconfig(struct isotp_cfg *cfg);
+
+/*
+ * isotp_open() - Opens an ISO-TP link on an initialized CAN interface
+ *
+ * Registers a reception handler on the interface for the 'rx_id' frames.
+ * Only one link can be opened per interface handle and the reception IDs of
+ * the open links must be different.
+ *
+ * Received messages are reassembled directly in 'rx_buf', nothing is
+ * allocated per frame. Messages longer than 'rx_size' are rejected with an
+ * overflow flow control frame.
+ *
+ * @cif:	CAN interface initialized with ldx_can_init().
+ * @tx_id:	CAN ID of the transmitted frames (with CAN_EFF_FLAG if extended).
+ * @rx_id:	CAN ID of the received frames (with CAN_EFF_FLAG if extended).
+ * @cfg:	Link configuration.
+ * @rx_buf:	Reception buffer.
+ * @rx_size:	Size of the reception buffer.
+ *
+ * Return: The link, NULL on error.
+ */
+isotp_link_t *isotp_open(can_if_t *cif, uint32_t tx_id, uint32_t rx_id,
+			 const struct isotp_cfg *cfg, uint8_t *rx_buf,
+			 size_t rx_size);
+
+/*
+ * isotp_open_socket() - Opens an ISO-TP link on its own CAN_RAW socket
+ *
+ * Same as isotp_open() but without the library: the link sends and receives
+ * the frames through a socket bound to 'iface', read by a dedicated thread.
+ * The interface is not configured, it must be already up. This is what a
+ * virtual CAN interface needs, as it has no bitrate to configure.
+ *
+ * @iface:	Name of the CAN interface.
+ * @tx_id:	CAN ID of the transmitted frames (with CAN_EFF_FLAG if extended).
+ * @rx_id:	CAN ID of the received frames (with CAN_EFF_FLAG if extended).
+ * @cfg:	Link configuration.
+ * @rx_buf:	Reception buffer.
+ * @rx_size:	Size of the reception buffer.
+ *
+ * Return: The link, NULL on error.
+ */
+isotp_link_t *isotp_open_socket(const char *iface, uint32_t tx_id,
+				uint32_t rx_id, const struct isotp_cfg *cfg,
+				uint8_t *rx_buf, size_t rx_size);
+
+/*
+ * isotp_send() - Sends a message, blocking until it has been transmitted
+ *
+ * Honors the block size and STmin of the flow control frames received from
+ * the peer.
+ *
+ * @link:	ISO-TP link.
+ * @data:	Message to send.
+ * @len:	Length of the message.
+ *
+ * Return: 0 on success, -ETIMEDOUT if the peer does not send a flow
+ *	   control frame in time, -EMSGSIZE if the peer cannot receive the
+ *	   message, -errno on other errors.
+ */
+int isotp_send(isotp_link_t *link, const uint8_t *data, size_t len);
+
+/*
+ * isotp_recv() - Waits for a complete message in the reception buffer
+ *
+ * The message stays in the reception buffer until the next call, the
+ * frames of a new message are not accepted in the meantime.
+ *
+ * @link:	ISO-TP link.
+ * @timeout_ms:	Maximum time to wait, in ms.
+ *
+ * Return: The length of the message, -ETIMEDOUT if no message was completed
+ *	   in time, -EPROTO if the reception failed.
+ */
+ssize_t isotp_recv(isotp_link_t *link, unsigned int timeout_ms);
+
+/*
+ * isotp_close() - Closes an ISO-TP link
+ *
+ * @link:	ISO-TP link.
+ */
+void isotp_close(isotp_link_t *link);
+
+#endif /* CAN_ISOTP_H_ */
@@ -0,0 +1,653 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <libgen.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+
+#include <libdigiapix/can.h>
+
+#include "can-utils.h"
+
+#define DEFAULT_IFACE		"vcan0"
+#define DEFAULT_ITERATIONS	100000
+#define DEFAULT_PING_ID		0x100
+
+/* Maximum time to wait for the echo of a frame */
+#define PONG_TIMEOUT_MS		100
+
+/* Bitrate used to compute the TX retry wait without -b */
+#define RETRY_BITRATE		1000000
+
+/*
+ * Payload layout, fits in a classic CAN frame:
+ *  - Bytes 0-1: sequence number (little endian).
+ *  - Bytes 2-7: TX timestamp in ns from the start of the test (little endian).
+ */
+#define PAYLOAD_LEN		8
+#define SEQ_BYTES		2
+#define TS_BYTES		6
+
+static bool running = true;
+static bool canfd = false;
+static uint32_t ping_id = DEFAULT_PING_ID;
+static int echo_prio = 0, echo_cpu = -1;
+
+static can_if_t *ping_if, *echo_if;
+static int ping_sock = -1, echo_sock = -1;
+static pthread_t echo_thread;
+static bool echo_thread_running = false;
+static uint32_t *rtts;
+
+/*
+ * usage_and_exit() - Show usage information and exit with 'exitval' return
+ *		      value
+ *
+ * @name:	Application name.
+ * @exitval:	The exit code.
+ */
+static void usage_and_exit(char *name, int exitval)
+{
+	printf(
+		"Example application to measure the CAN round-trip latency\n"
+		"\n"
+		"Usage: %s [options]\n\n"
+		"-i <can-iface>      Interface that sends the frames (default %s)\n"
+		"-e <can-iface>      Interface that echoes the frames (default: same\n"
+		"                    as -i, valid for virtual CAN interfaces)\n"
+		"-b <bitrate>        Configure the interfaces with this bitrate (Hz).\n"
+		"                    If not set, the interfaces must be already up\n"
+		"-o                  Enable CAN FD support\n"
+		"--- CAN FD options ---\n"
+		"  -d <dbitrate>      Maximum data bitrate for CAN FD (Hz)\n"
+		"---\n"
+		"-n <iterations>     Number of round trips (default %d)\n"
+		"-I <msg_id>         Ping message id in hex, the echo uses id + 1\n"
+		"                    (default %x)\n"
+		"-l <data_length>    Payload length (default and minimum %d)\n"
+		"-t <delay>          Delay between round trips in us (default 0)\n"
+		"-P <priority>       Run the ping and echo threads with SCHED_FIFO\n"
+		"                    and this priority\n"
+		"-C <cpu>            Pin the ping thread to this CPU\n"
+		"-E <cpu>            Pin the echo thread to this CPU\n"
+		"-L                  Echo the frames from the libdigiapix reception\n"
+		"                    callback instead of a dedicated thread (needs -b)\n"
+		"-h                  Help\n"
+		"\n"
+		"Examples:\n"
+		"%s -i vcan0 -n 1000000\n"
+		"%s -i can0 -e can1 -b 1000000 -P 80 -C 1 -E 1\n"
+		"%s -i can0 -e can1 -b 1000000 -L\n"
+		"\n", name, DEFAULT_IFACE, DEFAULT_ITERATIONS, DEFAULT_PING_ID,
+		PAYLOAD_LEN, name, name, name);
+
+	exit(exitval);
+}
+
+/*
+ * cleanup() - Frees all the allocated memory before exiting
+ */
+static void cleanup(void)
+{
+	running = false;
+
+	if (echo_thread_running) {
+		pthread_cancel(echo_thread);
+		pthread_join(echo_thread, NULL);
+		echo_thread_running = false;
+	}
+
+	if (echo_if) {
+		ldx_can_free(echo_if);
+		echo_if = NULL;
+	}
+
+	if (ping_if) {
+		ldx_can_free(ping_if);
+		ping_if = NULL;
+	}
+
+	if (echo_sock >= 0)
+		close(echo_sock);
+	if (ping_sock >= 0)
+		close(ping_sock);
+
+	free(rtts);
+}
+
+/*
+ * sigaction_handler() - Handler to execute after receiving a signal
+ *
+ * @signum:	Received signal.
+ */
+static void sigaction_handler(int signum)
+{
+	/* Stop the test and print the results of the completed round trips */
+	running = false;
+}
+
+/*
+ * register_signals() - Registers program signals
+ */
+static void register_signals(void)
+{
+	struct sigaction action;
+
+	action.sa_handler = sigaction_handler;
+	action.sa_flags = 0;
+	sigemptyset(&action.sa_mask);
+
+	sigaction(SIGHUP, &action, NULL);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+}
+
+static void put_le(uint8_t *p, uint64_t val, int nbytes)
+{
+	int i;
+
+	for (i = 0; i < nbytes; i++, val >>= 8)
+		p[i] = val & 0xff;
+}
+
+static uint64_t get_le(const uint8_t *p, int nbytes)
+{
+	uint64_t val = 0;
+	int i;
+
+	for (i = nbytes - 1; i >= 0; i--)
+		val = (val << 8) | p[i];
+
+	return val;
+}
+
+/*
+ * echo_frame() - Converts a ping frame into its echo
+ *
+ * @frame:	Received ping frame.
+ *
+ * Return: true if the frame is a ping and must be echoed, false otherwise.
+ */
+static bool echo_frame(struct canfd_frame *frame)
+{
+	if ((frame->can_id & CAN_SFF_MASK) != ping_id)
+		return false;
+
+	frame->can_id = (ping_id + 1) & CAN_SFF_MASK;
+
+	return true;
+}
+
+/*
+ * echo_rx_callback() - Library reception callback for the echo interface
+ *
+ * @frame:	Received frame.
+ * @tv:		Reception timestamp.
+ */
+static void echo_rx_callback(struct canfd_frame *frame, struct timeval *tv)
+{
+	if (echo_frame(frame))
+		ldx_can_tx_frame(echo_if, frame);
+}
+
+/*
+ * echo_thread_fn() - Echo thread, returns the ping frames as fast as possible
+ *
+ * @arg:	Unused.
+ */
+static void *echo_thread_fn(void *arg)
+{
+	struct canfd_frame frame;
+	int ret;
+
+	ret = thread_set_realtime(echo_prio, echo_cpu);
+	if (ret)
+		printf("Unable to configure the echo thread (%s)\n",
+		       strerror(-ret));
+
+	for (;;) {
+		ret = can_socket_recv(echo_sock, &frame, NULL);
+		if (ret < 0) {
+			if (ret == -EINTR)
+				continue;
+			printf("Error reading echo frame (%s)\n", strerror(-ret));
+			break;
+		}
+
+		if (echo_frame(&frame))
+			write(echo_sock, &frame, ret);
+	}
+
+	return NULL;
+}
+
+/*
+ * init_iface() - Requests and configures an interface through the library
+ *
+ * @iface:	Name of the CAN interface.
+ * @ifcfg:	Interface configuration.
+ *
+ * Return: The interface, NULL on error.
+ */
+static can_if_t *init_iface(const char *iface, can_if_cfg_t *ifcfg)
+{
+	can_if_t *cif;
+
+	printf("Initializing CAN interface %s... ", iface);
+	cif = ldx_can_request_by_name(iface);
+	if (!cif || ldx_can_init(cif, ifcfg)) {
+		printf("ERROR\n");
+		if (cif)
+			ldx_can_free(cif);
+		return NULL;
+	}
+	printf("OK\n");
+
+	return cif;
+}
+
+/*
+ * open_filtered_socket() - Opens a socket that only receives one CAN ID
+ *
+ * @iface:	Name of the CAN interface.
+ * @id:		Standard CAN ID to receive.
+ *
+ * Return: The socket file descriptor, -errno on error.
+ */
+static int open_filtered_socket(const char *iface, uint32_t id)
+{
+	struct can_filter filter = {
+		.can_id = id,
+		.can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG,
+	};
+	int fd;
+
+	fd = can_socket_open(iface, canfd ? CAN_SOCK_FD : 0);
+	if (fd < 0)
+		return fd;
+
+	if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, &filter,
+		       sizeof(filter)) < 0) {
+		int ret = -errno;
+
+		close(fd);
+		return ret;
+	}
+
+	return fd;
+}
+
+/*
+ * send_ping() - Sends a ping frame, waiting while the TX queue is full
+ *
+ * A full queue (ENOBUFS) does not clear on a bus without acknowledgment or
+ * with the controller in bus-off, so the frame is given up after waiting
+ * as long as for its echo.
+ *
+ * @frame:	Ping frame, with the sequence number already set.
+ * @base_ns:	Start time of the test.
+ * @retry_ns:	Time to wait before retrying, about one frame time.
+ *
+ * Return: 0 on success, -ENOBUFS if the TX queue stays full, -errno on error.
+ */
+static int send_ping(struct canfd_frame *frame, uint64_t base_ns,
+		     uint64_t retry_ns)
+{
+	struct timespec retry = {
+		.tv_sec = retry_ns / NSEC_PER_SEC,
+		.tv_nsec = retry_ns % NSEC_PER_SEC,
+	};
+	uint64_t now, deadline;
+
+	deadline = now_ns(CLOCK_MONOTONIC) + PONG_TIMEOUT_MS * 1000000ULL;
+
+	while (running) {
+		now = now_ns(CLOCK_MONOTONIC);
+		put_le(frame->data + SEQ_BYTES, now - base_ns, TS_BYTES);
+
+		if (write(ping_sock, frame, canfd ? CANFD_MTU : CAN_MTU) >= 0)
+			return 0;
+		if (errno == EINTR)
+			continue;
+		if (errno != ENOBUFS)
+			return -errno;
+		if (now >= deadline)
+			return -ENOBUFS;
+
+		nanosleep(&retry, NULL);
+	}
+
+	return -EINTR;
+}
+
+/*
+ * wait_pong() - Waits for the echo of a ping frame
+ *
+ * @seq:	Sequence number of the ping.
+ * @rtt_ns:	Variable to store the round-trip time.
+ * @base_ns:	Start time of the test.
+ *
+ * Return: 0 on success, -ETIMEDOUT if the echo is lost, -errno on error.
+ */
+static int wait_pong(uint16_t seq, uint64_t *rtt_ns, uint64_t base_ns)
+{
+	struct pollfd pfd = { .fd = ping_sock, .events = POLLIN };
+	struct canfd_frame frame;
+	uint64_t deadline, now;
+	int timeout, ret;
+
+	deadline = now_ns(CLOCK_MONOTONIC) + PONG_TIMEOUT_MS * 1000000ULL;
+
+	while (running) {
+		now = now_ns(CLOCK_MONOTONIC);
+		if (now >= deadline)
+			return -ETIMEDOUT;
+		timeout = (deadline - now + 999999) / 1000000;
+
+		ret = poll(&pfd, 1, timeout);
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		if (!ret)
+			return -ETIMEDOUT;
+
+		ret = can_socket_recv(ping_sock, &frame, NULL);
+		if (ret < 0)
+			return ret;
+
+		now = now_ns(CLOCK_MONOTONIC);
+
+		/* Discard late echoes of previous pings */
+		if (frame.len < PAYLOAD_LEN ||
+		    get_le(frame.data, SEQ_BYTES) != seq)
+			continue;
+
+		*rtt_ns = now - base_ns - get_le(frame.data + SEQ_BYTES, TS_BYTES);
+		return 0;
+	}
+
+	return -EINTR;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/*
+ * print_results() - Prints the round-trip time percentiles
+ *
+ * @count:	Number of measured round trips.
+ * @lost:	Number of lost frames.
+ */
+static void print_results(uint32_t count, uint32_t lost)
+{
+	uint64_t sum = 0;
+	uint32_t i;
+
+	printf("\nRound trips: %u, lost: %u\n", count, lost);
+	if (!count)
+		return;
+
+	qsort(rtts, count, sizeof(*rtts), cmp_u32);
+	for (i = 0; i < count; i++)
+		sum += rtts[i];
+
+#define PCT(p)	(rtts[(size_t)((p) * (count - 1))] / 1e3)
+	printf("RTT (us): min %.1f  avg %.1f  p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+	       rtts[0] / 1e3, (double)sum / count / 1e3, PCT(0.5), PCT(0.99),
+	       PCT(0.999), rtts[count - 1] / 1e3);
+#undef PCT
+}
+
+int main(int argc, char **argv)
+{
+	char *name = basename(argv[0]);
+	char *ping_iface = DEFAULT_IFACE, *echo_iface = NULL;
+	can_if_cfg_t ifcfg;
+	struct canfd_frame frame;
+	uint32_t iterations = DEFAULT_ITERATIONS, count = 0, lost = 0;
+	uint32_t delay_us = 0;
+	uint8_t msg_len = PAYLOAD_LEN;
+	uint64_t base_ns, rtt, retry_ns;
+	bool use_library = false;
+	int ping_prio = 0, ping_cpu = -1;
+	int result = EXIT_SUCCESS;
+	int opt, ret;
+	uint16_t seq;
+
+	ldx_can_set_defconfig(&ifcfg);
+	ifcfg.bitrate = 0;
+
+	while ((opt = getopt(argc, argv, "i:e:b:d:on:I:l:t:P:C:E:Lh")) > 0) {
+		switch (opt) {
+		case 'i':
+			ping_iface = optarg;
+			break;
+
+		case 'e':
+			echo_iface = optarg;
+			break;
+
+		case 'b':
+			ifcfg.bitrate = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'd':
+			ifcfg.dbitrate = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'o':
+			ifcfg.canfd_enabled = true;
+			canfd = true;
+			break;
+
+		case 'n':
+			iterations = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'I':
+			ping_id = strtoul(optarg, NULL, 16) & CAN_SFF_MASK;
+			break;
+
+		case 'l':
+			msg_len = strtoul(optarg, NULL, 10);
+			break;
+
+		case 't':
+			delay_us = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'P':
+			ping_prio = echo_prio = atoi(optarg);
+			break;
+
+		case 'C':
+			ping_cpu = atoi(optarg);
+			break;
+
+		case 'E':
+			echo_cpu = atoi(optarg);
+			break;
+
+		case 'L':
+			use_library = true;
+			break;
+
+		case 'h':
+			usage_and_exit(name, EXIT_SUCCESS);
+			break;
+
+		default:
+			usage_and_exit(name, EXIT_FAILURE);
+		}
+	}
+
+	if (!echo_iface)
+		echo_iface = ping_iface;
+
+	if (msg_len < PAYLOAD_LEN || msg_len > (canfd ? CANFD_MAX_DLEN : CAN_MAX_DLEN)) {
+		printf("Invalid payload length\n");
+		return EXIT_FAILURE;
+	}
+
+	/*
+	 * The library callbacks only run on interfaces initialized with
+	 * ldx_can_init(), which configures the bitrate of the controller, so
+	 * they cannot be used on virtual CAN interfaces.
+	 */
+	if (use_library && !ifcfg.bitrate) {
+		printf("The library echo (-L) needs the bitrate (-b) and real "
+		       "CAN hardware\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!iterations) {
+		printf("Number of iterations must be greater than 0\n");
+		return EXIT_FAILURE;
+	}
+
+	/* Register signals and exit cleanup function */
+	atexit(cleanup);
+	register_signals();
+
+	rtts = malloc(iterations * sizeof(*rtts));
+	if (!rtts) {
+		printf("Unable to allocate memory for %u results\n", iterations);
+		return EXIT_FAILURE;
+	}
+	/* Fault the results buffer in now, not during the measurements */
+	memset(rtts, 0, iterations * sizeof(*rtts));
+
+	if (ping_prio > 0 && mlockall(MCL_CURRENT | MCL_FUTURE))
+		printf("Unable to lock the memory (%s)\n", strerror(errno));
+
+	if (ifcfg.bitrate) {
+		ping_if = init_iface(ping_iface, &ifcfg);
+		if (!ping_if)
+			return EXIT_FAILURE;
+
+		/* The library echo needs its own handle even on the same interface */
+		if (use_library || strcmp(echo_iface, ping_iface)) {
+			echo_if = init_iface(echo_iface, &ifcfg);
+			if (!echo_if)
+				return EXIT_FAILURE;
+		}
+	}
+
+	ping_sock = open_filtered_socket(ping_iface, (ping_id + 1) & CAN_SFF_MASK);
+	if (ping_sock < 0) {
+		printf("Unable to open CAN socket on %s (%s)\n", ping_iface,
+		       strerror(-ping_sock));
+		return EXIT_FAILURE;
+	}
+
+	if (use_library) {
+		struct can_filter filter = {
+			.can_id = ping_id,
+			.can_mask = CAN_SFF_MASK | CAN_EFF_FLAG | CAN_RTR_FLAG,
+		};
+
+		ret = ldx_can_register_rx_handler(echo_if, echo_rx_callback,
+						  &filter, 1);
+		if (ret < 0) {
+			printf("Failed to register rx msg handler\n");
+			return EXIT_FAILURE;
+		}
+	} else {
+		echo_sock = open_filtered_socket(echo_iface, ping_id);
+		if (echo_sock < 0) {
+			printf("Unable to open CAN socket on %s (%s)\n",
+			       echo_iface, strerror(-echo_sock));
+			return EXIT_FAILURE;
+		}
+
+		ret = pthread_create(&echo_thread, NULL, echo_thread_fn, NULL);
+		if (ret) {
+			printf("Unable to create the echo thread (%d)\n", ret);
+			return EXIT_FAILURE;
+		}
+		echo_thread_running = true;
+	}
+
+	ret = thread_set_realtime(ping_prio, ping_cpu);
+	if (ret)
+		printf("Unable to configure the ping thread (%s)\n",
+		       strerror(-ret));
+
+	printf("Measuring %u round trips %s -> %s (echo by %s)...\n",
+	       iterations, ping_iface, echo_iface,
+	       use_library ? "libdigiapix callback" : "thread");
+
+	memset(&frame, 0, sizeof(frame));
+	frame.can_id = ping_id;
+	frame.len = msg_len;
+	if (canfd && ifcfg.dbitrate)
+		frame.flags = CANFD_BRS;
+
+	retry_ns = can_frame_time_ns(&frame, canfd,
+				     ifcfg.bitrate ? ifcfg.bitrate : RETRY_BITRATE,
+				     ifcfg.dbitrate);
+
+	base_ns = now_ns(CLOCK_MONOTONIC);
+
+	for (seq = 0; running && count + lost < iterations; seq++) {
+		put_le(frame.data, seq, SEQ_BYTES);
+
+		ret = send_ping(&frame, base_ns, retry_ns);
+		if (ret == -ENOBUFS) {
+			lost++;
+			continue;
+		} else if (ret == -EINTR) {
+			break;
+		} else if (ret) {
+			printf("Failed to send CAN frame (%s)\n", strerror(-ret));
+			result = EXIT_FAILURE;
+			break;
+		}
+
+		ret = wait_pong(seq, &rtt, base_ns);
+		if (ret == -ETIMEDOUT) {
+			lost++;
+		} else if (ret == 0) {
+			rtts[count++] = rtt > UINT32_MAX ? UINT32_MAX : rtt;
+		} else if (ret != -EINTR) {
+			printf("Failed to receive CAN frame (%s)\n",
+			       strerror(-ret));
+			result = EXIT_FAILURE;
+			break;
+		}
+
+		if (delay_us)
+			usleep(delay_us);
+	}
+
+	print_results(count, lost);
+
+	return result;
+}
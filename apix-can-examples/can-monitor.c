@@ -0,0 +1,340 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "can-monitor.h"
+#include "can-utils.h"
+
+/* Number of one second buckets, the longest window */
+#define MON_SECONDS		60
+/* Frames read with a single recvmmsg() call */
+#define MON_BATCH		64
+/* Period of the summary, in seconds */
+#define MON_PRINT_SECS		5
+
+/* Error classes, one per bit of the error frame CAN ID */
+#define MON_ERR_CLASSES		9
+
+static const char * const err_names[MON_ERR_CLASSES] = {
+	"tx-timeout", "lost-arb", "ctrl", "prot", "trx", "ack", "bus-off",
+	"bus-error", "restarted",
+};
+
+struct mon_bucket {
+	uint64_t bus_ns;
+	uint32_t frames;
+	uint32_t err_frames;
+	uint32_t err[MON_ERR_CLASSES];
+	enum can_state worst;
+};
+
+struct can_monitor {
+	struct mon_bucket sec[MON_SECONDS];
+	unsigned int cur;		/* Bucket of the current second */
+	unsigned int elapsed;		/* Closed seconds, saturates */
+	enum can_state state;		/* Last known controller state */
+	int tec, rec;			/* Error counters, -1 if unknown */
+	uint32_t bitrate, dbitrate;
+};
+
+/*
+ * state_name() - Returns the printable name of a controller state
+ *
+ * @state:	Controller state.
+ *
+ * Return: The state name.
+ */
+static const char *state_name(enum can_state state)
+{
+	switch (state) {
+	case CAN_STATE_ERROR_ACTIVE:
+		return "error-active";
+	case CAN_STATE_ERROR_WARNING:
+		return "error-warning";
+	case CAN_STATE_ERROR_PASSIVE:
+		return "error-passive";
+	case CAN_STATE_BUS_OFF:
+		return "bus-off";
+	case CAN_STATE_STOPPED:
+		return "stopped";
+	default:
+		return "unknown";
+	}
+}
+
+/*
+ * set_state() - Updates the controller state and reports the changes
+ *
+ * @mon:	Monitor.
+ * @state:	New controller state.
+ */
+static void set_state(struct can_monitor *mon, enum can_state state)
+{
+	struct mon_bucket *b = &mon->sec[mon->cur];
+
+	if (state != mon->state)
+		printf("CAN state changed: %s -> %s\n", state_name(mon->state),
+		       state_name(state));
+
+	mon->state = state;
+	if (state > b->worst)
+		b->worst = state;
+}
+
+/*
+ * account_error() - Accounts an error frame
+ *
+ * @mon:	Monitor.
+ * @frame:	Error frame.
+ */
+static void account_error(struct can_monitor *mon,
+			  const struct canfd_frame *frame)
+{
+	struct mon_bucket *b = &mon->sec[mon->cur];
+	canid_t err = frame->can_id & CAN_ERR_MASK;
+	int i;
+
+	b->err_frames++;
+	for (i = 0; i < MON_ERR_CLASSES; i++)
+		if (err & (1U << i))
+			b->err[i]++;
+
+#ifdef CAN_ERR_CNT
+	if (err & CAN_ERR_CNT) {
+		mon->tec = frame->data[6];
+		mon->rec = frame->data[7];
+	}
+#endif
+
+	if (err & CAN_ERR_BUSOFF) {
+		set_state(mon, CAN_STATE_BUS_OFF);
+	} else if (err & CAN_ERR_RESTARTED) {
+		set_state(mon, CAN_STATE_ERROR_ACTIVE);
+	} else if (err & CAN_ERR_CRTL) {
+		if (frame->data[1] & (CAN_ERR_CRTL_RX_PASSIVE |
+				      CAN_ERR_CRTL_TX_PASSIVE))
+			set_state(mon, CAN_STATE_ERROR_PASSIVE);
+		else if (frame->data[1] & (CAN_ERR_CRTL_RX_WARNING |
+					   CAN_ERR_CRTL_TX_WARNING))
+			set_state(mon, CAN_STATE_ERROR_WARNING);
+#ifdef CAN_ERR_CRTL_ACTIVE
+		else if (frame->data[1] & CAN_ERR_CRTL_ACTIVE)
+			set_state(mon, CAN_STATE_ERROR_ACTIVE);
+#endif
+	}
+}
+
+/*
+ * window_sum() - Adds the buckets of the last closed seconds
+ *
+ * @mon:	Monitor.
+ * @secs:	Window length in seconds.
+ * @sum:	Bucket to store the result, 'worst' is the worst state.
+ *
+ * Return: The number of seconds actually added.
+ */
+static unsigned int window_sum(const struct can_monitor *mon, unsigned int secs,
+			       struct mon_bucket *sum)
+{
+	const struct mon_bucket *b;
+	unsigned int i, j;
+
+	memset(sum, 0, sizeof(*sum));
+	if (secs > mon->elapsed)
+		secs = mon->elapsed;
+
+	for (i = 1; i <= secs; i++) {
+		b = &mon->sec[(mon->cur + MON_SECONDS - i) % MON_SECONDS];
+		sum->bus_ns += b->bus_ns;
+		sum->frames += b->frames;
+		sum->err_frames += b->err_frames;
+		for (j = 0; j < MON_ERR_CLASSES; j++)
+			sum->err[j] += b->err[j];
+		if (b->worst > sum->worst)
+			sum->worst = b->worst;
+	}
+
+	return secs;
+}
+
+/*
+ * print_summary() - Prints the 1, 10 and 60 seconds windows
+ *
+ * @mon:	Monitor.
+ */
+static void print_summary(const struct can_monitor *mon)
+{
+	static const unsigned int windows[] = { 1, 10, MON_SECONDS };
+	struct mon_bucket sum;
+	unsigned int i, j, secs;
+
+	for (i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+		secs = window_sum(mon, windows[i], &sum);
+		if (!secs)
+			return;
+
+		printf("%2us: load %5.1f%%, %7.0f frames/s, %u error frames",
+		       windows[i], 100.0 * sum.bus_ns / (secs * NSEC_PER_SEC),
+		       (double)sum.frames / secs, sum.err_frames);
+		for (j = 0; j < MON_ERR_CLASSES; j++)
+			if (sum.err[j])
+				printf(" %s:%u", err_names[j], sum.err[j]);
+		printf(", worst state %s\n", state_name(sum.worst));
+	}
+
+	printf("State: %s", state_name(mon->state));
+	if (mon->tec >= 0)
+		printf(" (TEC %d, REC %d)", mon->tec, mon->rec);
+	printf("\n");
+}
+
+/*
+ * close_second() - Closes the bucket of the current second
+ *
+ * @mon:	Monitor.
+ * @cif:	CAN interface.
+ * @warn_load:	Bus load (%) that triggers a warning.
+ */
+static void close_second(struct can_monitor *mon, can_if_t *cif,
+			 unsigned int warn_load)
+{
+	struct mon_bucket *b;
+	enum can_state state;
+	double load;
+
+	/* Error frames may be disabled in the driver, ask the controller */
+	if (!ldx_can_get_state(cif, &state))
+		set_state(mon, state);
+
+	b = &mon->sec[mon->cur];
+	load = 100.0 * b->bus_ns / NSEC_PER_SEC;
+	if (load >= warn_load)
+		printf("WARNING: bus load %.1f%% in the last second\n", load);
+
+	mon->cur = (mon->cur + 1) % MON_SECONDS;
+	if (mon->elapsed < MON_SECONDS)
+		mon->elapsed++;
+
+	b = &mon->sec[mon->cur];
+	memset(b, 0, sizeof(*b));
+	b->worst = mon->state;
+}
+
+int can_monitor_run(can_if_t *cif, const can_if_cfg_t *ifcfg,
+		    unsigned int warn_load, volatile bool *running)
+{
+	static struct canfd_frame frames[MON_BATCH];
+	static struct iovec iovs[MON_BATCH];
+	static struct mmsghdr msgs[MON_BATCH];
+	static struct can_monitor mon;
+	can_err_mask_t err_mask = CAN_ERR_MASK;
+	bool fd_frames = ifcfg->canfd_enabled;
+	struct pollfd pfd;
+	uint64_t now, next_tick;
+	unsigned int ticks = 0;
+	int i, n, ret, sock;
+
+	sock = can_socket_open(cif->name, CAN_SOCK_NONBLOCK |
+			       (fd_frames ? CAN_SOCK_FD : 0));
+	if (sock < 0)
+		return sock;
+
+	if (setsockopt(sock, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &err_mask,
+		       sizeof(err_mask)) < 0) {
+		ret = -errno;
+		close(sock);
+		return ret;
+	}
+
+	for (i = 0; i < MON_BATCH; i++) {
+		iovs[i].iov_base = &frames[i];
+		iovs[i].iov_len = sizeof(frames[i]);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	memset(&mon, 0, sizeof(mon));
+	mon.tec = mon.rec = -1;
+	if (ldx_can_get_state(cif, &mon.state))
+		mon.state = CAN_STATE_ERROR_ACTIVE;
+	mon.sec[0].worst = mon.state;
+
+	pfd.fd = sock;
+	pfd.events = POLLIN;
+	next_tick = now_ns(CLOCK_MONOTONIC) + NSEC_PER_SEC;
+	ret = 0;
+
+	while (*running) {
+		now = now_ns(CLOCK_MONOTONIC);
+		if (now < next_tick) {
+			n = poll(&pfd, 1, (next_tick - now + 999999) / 1000000);
+			if (n < 0 && errno != EINTR) {
+				ret = -errno;
+				break;
+			}
+
+			/* Drain the socket in batches */
+			while (n > 0) {
+				n = recvmmsg(sock, msgs, MON_BATCH, MSG_DONTWAIT,
+					     NULL);
+				if (n < 0) {
+					if (errno != EAGAIN && errno != EINTR)
+						ret = -errno;
+					break;
+				}
+
+				for (i = 0; i < n; i++) {
+					struct mon_bucket *b = &mon.sec[mon.cur];
+
+					if (frames[i].can_id & CAN_ERR_FLAG) {
+						account_error(&mon, &frames[i]);
+						continue;
+					}
+					b->frames++;
+					b->bus_ns += can_frame_time_ns(&frames[i],
+						msgs[i].msg_len == CANFD_MTU,
+						ifcfg->bitrate, ifcfg->dbitrate);
+				}
+
+				if (n < MON_BATCH)
+					break;
+			}
+			if (ret)
+				break;
+		}
+
+		/* Close all the elapsed seconds, even if the loop was late */
+		now = now_ns(CLOCK_MONOTONIC);
+		while (now >= next_tick) {
+			close_second(&mon, cif, warn_load);
+			next_tick += NSEC_PER_SEC;
+			if (++ticks % MON_PRINT_SECS == 0)
+				print_summary(&mon);
+		}
+	}
+
+	close(sock);
+
+	return ret;
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CAN_MONITOR_H_
+#define CAN_MONITOR_H_
+
+#include <stdbool.h>
+
+#include <libdigiapix/can.h>
+
+#define CAN_MONITOR_DEF_WARN_LOAD	80	/* % */
+
+/*
+ * can_monitor_run() - Monitors the bus load, error frames and controller state
+ *
+ * Reads all the frames of the interface, including error frames, from its
+ * own socket in batches and keeps per-second buckets of the bus load, the
+ * error frames by class and the worst controller state. Every 5 seconds a
+ * summary of the 1, 10 and 60 seconds windows is printed. Controller state
+ * changes and seconds above 'warn_load' are reported as soon as they happen.
+ *
+ * The function sleeps in poll() between batches and wakes up once per second
+ * to close the current bucket, so the CPU usage is proportional to the bus
+ * traffic.
+ *
+ * @cif:	CAN interface, already initialized.
+ * @ifcfg:	Configuration of the interface, used for the bit times.
+ * @warn_load:	Bus load (%) that triggers a warning.
+ * @running:	Flag that stops the monitor when cleared.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int can_monitor_run(can_if_t *cif, const can_if_cfg_t *ifcfg,
+		    unsigned int warn_load, volatile bool *running);
+
+#endif /* CAN_MONITOR_H_ */
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "can-payload.h"
+
+/* Valid payload lengths, CAN FD uses all of them and CAN 2.0 up to 8 */
+static const uint8_t dlc_len[] = {
+	1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64
+};
+#define CAN_DLC_LENGTHS		8
+#define CANFD_DLC_LENGTHS	(sizeof(dlc_len) / sizeof(dlc_len[0]))
+
+/*
+ * prng_next() - xorshift64* pseudo-random number generator
+ *
+ * @state:	Generator state, must not be 0.
+ *
+ * Return: The next pseudo-random number.
+ */
+static inline uint64_t prng_next(uint64_t *state)
+{
+	uint64_t x = *state;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	*state = x;
+
+	return x * 0x2545f4914f6cdd1dULL;
+}
+
+uint8_t can_payload_valid_len(uint8_t len)
+{
+	unsigned int i;
+
+	if (len <= CAN_MAX_DLEN)
+		return len;
+
+	for (i = CAN_DLC_LENGTHS; i < CANFD_DLC_LENGTHS; i++)
+		if (dlc_len[i] >= len)
+			return dlc_len[i];
+
+	return CANFD_MAX_DLEN;
+}
+
+/*
+ * fill_counter() - Writes the counter to the payload and increments it
+ *
+ * @gen:	Generator.
+ * @frame:	Frame to fill.
+ */
+static void fill_counter(struct can_payload_gen *gen, struct canfd_frame *frame)
+{
+	unsigned int i;
+
+	/* Same incremental update the example always did on the payload */
+	for (i = 0; i < frame->len; i++) {
+		gen->counter[i]++;
+		if (gen->counter[i])
+			break;
+	}
+
+	memcpy(frame->data, gen->counter, frame->len);
+}
+
+/*
+ * fill_prng() - Fills the payload with pseudo-random bytes
+ *
+ * @gen:	Generator.
+ * @frame:	Frame to fill.
+ */
+static void fill_prng(struct can_payload_gen *gen, struct canfd_frame *frame)
+{
+	unsigned int i;
+	uint64_t r;
+
+	for (i = 0; i < frame->len; i += sizeof(r)) {
+		r = prng_next(&gen->prng);
+		memcpy(&frame->data[i], &r, sizeof(r));
+	}
+}
+
+/*
+ * fill_replay() - Fills the payload with the next bytes of the file
+ *
+ * @gen:	Generator.
+ * @frame:	Frame to fill.
+ */
+static void fill_replay(struct can_payload_gen *gen, struct canfd_frame *frame)
+{
+	size_t chunk;
+	unsigned int i = 0;
+
+	while (i < frame->len) {
+		chunk = gen->file_len - gen->file_off;
+		if (chunk > frame->len - i)
+			chunk = frame->len - i;
+
+		memcpy(&frame->data[i], gen->file_data + gen->file_off, chunk);
+		i += chunk;
+		gen->file_off += chunk;
+		if (gen->file_off == gen->file_len)
+			gen->file_off = 0;
+	}
+}
+
+void can_payload_refill(struct can_payload_gen *gen)
+{
+	const struct can_payload_cfg *cfg = &gen->cfg;
+	unsigned int nlens = cfg->fd ? CANFD_DLC_LENGTHS : CAN_DLC_LENGTHS;
+	struct canfd_frame *frame;
+	uint32_t id = cfg->id;
+	unsigned int i;
+
+	for (i = 0; i < gen->size; i++) {
+		frame = &gen->ring[i];
+
+		if (cfg->flags & RANDOM_ID_MASK)
+			id = prng_next(&gen->prng) % 2047 + 1;
+
+		if (cfg->flags & EXT_ID_MASK)
+			frame->can_id = (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+		else
+			frame->can_id = id & CAN_SFF_MASK;
+
+		if (cfg->flags & RTR_BIT_MASK)
+			frame->can_id |= CAN_RTR_FLAG;
+
+		if (cfg->flags & RANDOM_DLC_MASK)
+			frame->len = dlc_len[prng_next(&gen->prng) % nlens];
+		else
+			frame->len = cfg->len;
+
+		switch (cfg->mode) {
+		case CAN_PAYLOAD_PRNG:
+			fill_prng(gen, frame);
+			break;
+		case CAN_PAYLOAD_REPLAY:
+			fill_replay(gen, frame);
+			break;
+		case CAN_PAYLOAD_COUNTER:
+		default:
+			fill_counter(gen, frame);
+			break;
+		}
+	}
+
+	gen->pos = 0;
+}
+
+int can_payload_init(struct can_payload_gen *gen,
+		     const struct can_payload_cfg *cfg, unsigned int ring_size)
+{
+	struct stat st;
+	unsigned int i;
+	int fd, ret;
+
+	memset(gen, 0, sizeof(*gen));
+	gen->cfg = *cfg;
+	gen->prng = cfg->seed ? cfg->seed : CAN_PAYLOAD_DEF_SEED;
+
+	if (cfg->len > (cfg->fd ? CANFD_MAX_DLEN : CAN_MAX_DLEN))
+		return -EINVAL;
+	if (cfg->fd)
+		gen->cfg.len = can_payload_valid_len(cfg->len);
+
+	if (cfg->mode == CAN_PAYLOAD_REPLAY) {
+		fd = open(cfg->file, O_RDONLY);
+		if (fd < 0)
+			return -errno;
+
+		if (fstat(fd, &st) < 0) {
+			ret = -errno;
+			close(fd);
+			return ret;
+		}
+		if (!st.st_size) {
+			close(fd);
+			return -EINVAL;
+		}
+
+		gen->file_data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+				      fd, 0);
+		close(fd);
+		if (gen->file_data == MAP_FAILED) {
+			gen->file_data = NULL;
+			return -errno;
+		}
+		gen->file_len = st.st_size;
+	}
+
+	gen->ring = calloc(ring_size, sizeof(*gen->ring));
+	if (!gen->ring) {
+		can_payload_free(gen);
+		return -ENOMEM;
+	}
+	gen->size = ring_size;
+
+	/* Frame flags never change, set them once */
+	if (cfg->fd && cfg->brs)
+		for (i = 0; i < ring_size; i++)
+			gen->ring[i].flags = CANFD_BRS;
+
+	can_payload_refill(gen);
+
+	return 0;
+}
+
+void can_payload_free(struct can_payload_gen *gen)
+{
+	if (gen->file_data)
+		munmap((void *)gen->file_data, gen->file_len);
+
+	free(gen->ring);
+	memset(gen, 0, sizeof(*gen));
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CAN_PAYLOAD_H_
+#define CAN_PAYLOAD_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <linux/can.h>
+
+#define RANDOM_ID_BIT				0
+#define EXT_ID_BIT					1
+#define RTR_BIT						2
+#define RANDOM_DLC_BIT				3
+
+#define RANDOM_ID_MASK				0x01
+#define EXT_ID_MASK					0x02
+#define RTR_BIT_MASK				0x04
+#define RANDOM_DLC_MASK				0x08
+
+#define RANDOM_ID(random_id)	(random_id << RANDOM_ID_BIT)
+#define EXT_ID(extended_id)		(extended_id << EXT_ID_BIT)
+#define RTR(rtr)				(rtr << RTR_BIT)
+#define RANDOM_DLC(dlc)			(dlc << RANDOM_DLC_BIT)
+
+#define CAN_PAYLOAD_DEF_RING_SIZE	256
+#define CAN_PAYLOAD_DEF_SEED		0x2545f4914f6cdd1dULL
+
+enum can_payload_mode {
+	CAN_PAYLOAD_COUNTER,	/* Incremental counter, little endian */
+	CAN_PAYLOAD_PRNG,	/* xorshift64* pseudo-random bytes */
+	CAN_PAYLOAD_REPLAY,	/* Bytes of a file, in a loop */
+};
+
+struct can_payload_cfg {
+	enum can_payload_mode mode;
+	uint32_t id;		/* Message ID */
+	uint8_t len;		/* Payload length */
+	uint8_t flags;		/* *_MASK generation flags */
+	bool fd;		/* Generate CAN FD frames */
+	bool brs;		/* Set the bit rate switch flag (CAN FD) */
+	uint64_t seed;		/* PRNG seed, 0 for the default one */
+	const char *file;	/* Payload file for CAN_PAYLOAD_REPLAY */
+};
+
+/*
+ * Frames are generated in batches into a ring, so the transmission loop only
+ * needs to advance a pointer. The ring is regenerated in one pass when all
+ * its frames have been consumed.
+ */
+struct can_payload_gen {
+	struct can_payload_cfg cfg;
+	struct canfd_frame *ring;
+	unsigned int size;
+	unsigned int pos;
+	uint64_t prng;
+	uint8_t counter[CANFD_MAX_DLEN];
+	const uint8_t *file_data;
+	size_t file_len;
+	size_t file_off;
+};
+
+/*
+ * can_payload_init() - Initializes a payload generator and fills its ring
+ *
+ * @gen:	Generator to initialize.
+ * @cfg:	Generator configuration.
+ * @ring_size:	Number of frames of the ring.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int can_payload_init(struct can_payload_gen *gen,
+		     const struct can_payload_cfg *cfg, unsigned int ring_size);
+
+/*
+ * can_payload_refill() - Generates a new batch of frames in the ring
+ *
+ * @gen:	Generator.
+ */
+void can_payload_refill(struct can_payload_gen *gen);
+
+/*
+ * can_payload_free() - Frees the resources of a payload generator
+ *
+ * @gen:	Generator.
+ */
+void can_payload_free(struct can_payload_gen *gen);
+
+/*
+ * can_payload_valid_len() - Rounds a length up to a valid CAN FD length
+ *
+ * @len:	Payload length.
+ *
+ * Return: The smallest valid CAN FD length not lower than 'len'.
+ */
+uint8_t can_payload_valid_len(uint8_t len);
+
+/*
+ * can_payload_next() - Returns the next generated frame
+ *
+ * The frame is valid until the ring is regenerated, that is, until the
+ * generator is called 'ring_size' more times.
+ *
+ * @gen:	Generator.
+ *
+ * Return: The next frame.
+ */
+static inline struct canfd_frame *can_payload_next(struct can_payload_gen *gen)
+{
+	if (gen->pos == gen->size)
+		can_payload_refill(gen);
+
+	return &gen->ring[gen->pos++];
+}
+
+/*
+ * can_payload_batch() - Returns a contiguous array with the next frames
+ *
+ * @gen:	Generator.
+ * @n:		Number of frames, not greater than the ring size.
+ *
+ * Return: Pointer to the first of the 'n' frames.
+ */
+static inline struct canfd_frame *can_payload_batch(struct can_payload_gen *gen,
+						    unsigned int n)
+{
+	struct canfd_frame *frames;
+
+	if (gen->size - gen->pos < n)
+		can_payload_refill(gen);
+
+	frames = &gen->ring[gen->pos];
+	gen->pos += n;
+
+	return frames;
+}
+
+#endif /* CAN_PAYLOAD_H_ */
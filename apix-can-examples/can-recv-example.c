@@ -1,5 +1,5 @@
 /*
- * Copyright 2018-2024, Digi International Inc.
+ * Copyright 2018-2026, Digi International Inc.
  *
  * Permission to use, copy, modify, and/or distribute this software for any
  * purpose with or without fee is hereby granted, provided that the above
@@ -17,22 +17,52 @@
 #include <errno.h>
 #include <libgen.h>
 #include <limits.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/socket.h>
 
 #include <libdigiapix/can.h>
 
+#include "can-capture.h"
+#include "can-evloop.h"
+#include "can-filter.h"
+#include "can-monitor.h"
+#include "can-stats.h"
+#include "can-utils.h"
+
 #define MAX_RECEPTION_BUFFER	512*1024
 
-static can_if_t *can_if;
+#ifndef CANFD_FDF
+#define CANFD_FDF		0x04
+#endif
+
+static can_if_t *can_ifs[CAN_EVLOOP_MAX_IFS];
+static char *ifaces[CAN_EVLOOP_MAX_IFS];
+static int nifaces;
 static struct can_filter *cfilter;
 static struct can_filter *canfilter;
 static bool running = true;
 static bool prn_msg_info = false;
 static bool prn_msg_count = false;
+static bool canfd_enabled = false;
+static can_capture_t *capture;
+static struct can_stats *id_stats;
+static struct can_filter_set filter_set;
+
+/* Reception with SO_TIMESTAMPING timestamps */
+static bool timestamping = false;
+static int ts_sock = -1;
+static pthread_t ts_thread;
+static bool ts_thread_running = false;
+static int64_t lat_min, lat_max, lat_sum;
+static uint64_t lat_count;
+
+/* Multi-interface reception from a single event loop */
+static struct can_evloop evloop = { .epfd = -1 };
 
 /*
  * usage_and_exit() - Show usage information and exit with 'exitval' return
@@ -47,11 +77,15 @@ static void usage_and_exit(char *name, int exitval)
 		"Example application using libdigiapix CAN support\n"
 		"\n"
 		"Usage: %s -i <can-iface> -b <bitrate> [options]\n\n"
-		"-i <can-iface>      Name of the CAN interface\n"
+		"-i <can-iface>      Name of the CAN interface, or comma-separated list\n"
+		"                    of interfaces serviced from a single event loop\n"
 		"-b <bitrate>        Bitrate to use (Hz)\n"
 		"-s <sample-point>   Bitrate Sample Point\n"
 		"-f <filters>        Comma-separated filter list in the format\n"
 		"                    id:mask (id and mask values in hex)\n"
+		"-F <max-filters>    Maximum number of kernel filters, above it the\n"
+		"                    filters are checked with a lookup table\n"
+		"                    (default %d)\n"
 		"-o                  Enable CAN FD support\n"
 		"--- CAN FD options ---\n"
 		"  -d <dbitrate>      Maximum data bitrate for CAN FD (Hz)\n"
@@ -59,13 +93,28 @@ static void usage_and_exit(char *name, int exitval)
 		"---\n"
 		"-p                  Print message info\n"
 		"-c                  Print message counter\n"
+		"-w <file>           Capture the received frames to a binary file\n"
+		"                    (frames are not printed)\n"
+		"-l                  Write the capture in candump log format\n"
+		"-S                  Print per-ID statistics every 5 seconds\n"
+		"                    (frames are not printed)\n"
+		"-T                  Use nanosecond SO_TIMESTAMPING timestamps and\n"
+		"                    print the dispatch latency of the frames\n"
+		"-M                  Monitor the bus load, error frames and controller\n"
+		"                    state (frames are not printed, filters ignored)\n"
+		"-W <load>           Bus load (%%) that triggers a warning in monitor\n"
+		"                    mode (default %d)\n"
 		"-h                  Help\n"
 		"\n"
 		"Examples:\n"
 		"%s -i can0 -b 500000 -f 023:fff,006:00f\n"
 		"%s -i can1 -b 100000\n"
 		"%s -i can1 -b 100000 -d 100000 -o -p\n"
-		"\n", name, name, name, name);
+		"%s -i can1 -b 1000000 -d 5000000 -o -w capture.bin\n"
+		"%s -i can0 -b 500000 -M -W 70\n"
+		"%s -i can0,can1,can2,can3 -b 500000 -S\n"
+		"\n", name, CAN_FILTER_DEF_KERNEL_MAX, CAN_MONITOR_DEF_WARN_LOAD,
+		name, name, name, name, name, name);
 
 	exit(exitval);
 }
@@ -75,12 +124,42 @@ static void usage_and_exit(char *name, int exitval)
  */
 static void cleanup(void)
 {
+	int i;
+
 	if (canfilter)
 		free(canfilter);
 
-	if (can_if) {
-		ldx_can_free(can_if);
+	for (i = 0; i < nifaces; i++) {
+		if (can_ifs[i]) {
+			ldx_can_free(can_ifs[i]);
+			can_ifs[i] = NULL;
+			running = false;
+		}
+	}
+
+	can_evloop_close(&evloop);
+
+	if (ts_thread_running) {
 		running = false;
+		pthread_cancel(ts_thread);
+		pthread_join(ts_thread, NULL);
+		ts_thread_running = false;
+	}
+
+	if (ts_sock >= 0) {
+		close(ts_sock);
+		ts_sock = -1;
+	}
+
+	/* The reception thread is stopped, write the remaining frames */
+	if (capture) {
+		can_capture_close(capture);
+		capture = NULL;
+	}
+
+	if (id_stats) {
+		can_stats_free(id_stats);
+		id_stats = NULL;
 	}
 }
 
@@ -111,11 +190,50 @@ static void register_signals(void)
 	sigaction(SIGTERM, &action, NULL);
 }
 
-static void can_rx_callback(struct canfd_frame *frame, struct timeval *tv)
+/*
+ * is_canfd_frame() - Checks if a received frame is a CAN FD frame
+ *
+ * @frame:	Received frame.
+ *
+ * Return: true if the frame is a CAN FD frame, false otherwise.
+ */
+static bool is_canfd_frame(struct canfd_frame *frame)
+{
+	return canfd_enabled && (frame->len > CAN_MAX_DLEN ||
+		frame->flags & (CANFD_BRS | CANFD_ESI | CANFD_FDF));
+}
+
+/*
+ * process_frame() - Processes a received frame
+ *
+ * @iface:	Name of the interface that received the frame.
+ * @frame:	Received frame.
+ * @ts:		Reception timestamp.
+ * @fd:		Whether the frame is a CAN FD frame.
+ * @latency_ns:	Time from the reception timestamp to the frame dispatch in
+ *		ns, negative if not measured.
+ */
+static void process_frame(const char *iface, struct canfd_frame *frame,
+			  const struct timespec *ts, bool fd, int64_t latency_ns)
 {
 	static uint32_t nframe = 1;
 	int i;
 
+	if (!can_filter_match(&filter_set, frame->can_id))
+		return;
+
+	if (id_stats)
+		can_stats_update(id_stats, frame, timespec_to_ns(ts));
+
+	if (capture) {
+		/* Never print nor block on I/O while capturing */
+		can_capture_push(capture, frame, ts, fd);
+		return;
+	}
+
+	if (id_stats)
+		return;
+
 	if (prn_msg_count) {
 		printf("CAN frame       %u\n", nframe);
 	} else {
@@ -123,13 +241,23 @@ static void can_rx_callback(struct canfd_frame *frame, struct timeval *tv)
 	}
 
 	if (prn_msg_info) {
+		if (nifaces > 1)
+			printf(" - Interface:   %s\n", iface);
+		if (latency_ns >= 0)
+			printf(" - Time:        %ld.%09ld\n"
+			       " - Latency:     %lld ns\n",
+			       (long)ts->tv_sec, ts->tv_nsec,
+			       (long long)latency_ns);
+		else
+			printf(" - Time:        %ld.%06ld\n",
+			       (long)ts->tv_sec, ts->tv_nsec / 1000);
+
 		printf(
-			" - Time:        %ld.%06ld\n"
 			" - Type:        %s\n"
 			" - ID:          %x\n"
 			" - Data length: %u\n"
 			" - Data:        "
-			,tv->tv_sec, tv->tv_usec, ldx_can_is_extid_frame(frame) ?
+			,ldx_can_is_extid_frame(frame) ?
 			"Extended ID" : "Standard ID", ldx_can_get_id(frame), frame->len);
 
 		for (i=0;i<frame->len;i++) {
@@ -143,74 +271,251 @@ static void can_rx_callback(struct canfd_frame *frame, struct timeval *tv)
 	nframe++;
 }
 
-static int strchartimes(const char *str, int c)
+static void can_rx_callback(struct canfd_frame *frame, struct timeval *tv)
+{
+	struct timespec ts = {
+		.tv_sec = tv->tv_sec,
+		.tv_nsec = tv->tv_usec * 1000,
+	};
+
+	process_frame(ifaces[0], frame, &ts, is_canfd_frame(frame), -1);
+}
+
+/*
+ * dispatch_latency() - Measures the time from the reception to the dispatch
+ *
+ * Only the reception thread or the event loop calls it, so the statistics are
+ * updated without locks.
+ *
+ * @rx_ts:	Timestamps of the frame. The software timestamp is set to the
+ *		current time if the kernel did not provide it.
+ *
+ * Return: The latency in ns, negative if the frame has no timestamp.
+ */
+static int64_t dispatch_latency(struct can_rx_ts *rx_ts)
+{
+	int64_t latency;
+
+	if (!rx_ts->sw.tv_sec && !rx_ts->sw.tv_nsec) {
+		clock_gettime(CLOCK_REALTIME, &rx_ts->sw);
+		return -1;
+	}
+
+	latency = now_ns(CLOCK_REALTIME) - timespec_to_ns(&rx_ts->sw);
+	if (!lat_count || latency < lat_min)
+		lat_min = latency;
+	if (latency > lat_max)
+		lat_max = latency;
+	lat_sum += latency;
+	lat_count++;
+
+	return latency;
+}
+
+/*
+ * ts_rx_thread() - Reception thread for the timestamping mode
+ *
+ * Reads the frames with their SO_TIMESTAMPING timestamps and measures the
+ * time from the kernel reception timestamp to the frame dispatch.
+ *
+ * @arg:	Unused.
+ */
+static void *ts_rx_thread(void *arg)
+{
+	struct canfd_frame frame;
+	struct can_rx_ts rx_ts;
+	int64_t latency;
+	int ret;
+
+	while (running) {
+		ret = can_socket_recv(ts_sock, &frame, &rx_ts);
+		if (ret < 0) {
+			if (ret == -EINTR)
+				continue;
+			printf("Error reading CAN frame (%s)\n", strerror(-ret));
+			break;
+		}
+
+		latency = dispatch_latency(&rx_ts);
+		process_frame(ifaces[0], &frame,
+			      rx_ts.hw.tv_sec || rx_ts.hw.tv_nsec ?
+			      &rx_ts.hw : &rx_ts.sw,
+			      ret == CANFD_MTU, latency);
+	}
+
+	return NULL;
+}
+
+/*
+ * open_rx_socket() - Opens a timestamping reception socket with the filters
+ *
+ * @iface:	Name of the CAN interface.
+ * @flags:	Additional CAN_SOCK_* flags.
+ * @filters:	Filters to apply.
+ * @nfilters:	Number of filters.
+ *
+ * Return: The socket, -errno on error.
+ */
+static int open_rx_socket(const char *iface, int flags,
+			  struct can_filter *filters, int nfilters)
 {
-	int count = 0;
-	char *character;
-
-	for (character = (char *)str;
-		 character && *character != '\0';
-		 character++) {
-		if (*character == c)
-			count++;
+	int rcvbuf = MAX_RECEPTION_BUFFER;
+	int sock, ret;
+
+	sock = can_socket_open(iface, flags | CAN_SOCK_TIMESTAMP |
+			       (canfd_enabled ? CAN_SOCK_FD : 0));
+	if (sock < 0)
+		return sock;
+
+	setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+	if (setsockopt(sock, SOL_CAN_RAW, CAN_RAW_FILTER, filters,
+		       nfilters * sizeof(*filters)) < 0) {
+		ret = -errno;
+		close(sock);
+		return ret;
 	}
 
-	return count;
+	return sock;
 }
 
 /*
- * parse_filters() -
+ * start_ts_reception() - Starts the reception with SO_TIMESTAMPING timestamps
  *
- * @str:		String that contains all the filters
- * @cfilter:	Struct that contains the filters
- * @nfilters:	Number of valid filters found on str.
+ * @iface:	Name of the CAN interface.
+ * @filters:	Filters to apply.
+ * @nfilters:	Number of filters.
  *
- * Return: 0 on success, error code otherwise.
+ * Return: 0 on success, -errno otherwise.
  */
-static int parse_filters(char *str, struct can_filter **cfilter, int *nfilters)
+static int start_ts_reception(const char *iface, struct can_filter *filters,
+			      int nfilters)
 {
 	int ret;
-	int posible_filters;
-	int good_filters = 0;
-	char *p = str;
-
-	/* First compute the number of filters */
-	posible_filters = strchartimes(str, ',');
-	posible_filters++;
-
-	/* Allocate the memory for all the possible filters */
-	canfilter = malloc(sizeof(struct can_filter) * posible_filters);
-	if (!canfilter) {
-		printf("Unable to allocate memory for filters\n");
-		return -ENOMEM;
+
+	ts_sock = open_rx_socket(iface, 0, filters, nfilters);
+	if (ts_sock < 0)
+		return ts_sock;
+
+	ret = pthread_create(&ts_thread, NULL, ts_rx_thread, NULL);
+	if (ret)
+		return -ret;
+	ts_thread_running = true;
+
+	return 0;
+}
+
+/*
+ * evloop_rx_handler() - Frame handler of the event loop interfaces
+ *
+ * @frame:	Received frame.
+ * @rx_ts:	Reception timestamps.
+ * @fd:		Whether the frame is a CAN FD frame.
+ * @arg:	Name of the interface.
+ */
+static void evloop_rx_handler(struct canfd_frame *frame,
+			      const struct can_rx_ts *rx_ts, bool fd, void *arg)
+{
+	struct can_rx_ts ts = *rx_ts;
+	int64_t latency = -1;
+
+	if (timestamping)
+		latency = dispatch_latency(&ts);
+	else if (!ts.sw.tv_sec && !ts.sw.tv_nsec)
+		clock_gettime(CLOCK_REALTIME, &ts.sw);
+
+	process_frame(arg, frame, ts.hw.tv_sec || ts.hw.tv_nsec ?
+		      &ts.hw : &ts.sw, fd, latency);
+}
+
+/*
+ * start_evloop_reception() - Starts the reception of all the interfaces from
+ *			      a single event loop
+ *
+ * The library starts a reception thread per registered handler. With several
+ * interfaces the frames are read instead from one non-blocking socket per
+ * interface, all of them serviced by the calling thread.
+ *
+ * @filters:	Filters to apply.
+ * @nfilters:	Number of filters.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int start_evloop_reception(struct can_filter *filters, int nfilters)
+{
+	int i, sock, ret;
+
+	ret = can_evloop_init(&evloop);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < nifaces; i++) {
+		sock = open_rx_socket(ifaces[i], CAN_SOCK_NONBLOCK, filters,
+				      nfilters);
+		if (sock < 0)
+			return sock;
+
+		ret = can_evloop_add(&evloop, ifaces[i], sock,
+				     evloop_rx_handler, ifaces[i]);
+		if (ret) {
+			close(sock);
+			return ret;
+		}
 	}
 
-	/* Parse the information for each filter */
-	while (posible_filters-- && p) {
-		ret = sscanf(p, "%x:%x",
-					 &canfilter[good_filters].can_id,
-					 &canfilter[good_filters].can_mask);
-		if (ret == 2)
-			good_filters++;
-
-		p = strchr(p, ',');
-		if (p)
-			p++;
+	return 0;
+}
+
+/*
+ * parse_ifaces() - Splits a comma-separated list of interfaces
+ *
+ * @list:	List of interfaces, modified.
+ *
+ * Return: The number of interfaces, -1 on error.
+ */
+static int parse_ifaces(char *list)
+{
+	char *saveptr = NULL, *tok;
+	int n = 0;
+
+	for (tok = strtok_r(list, ",", &saveptr); tok;
+	     tok = strtok_r(NULL, ",", &saveptr)) {
+		if (n == CAN_EVLOOP_MAX_IFS)
+			return -1;
+		ifaces[n++] = tok;
 	}
 
-	*nfilters = good_filters;
-	*cfilter = canfilter;
+	return n ? n : -1;
+}
+
+/*
+ * print_latency() - Prints the dispatch latency statistics
+ */
+static void print_latency(void)
+{
+	uint64_t count = lat_count;
 
-	return EXIT_SUCCESS;
+	if (!count) {
+		printf("Waiting for CAN frames...\n");
+		return;
+	}
+
+	printf("Dispatch latency (%llu frames): min %.1f us, avg %.1f us, max %.1f us\n",
+	       (unsigned long long)count, lat_min / 1e3,
+	       (double)lat_sum / count / 1e3, lat_max / 1e3);
 }
 
 int main(int argc, char **argv)
 {
 	char *name = basename(argv[0]);
-	char *iface;
+	char *capture_file = NULL;
+	enum can_capture_format capture_fmt = CAN_CAPTURE_FMT_BIN;
 	can_if_cfg_t ifcfg;
 	int nfilters = 0;
-	int opt;
+	int max_kernel_filters = CAN_FILTER_DEF_KERNEL_MAX;
+	unsigned int warn_load = CAN_MONITOR_DEF_WARN_LOAD;
+	bool monitor = false;
+	int i, opt;
 	int ret;
 	float sp = 0.0;
 	struct can_filter deffilter;
@@ -224,10 +529,15 @@ int main(int argc, char **argv)
 
 	ldx_can_set_defconfig(&ifcfg);
 
-	while ((opt = getopt(argc, argv, "i:b:f:d:s:a:opc")) > 0) {
+	while ((opt = getopt(argc, argv, "i:b:f:F:d:s:a:opcw:lSTMW:h")) > 0) {
 		switch (opt) {
 		case 'i':
-			iface = optarg;
+			nifaces = parse_ifaces(optarg);
+			if (nifaces < 0) {
+				printf("Invalid interface list (up to %d interfaces)\n\n",
+				       CAN_EVLOOP_MAX_IFS);
+				usage_and_exit(name, EXIT_FAILURE);
+			}
 			break;
 
 		case 'b':
@@ -249,11 +559,17 @@ int main(int argc, char **argv)
 			break;
 
 		case 'f':
-			ret = parse_filters(optarg, &cfilter, &nfilters);
-			if (ret) {
+			free(canfilter);
+			nfilters = can_filter_parse(optarg, &canfilter);
+			if (nfilters < 0) {
 				printf("Unable to parse filter information\n\n");
 				usage_and_exit(name, EXIT_FAILURE);
 			}
+			cfilter = canfilter;
+			break;
+
+		case 'F':
+			max_kernel_filters = atoi(optarg);
 			break;
 
 		case 'o':
@@ -268,6 +584,34 @@ int main(int argc, char **argv)
 			prn_msg_count = true;
 			break;
 
+		case 'w':
+			capture_file = optarg;
+			break;
+
+		case 'l':
+			capture_fmt = CAN_CAPTURE_FMT_LOG;
+			break;
+
+		case 'T':
+			timestamping = true;
+			break;
+
+		case 'M':
+			monitor = true;
+			break;
+
+		case 'W':
+			warn_load = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'S':
+			id_stats = can_stats_init();
+			if (!id_stats) {
+				printf("Unable to allocate memory for statistics\n");
+				return EXIT_FAILURE;
+			}
+			break;
+
 		case 'h':
 			usage_and_exit(name, EXIT_SUCCESS);
 			break;
@@ -277,14 +621,15 @@ int main(int argc, char **argv)
 		}
 	}
 
-	printf("Requesting CAN interface %s... ", iface);
+	if (nifaces <= 0) {
+		printf("No CAN interface specified\n\n");
+		usage_and_exit(name, EXIT_FAILURE);
+	}
 
-	can_if = ldx_can_request_by_name(iface);
-	if (!can_if) {
-		printf("ERROR\n");
+	if (nifaces > 1 && (capture_file || monitor)) {
+		printf("Capture and monitor modes only support one interface\n");
 		return EXIT_FAILURE;
 	}
-	printf("OK\n");
 
 	/* Register signals and exit cleanup function */
 	atexit(cleanup);
@@ -293,13 +638,45 @@ int main(int argc, char **argv)
 	/* Increase the buffer reception size */
 	ifcfg.rx_buf_len = MAX_RECEPTION_BUFFER;
 
-	printf("Initializing CAN interface... ");
-	ret = ldx_can_init(can_if, &ifcfg);
-	if (ret) {
-		printf("ERROR\n");
+	for (i = 0; i < nifaces; i++) {
+		printf("Requesting CAN interface %s... ", ifaces[i]);
+
+		can_ifs[i] = ldx_can_request_by_name(ifaces[i]);
+		if (!can_ifs[i]) {
+			printf("ERROR\n");
+			return EXIT_FAILURE;
+		}
+		printf("OK\n");
+
+		printf("Initializing CAN interface %s... ", ifaces[i]);
+		ret = ldx_can_init(can_ifs[i], &ifcfg);
+		if (ret) {
+			printf("ERROR\n");
+			goto error;
+		}
+		printf("OK\n");
+	}
+
+	canfd_enabled = ifcfg.canfd_enabled;
+
+	if (capture_file) {
+		printf("Capturing frames to %s... ", capture_file);
+		capture = can_capture_open(capture_file, ifaces[0], capture_fmt);
+		if (!capture) {
+			printf("ERROR\n");
+			ret = EXIT_FAILURE;
+			goto error;
+		}
+		printf("OK\n");
+	}
+
+	if (monitor) {
+		printf("Monitoring CAN interface %s...\n", ifaces[0]);
+		ret = can_monitor_run(can_ifs[0], &ifcfg, warn_load, &running);
+		if (ret)
+			printf("CAN monitor failed (%s)\n", strerror(-ret));
 		goto error;
 	}
-	printf("OK\n");
 
 	/*
 	 * Configure a callback to process the defined filters, otherwise,
@@ -308,18 +685,58 @@ int main(int argc, char **argv)
 	if (nfilters == 0) {
 		nfilters = 1;
 		cfilter = &deffilter;
+	} else {
+		can_filter_optimize(cfilter, nfilters, max_kernel_filters,
+				    &filter_set);
+		cfilter = can_filter_kernel_list(&filter_set, &nfilters);
+		printf("Filters: %d requested, %d after merging (%d saved)%s\n",
+		       filter_set.nrequested, filter_set.nfilters,
+		       filter_set.nrequested - filter_set.nfilters,
+		       filter_set.use_bitmap ?
+		       ", using a userspace lookup table" : "");
+	}
+	if (nifaces > 1) {
+		ret = start_evloop_reception(cfilter, nfilters);
+		if (ret < 0)
+			printf("Failed to start the event loop reception (%s)\n",
+			       strerror(-ret));
+	} else if (timestamping) {
+		/*
+		 * The library callback only provides a microseconds timeval,
+		 * read the frames from a socket with SO_TIMESTAMPING instead.
+		 */
+		ret = start_ts_reception(ifaces[0], cfilter, nfilters);
+		if (ret < 0)
+			printf("Failed to start timestamping reception (%s)\n",
+			       strerror(-ret));
+	} else {
+		ret = ldx_can_register_rx_handler(can_ifs[0], can_rx_callback,
+										  cfilter, nfilters);
+		if (ret < 0)
+			printf("Failed to register rx msg handler\n");
 	}
-	ret = ldx_can_register_rx_handler(can_if, can_rx_callback,
-									  cfilter, nfilters);
 
-	if (ret < 0) {
-		printf("Failed to register rx msg handler\n");
+	if (ret < 0)
 		goto error;
-	}
 
 	while (running) {
-		sleep(5);
-		printf("Waiting for CAN frames...\n");
+		if (nifaces > 1) {
+			ret = can_evloop_run(&evloop, 5000);
+			if (ret) {
+				printf("Event loop failed (%s)\n", strerror(-ret));
+				break;
+			}
+			can_evloop_report(&evloop, stdout);
+		} else {
+			sleep(5);
+		}
+
+		if (id_stats)
+			can_stats_dump(id_stats, stdout);
+		else if (timestamping)
+			print_latency();
+		else if (nifaces == 1)
+			printf("Waiting for CAN frames...\n");
 	}
 
 error:
@@ -0,0 +1,399 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "can-replay.h"
+
+#define NSEC_PER_SEC_L		1000000000UL
+
+/* Longest candump log line accepted, longer lines are skipped */
+#define REPLAY_MAX_LINE		256
+
+struct can_replay {
+	int fd;
+	enum can_capture_format format;
+	off_t size;
+	off_t off;		/* File offset of the next record */
+	uint8_t *map;		/* Currently mapped window */
+	off_t map_off;		/* File offset of the window */
+	size_t map_len;
+	long page_size;
+};
+
+/*
+ * map_window() - Maps the window of the file that starts at 'off'
+ *
+ * @rp:		Replay handle.
+ * @off:	File offset that must be part of the window.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int map_window(can_replay_t *rp, off_t off)
+{
+	off_t start = off & ~((off_t)rp->page_size - 1);
+	size_t len;
+
+	if (rp->map) {
+		munmap(rp->map, rp->map_len);
+		rp->map = NULL;
+		rp->map_len = 0;
+	}
+
+	len = rp->size - start;
+	if (len > CAN_REPLAY_WINDOW_SIZE)
+		len = CAN_REPLAY_WINDOW_SIZE;
+
+	rp->map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, rp->fd, start);
+	if (rp->map == MAP_FAILED) {
+		rp->map = NULL;
+		return -errno;
+	}
+	/* The file is read once from start to end */
+	madvise(rp->map, len, MADV_SEQUENTIAL);
+
+	rp->map_off = start;
+	rp->map_len = len;
+
+	return 0;
+}
+
+/*
+ * window_ptr() - Returns a pointer to the bytes at the current file offset
+ *
+ * @rp:		Replay handle.
+ * @need:	Number of contiguous bytes required.
+ * @err:	Variable to store the error, 0 at the end of the file.
+ *
+ * Return: Pointer to the data, NULL if there are not enough bytes left in the
+ *	   file or the window cannot be mapped.
+ */
+static const uint8_t *window_ptr(can_replay_t *rp, size_t need, int *err)
+{
+	*err = 0;
+
+	if (rp->off + (off_t)need > rp->size)
+		return NULL;
+
+	if (!rp->map || rp->off < rp->map_off ||
+	    rp->off + need > rp->map_off + rp->map_len) {
+		*err = map_window(rp, rp->off);
+		if (*err)
+			return NULL;
+	}
+
+	return rp->map + (rp->off - rp->map_off);
+}
+
+/*
+ * next_bin() - Reads the next frame of a binary capture file
+ *
+ * @rp:		Replay handle.
+ * @frame:	Frame to fill.
+ * @ts:		Capture timestamp of the frame.
+ * @fd:		Whether the frame is a CAN FD frame.
+ *
+ * Return: 1 if a frame was read, 0 at the end of the file, -errno on error.
+ */
+static int next_bin(can_replay_t *rp, struct canfd_frame *frame,
+		    struct timespec *ts, bool *fd)
+{
+	const struct can_capture_rec *rec;
+	const uint8_t *p;
+	size_t size;
+	int err;
+
+	for (;;) {
+		p = window_ptr(rp, sizeof(*rec), &err);
+		if (!p)
+			return err;
+
+		rec = (const struct can_capture_rec *)p;
+		if (rec->len > CANFD_MAX_DLEN)
+			return -EINVAL;
+
+		/* A truncated last record is handled as the end of the file */
+		size = CAN_CAPTURE_REC_SIZE(rec->len);
+		p = window_ptr(rp, size, &err);
+		if (!p)
+			return err;
+		rp->off += size;
+
+		rec = (const struct can_capture_rec *)p;
+		if (rec->can_id & CAN_ERR_FLAG)
+			continue;
+
+		memset(frame, 0, sizeof(*frame));
+		frame->can_id = rec->can_id;
+		frame->len = rec->len;
+		frame->flags = rec->flags;
+		memcpy(frame->data, p + sizeof(*rec), rec->len);
+		ts->tv_sec = rec->ts_sec;
+		ts->tv_nsec = rec->ts_nsec;
+		*fd = rec->type == CAN_CAPTURE_TYPE_CANFD;
+
+		return 1;
+	}
+}
+
+static int hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+
+	return -1;
+}
+
+/*
+ * parse_log_line() - Parses a candump log line
+ *
+ * Accepts '(<sec>.<usec>) <iface> <id>#<data>', '<id>#R[<len>]' remote
+ * frames and '<id>##<flags><data>' CAN FD frames. Data bytes may be
+ * separated by dots.
+ *
+ * @line:	Line to parse, NULL terminated.
+ * @frame:	Frame to fill.
+ * @ts:		Capture timestamp of the frame.
+ * @fd:		Whether the frame is a CAN FD frame.
+ *
+ * Return: true if the line contains a frame that can be sent, false otherwise.
+ */
+static bool parse_log_line(const char *line, struct canfd_frame *frame,
+			   struct timespec *ts, bool *fd)
+{
+	unsigned long long sec;
+	unsigned long nsec = 0, scale = NSEC_PER_SEC_L;
+	const char *p;
+	char *end;
+	uint32_t id;
+	int pos = 0, hi, lo, max_len;
+
+	if (sscanf(line, " (%llu.%n", &sec, &pos) < 1 || !pos)
+		return false;
+
+	/* candump writes microseconds, but accept any number of digits */
+	for (p = line + pos; *p >= '0' && *p <= '9'; p++) {
+		if (scale > 1) {
+			scale /= 10;
+			nsec += (*p - '0') * scale;
+		}
+	}
+
+	pos = 0;
+	if (sscanf(p, ") %*s %n", &pos) < 0 || !pos)
+		return false;
+	p += pos;
+
+	id = strtoul(p, &end, 16);
+	if (*end != '#')
+		return false;
+
+	memset(frame, 0, sizeof(*frame));
+	switch (end - p) {
+	case 3:
+		frame->can_id = id & CAN_SFF_MASK;
+		break;
+	case 8:
+		/* Error frames cannot be sent */
+		if (id & CAN_ERR_FLAG)
+			return false;
+		frame->can_id = (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+		break;
+	default:
+		return false;
+	}
+	p = end + 1;
+
+	*fd = *p == '#';
+	if (*fd) {
+		hi = hex_value(p[1]);
+		if (hi < 0)
+			return false;
+		frame->flags = hi;
+		p += 2;
+		max_len = CANFD_MAX_DLEN;
+	} else if (*p == 'R') {
+		frame->can_id |= CAN_RTR_FLAG;
+		if (p[1] >= '0' && p[1] <= '8')
+			frame->len = p[1] - '0';
+		goto out;
+	} else {
+		max_len = CAN_MAX_DLEN;
+	}
+
+	while (*p && *p != '\n' && *p != '\r' && *p != ' ') {
+		if (*p == '.') {
+			p++;
+			continue;
+		}
+		hi = hex_value(p[0]);
+		lo = hex_value(p[1]);
+		if (hi < 0 || lo < 0 || frame->len == max_len)
+			return false;
+		frame->data[frame->len++] = (hi << 4) | lo;
+		p += 2;
+	}
+
+out:
+	ts->tv_sec = sec;
+	ts->tv_nsec = nsec;
+
+	return true;
+}
+
+/*
+ * next_log() - Reads the next frame of a candump log file
+ *
+ * @rp:		Replay handle.
+ * @frame:	Frame to fill.
+ * @ts:		Capture timestamp of the frame.
+ * @fd:		Whether the frame is a CAN FD frame.
+ *
+ * Return: 1 if a frame was read, 0 at the end of the file, -errno on error.
+ */
+static int next_log(can_replay_t *rp, struct canfd_frame *frame,
+		    struct timespec *ts, bool *fd)
+{
+	char line[REPLAY_MAX_LINE];
+	const uint8_t *p, *nl;
+	size_t avail, len;
+	int err;
+
+	for (;;) {
+		p = window_ptr(rp, 1, &err);
+		if (!p)
+			return err;
+
+		avail = rp->map_off + rp->map_len - rp->off;
+		nl = memchr(p, '\n', avail);
+		if (!nl && rp->map_off + (off_t)rp->map_len < rp->size) {
+			/* The line crosses the end of the window */
+			err = map_window(rp, rp->off);
+			if (err)
+				return err;
+			p = rp->map + (rp->off - rp->map_off);
+			avail = rp->map_off + rp->map_len - rp->off;
+			nl = memchr(p, '\n', avail);
+		}
+
+		len = nl ? (size_t)(nl - p) : avail;
+		rp->off += nl ? len + 1 : len;
+
+		if (len >= sizeof(line))
+			continue;
+
+		memcpy(line, p, len);
+		line[len] = '\0';
+		if (parse_log_line(line, frame, ts, fd))
+			return 1;
+	}
+}
+
+can_replay_t *can_replay_open(const char *path)
+{
+	const struct can_capture_hdr *hdr;
+	can_replay_t *rp;
+	struct stat st;
+	int err;
+
+	rp = calloc(1, sizeof(*rp));
+	if (!rp) {
+		printf("Unable to allocate memory for the replay\n");
+		return NULL;
+	}
+	rp->page_size = sysconf(_SC_PAGESIZE);
+
+	rp->fd = open(path, O_RDONLY);
+	if (rp->fd < 0) {
+		printf("Unable to open capture file '%s' (%s)\n", path,
+		       strerror(errno));
+		goto free_rp;
+	}
+
+	if (fstat(rp->fd, &st) < 0) {
+		printf("Unable to read capture file '%s' (%s)\n", path,
+		       strerror(errno));
+		goto close_fd;
+	}
+	rp->size = st.st_size;
+	rp->format = CAN_CAPTURE_FMT_LOG;
+
+	hdr = (const struct can_capture_hdr *)window_ptr(rp, sizeof(*hdr), &err);
+	if (!hdr && err) {
+		printf("Unable to map capture file '%s' (%s)\n", path,
+		       strerror(-err));
+		goto close_fd;
+	}
+
+	if (hdr && hdr->magic == CAN_CAPTURE_MAGIC) {
+		if (hdr->version != CAN_CAPTURE_VERSION ||
+		    hdr->hdr_size < sizeof(*hdr)) {
+			printf("Unsupported capture file version %u\n",
+			       hdr->version);
+			goto close_fd;
+		}
+		rp->format = CAN_CAPTURE_FMT_BIN;
+		rp->off = hdr->hdr_size;
+	}
+
+	return rp;
+
+close_fd:
+	if (rp->map)
+		munmap(rp->map, rp->map_len);
+	close(rp->fd);
+free_rp:
+	free(rp);
+
+	return NULL;
+}
+
+int can_replay_next(can_replay_t *rp, struct canfd_frame *frame,
+		    struct timespec *ts, bool *fd)
+{
+	if (rp->format == CAN_CAPTURE_FMT_BIN)
+		return next_bin(rp, frame, ts, fd);
+
+	return next_log(rp, frame, ts, fd);
+}
+
+enum can_capture_format can_replay_format(const can_replay_t *rp)
+{
+	return rp->format;
+}
+
+void can_replay_close(can_replay_t *rp)
+{
+	if (!rp)
+		return;
+
+	if (rp->map)
+		munmap(rp->map, rp->map_len);
+	close(rp->fd);
+	free(rp);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CAN_REPLAY_H_
+#define CAN_REPLAY_H_
+
+#include <stdbool.h>
+#include <time.h>
+
+#include <linux/can.h>
+
+#include "can-capture.h"
+
+/* Size of the file window mapped at a time */
+#define CAN_REPLAY_WINDOW_SIZE		(16 * 1024 * 1024)
+
+typedef struct can_replay can_replay_t;
+
+/*
+ * can_replay_open() - Opens a capture file to read its frames
+ *
+ * The format is detected from the file contents: binary captures written by
+ * can_capture_open() or candump log files. The file is mapped through a
+ * window that slides along it, so files of any size can be read.
+ *
+ * @path:	Path of the capture file.
+ *
+ * Return: The replay handle, NULL on error.
+ */
+can_replay_t *can_replay_open(const char *path);
+
+/*
+ * can_replay_next() - Reads the next frame of the capture file
+ *
+ * Lines of a log file that cannot be parsed and error frames are skipped.
+ *
+ * @rp:		Replay handle.
+ * @frame:	Frame to fill.
+ * @ts:		Capture timestamp of the frame.
+ * @fd:		Whether the frame is a CAN FD frame.
+ *
+ * Return: 1 if a frame was read, 0 at the end of the file, -errno on error.
+ */
+int can_replay_next(can_replay_t *rp, struct canfd_frame *frame,
+		    struct timespec *ts, bool *fd);
+
+/*
+ * can_replay_format() - Returns the format of the capture file
+ *
+ * @rp:		Replay handle.
+ *
+ * Return: The detected format.
+ */
+enum can_capture_format can_replay_format(const can_replay_t *rp);
+
+/*
+ * can_replay_close() - Unmaps and closes the capture file
+ *
+ * @rp:		Replay handle.
+ */
+void can_replay_close(can_replay_t *rp);
+
+#endif /* CAN_REPLAY_H_ */
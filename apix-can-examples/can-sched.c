@@ -0,0 +1,375 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+
+#include "can-sched.h"
+#include "can-utils.h"
+
+#define WHEEL_MASK		(CAN_SCHED_WHEEL_SLOTS - 1)
+
+/* Batch of frames sent in a wakeup */
+static struct can_sched_msg *batch[CAN_SCHED_MAX_BATCH];
+static struct iovec iovs[CAN_SCHED_MAX_BATCH];
+static struct mmsghdr mmsgs[CAN_SCHED_MAX_BATCH];
+
+int can_sched_init(struct can_sched *sched, const char *iface, bool fd_frames,
+		   uint64_t res_ns)
+{
+	int i, ret;
+
+	memset(sched, 0, sizeof(*sched));
+	sched->tfd = -1;
+	sched->fd_frames = fd_frames;
+	sched->res_ns = res_ns ? res_ns : CAN_SCHED_DEF_RES_US * 1000ULL;
+
+	sched->sock = can_socket_open(iface, CAN_SOCK_NONBLOCK |
+				      (fd_frames ? CAN_SOCK_FD : 0));
+	if (sched->sock < 0)
+		return sched->sock;
+
+	sched->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (sched->tfd < 0) {
+		ret = -errno;
+		close(sched->sock);
+		sched->sock = -1;
+		return ret;
+	}
+
+	for (i = 0; i < CAN_SCHED_MAX_BATCH; i++) {
+		mmsgs[i].msg_hdr.msg_iov = &iovs[i];
+		mmsgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	return 0;
+}
+
+int can_sched_add(struct can_sched *sched, const struct can_payload_cfg *cfg,
+		  uint64_t period_ns, uint64_t offset_ns)
+{
+	struct can_sched_msg *msgs, *msg;
+	int ret;
+
+	if (!period_ns || (cfg->fd && !sched->fd_frames))
+		return -EINVAL;
+
+	msgs = realloc(sched->msgs, (sched->nmsgs + 1) * sizeof(*msgs));
+	if (!msgs)
+		return -ENOMEM;
+	sched->msgs = msgs;
+
+	msg = &msgs[sched->nmsgs];
+	memset(msg, 0, sizeof(*msg));
+	ret = can_payload_init(&msg->gen, cfg, CAN_SCHED_RING_SIZE);
+	if (ret)
+		return ret;
+
+	msg->period_ns = period_ns;
+	msg->offset_ns = offset_ns;
+	sched->nmsgs++;
+
+	return 0;
+}
+
+/*
+ * wheel_insert() - Adds a message to the slot of its deadline
+ *
+ * @sched:	Scheduler.
+ * @msg:	Message, with its deadline already updated.
+ */
+static void wheel_insert(struct can_sched *sched, struct can_sched_msg *msg)
+{
+	unsigned int slot;
+
+	msg->tick = (msg->deadline - sched->start) / sched->res_ns;
+	slot = msg->tick & WHEEL_MASK;
+
+	msg->next = sched->slots[slot];
+	sched->slots[slot] = msg;
+	sched->used[slot / 64] |= 1ULL << (slot % 64);
+}
+
+void can_sched_start(struct can_sched *sched)
+{
+	unsigned int i;
+
+	memset(sched->slots, 0, sizeof(sched->slots));
+	memset(sched->used, 0, sizeof(sched->used));
+
+	/* Leave one tick to arm the timer before the first deadlines */
+	sched->start = now_ns(CLOCK_MONOTONIC) + sched->res_ns;
+	sched->cur = 0;
+
+	for (i = 0; i < sched->nmsgs; i++) {
+		struct can_sched_msg *msg = &sched->msgs[i];
+
+		msg->deadline = sched->start + msg->offset_ns;
+		wheel_insert(sched, msg);
+	}
+}
+
+/*
+ * next_deadline() - Finds the earliest deadline of the wheel
+ *
+ * @sched:	Scheduler.
+ *
+ * Return: The earliest deadline, UINT64_MAX if there are no messages.
+ */
+static uint64_t next_deadline(const struct can_sched *sched)
+{
+	const struct can_sched_msg *msg;
+	uint64_t best = UINT64_MAX, bits, tick;
+	unsigned int s, slot, i;
+
+	for (s = 0; s < CAN_SCHED_WHEEL_SLOTS; s++) {
+		slot = (sched->cur + s) & WHEEL_MASK;
+
+		/* Skip the empty slots a word at a time */
+		bits = sched->used[slot / 64] >> (slot % 64);
+		if (!bits) {
+			s += 63 - slot % 64;
+			continue;
+		}
+		s += __builtin_ctzll(bits);
+		if (s >= CAN_SCHED_WHEEL_SLOTS)
+			break;
+
+		/* Messages of later wheel rotations share the slot */
+		tick = sched->cur + s;
+		for (msg = sched->slots[tick & WHEEL_MASK]; msg; msg = msg->next)
+			if (msg->tick == tick && msg->deadline < best)
+				best = msg->deadline;
+		if (best != UINT64_MAX)
+			return best;
+	}
+
+	/* All the deadlines are more than one rotation away */
+	for (i = 0; i < sched->nmsgs; i++)
+		if (sched->msgs[i].deadline < best)
+			best = sched->msgs[i].deadline;
+
+	return best;
+}
+
+/*
+ * send_batch() - Sends the frames of the due messages and reschedules them
+ *
+ * @sched:	Scheduler.
+ * @n:		Number of messages in the batch.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int send_batch(struct can_sched *sched, unsigned int n)
+{
+	struct can_sched_msg *msg;
+	uint64_t now, skip;
+	unsigned int i;
+	int64_t late;
+	int sent;
+
+	for (i = 0; i < n; i++) {
+		iovs[i].iov_base = can_payload_next(&batch[i]->gen);
+		iovs[i].iov_len = batch[i]->gen.cfg.fd ? CANFD_MTU : CAN_MTU;
+	}
+
+	now = now_ns(CLOCK_MONOTONIC);
+	sent = sendmmsg(sched->sock, mmsgs, n, MSG_DONTWAIT);
+	if (sent < 0) {
+		/* A full queue means the bus cannot carry the table */
+		if (errno != EAGAIN && errno != ENOBUFS)
+			return -errno;
+		sent = 0;
+	}
+
+	for (i = 0; i < n; i++) {
+		msg = batch[i];
+
+		if (i < (unsigned int)sent) {
+			late = now - msg->deadline;
+			if (!msg->sent || late < msg->late_min)
+				msg->late_min = late;
+			if (late > msg->late_max)
+				msg->late_max = late;
+			msg->late_sum += late;
+			msg->sent++;
+		} else {
+			msg->dropped++;
+		}
+
+		/* Keep the phase, late transmissions are skipped, not queued */
+		msg->deadline += msg->period_ns;
+		if (msg->deadline <= now) {
+			skip = (now - msg->deadline) / msg->period_ns + 1;
+			msg->deadline += skip * msg->period_ns;
+			msg->missed += skip;
+		}
+		wheel_insert(sched, msg);
+	}
+
+	return 0;
+}
+
+/*
+ * expire() - Sends all the messages whose deadline has passed
+ *
+ * @sched:	Scheduler.
+ * @now:	Current time.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int expire(struct can_sched *sched, uint64_t now)
+{
+	struct can_sched_msg **pmsg, *msg;
+	uint64_t now_tick, nslots, s;
+	unsigned int slot, n = 0;
+	int ret;
+
+	now_tick = (now - sched->start) / sched->res_ns;
+	nslots = now_tick - sched->cur + 1;
+	if (nslots > CAN_SCHED_WHEEL_SLOTS)
+		nslots = CAN_SCHED_WHEEL_SLOTS;
+
+	for (s = 0; s < nslots; s++) {
+		slot = (sched->cur + s) & WHEEL_MASK;
+		pmsg = &sched->slots[slot];
+
+		while ((msg = *pmsg)) {
+			if (msg->deadline > now) {
+				pmsg = &msg->next;
+				continue;
+			}
+
+			*pmsg = msg->next;
+			batch[n++] = msg;
+			if (n == CAN_SCHED_MAX_BATCH) {
+				ret = send_batch(sched, n);
+				if (ret)
+					return ret;
+				n = 0;
+			}
+		}
+
+		if (!sched->slots[slot])
+			sched->used[slot / 64] &= ~(1ULL << (slot % 64));
+	}
+
+	/* Rescheduled deadlines are later than 'now', never before this tick */
+	sched->cur = now_tick;
+
+	return n ? send_batch(sched, n) : 0;
+}
+
+int can_sched_run(struct can_sched *sched, unsigned int timeout_ms)
+{
+	struct itimerspec its;
+	uint64_t end, next, wake, now, expirations;
+
+	end = now_ns(CLOCK_MONOTONIC) + timeout_ms * 1000000ULL;
+	memset(&its, 0, sizeof(its));
+
+	for (;;) {
+		next = next_deadline(sched);
+		wake = next < end ? next : end;
+		its.it_value.tv_sec = wake / NSEC_PER_SEC;
+		its.it_value.tv_nsec = wake % NSEC_PER_SEC;
+		if (timerfd_settime(sched->tfd, TFD_TIMER_ABSTIME, &its, NULL) < 0)
+			return -errno;
+
+		if (read(sched->tfd, &expirations, sizeof(expirations)) < 0)
+			return errno == EINTR ? 0 : -errno;
+
+		now = now_ns(CLOCK_MONOTONIC);
+		if (now >= next) {
+			int ret;
+
+			sched->wakeups++;
+			ret = expire(sched, now);
+			if (ret)
+				return ret;
+		}
+
+		if (now >= end)
+			return 0;
+	}
+}
+
+void can_sched_report(const struct can_sched *sched, FILE *f)
+{
+	uint64_t sent = 0, missed = 0, dropped = 0;
+	int64_t late_max = 0;
+	unsigned int i;
+
+	fprintf(f, "%-8s %10s %10s %8s %8s %28s\n", "ID", "period(ms)", "sent",
+		"missed", "dropped", "late min/avg/max (us)");
+
+	for (i = 0; i < sched->nmsgs; i++) {
+		const struct can_sched_msg *msg = &sched->msgs[i];
+		bool eff = msg->gen.cfg.flags & EXT_ID_MASK;
+
+		fprintf(f, eff ? "%08x" : "%-8.3x", msg->gen.cfg.id);
+		fprintf(f, " %10.3f %10llu %8llu %8llu",
+			(double)msg->period_ns / 1e6,
+			(unsigned long long)msg->sent,
+			(unsigned long long)msg->missed,
+			(unsigned long long)msg->dropped);
+		if (msg->sent)
+			fprintf(f, " %8.1f /%8.1f /%8.1f",
+				msg->late_min / 1e3,
+				(double)msg->late_sum / msg->sent / 1e3,
+				msg->late_max / 1e3);
+		fprintf(f, "\n");
+
+		sent += msg->sent;
+		missed += msg->missed;
+		dropped += msg->dropped;
+		if (msg->late_max > late_max)
+			late_max = msg->late_max;
+	}
+
+	fprintf(f, "Total: %llu frames sent, %llu missed, %llu dropped, "
+		"max lateness %.1f us, %llu wakeups\n",
+		(unsigned long long)sent, (unsigned long long)missed,
+		(unsigned long long)dropped, late_max / 1e3,
+		(unsigned long long)sched->wakeups);
+}
+
+void can_sched_free(struct can_sched *sched)
+{
+	unsigned int i;
+
+	for (i = 0; i < sched->nmsgs; i++)
+		can_payload_free(&sched->msgs[i].gen);
+	free(sched->msgs);
+	sched->msgs = NULL;
+	sched->nmsgs = 0;
+
+	if (sched->tfd >= 0) {
+		close(sched->tfd);
+		sched->tfd = -1;
+	}
+
+	if (sched->sock >= 0) {
+		close(sched->sock);
+		sched->sock = -1;
+	}
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CAN_SCHED_H_
+#define CAN_SCHED_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "can-payload.h"
+
+/* Slots of the timer wheel, a power of two */
+#define CAN_SCHED_WHEEL_SLOTS	1024
+#define CAN_SCHED_DEF_RES_US	1000
+/* Frames generated in advance for every message */
+#define CAN_SCHED_RING_SIZE	16
+/* Maximum number of frames sent with a single system call */
+#define CAN_SCHED_MAX_BATCH	64
+
+/* A cyclic message of the table */
+struct can_sched_msg {
+	struct can_payload_gen gen;
+	uint64_t period_ns;
+	uint64_t offset_ns;
+
+	uint64_t deadline;		/* Next transmission, CLOCK_MONOTONIC */
+	uint64_t tick;			/* Wheel tick of the deadline */
+	struct can_sched_msg *next;	/* Next message of the wheel slot */
+
+	uint64_t sent;
+	uint64_t missed;		/* Deadlines skipped, the sender was late */
+	uint64_t dropped;		/* Frames rejected by the interface queue */
+	int64_t late_min, late_max, late_sum;
+};
+
+struct can_sched {
+	int sock;
+	int tfd;
+	bool fd_frames;
+
+	struct can_sched_msg *msgs;
+	unsigned int nmsgs;
+
+	/* Timer wheel, one list per slot and a bitmap of the non empty ones */
+	uint64_t res_ns;
+	uint64_t start;
+	uint64_t cur;
+	struct can_sched_msg *slots[CAN_SCHED_WHEEL_SLOTS];
+	uint64_t used[CAN_SCHED_WHEEL_SLOTS / 64];
+
+	uint64_t wakeups;
+};
+
+/*
+ * can_sched_init() - Initializes an empty scheduler
+ *
+ * @sched:	Scheduler.
+ * @iface:	Name of the CAN interface, already configured and up.
+ * @fd_frames:	Whether the interface accepts CAN FD frames.
+ * @res_ns:	Resolution of the timer wheel, in ns.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int can_sched_init(struct can_sched *sched, const char *iface, bool fd_frames,
+		   uint64_t res_ns);
+
+/*
+ * can_sched_add() - Adds a cyclic message to the scheduler
+ *
+ * Messages can only be added before can_sched_start().
+ *
+ * @sched:	Scheduler.
+ * @cfg:	Payload generator configuration of the message.
+ * @period_ns:	Transmission period, in ns.
+ * @offset_ns:	Offset of the first transmission from the start, in ns.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int can_sched_add(struct can_sched *sched, const struct can_payload_cfg *cfg,
+		  uint64_t period_ns, uint64_t offset_ns);
+
+/*
+ * can_sched_start() - Computes the first deadlines of all the messages
+ *
+ * @sched:	Scheduler.
+ */
+void can_sched_start(struct can_sched *sched);
+
+/*
+ * can_sched_run() - Sends the messages whose deadlines expire
+ *
+ * The thread sleeps on a single timerfd armed with the absolute time of the
+ * next deadline of the wheel. All the frames due in the same wakeup are sent
+ * with one sendmmsg() call.
+ *
+ * @sched:	Scheduler, already started.
+ * @timeout_ms:	Time to run before returning, in ms.
+ *
+ * Return: 0 when the time elapses or the wait is interrupted by a signal,
+ *	   -errno on error.
+ */
+int can_sched_run(struct can_sched *sched, unsigned int timeout_ms);
+
+/*
+ * can_sched_report() - Prints the lateness statistics of every message
+ *
+ * @sched:	Scheduler.
+ * @f:		Output stream.
+ */
+void can_sched_report(const struct can_sched *sched, FILE *f);
+
+/*
+ * can_sched_free() - Frees the resources of a scheduler
+ *
+ * @sched:	Scheduler.
+ */
+void can_sched_free(struct can_sched *sched);
+
+#endif /* CAN_SCHED_H_ */
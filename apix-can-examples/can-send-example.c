@@ -1,5 +1,5 @@
 /*
- * Copyright 2018, Digi International Inc.
+ * Copyright 2018-2026, Digi International Inc.
  *
  * Permission to use, copy, modify, and/or distribute this software for any
  * purpose with or without fee is hereby granted, provided that the above
@@ -14,36 +14,34 @@
  * PERFORMANCE OF THIS SOFTWARE.
  */
 
+#define _GNU_SOURCE
+
 #include <errno.h>
 #include <libgen.h>
 #include <limits.h>
+#include <poll.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <sys/socket.h>
 
 #include <libdigiapix/can.h>
 
-#define TX_RETRIES	10
-
-#define RANDOM_ID_BIT				0
-#define EXT_ID_BIT					1
-#define RTR_BIT						2
-#define RANDOM_DLC_BIT				3
+#include "can-payload.h"
+#include "can-replay.h"
+#include "can-utils.h"
 
-#define RANDOM_ID_MASK				0x01
-#define EXT_ID_MASK					0x02
-#define RTR_BIT_MASK				0x04
-#define RANDOM_DLC_MASK				0x08
+#define TX_RETRIES	10
 
-#define RANDOM_ID(random_id)	(random_id << RANDOM_ID_BIT)
-#define EXT_ID(extended_id)		(extended_id << EXT_ID_BIT)
-#define RTR(rtr)				(rtr << RTR_BIT)
-#define RANDOM_DLC(dlc)			(dlc << RANDOM_DLC_BIT)
+/* Socket send buffer in burst mode, small to get POLLOUT backpressure */
+#define BURST_SNDBUF_SIZE	(16 * 1024)
+#define BURST_POLL_TIMEOUT_MS	1000
 
 static can_if_t *can_if;
+static struct can_payload_gen payload_gen;
 static bool running = true;
 
 /*
@@ -68,19 +66,34 @@ static void usage_and_exit(char *name, int exitval)
 		"-l <data_length>    Payload length (default 8)\n"
 		"-o                  Enable CAN FD support\n"
 		"--- CAN FD options ---\n"
-		"  -d <dbitrate>      Maximum data bitrate for CAN FD (Hz)\n"
+		"  -d <dbitrate>      Maximum data bitrate for CAN FD (Hz), the\n"
+		"                     frames are sent with bit rate switch\n"
 		"  -p <dsample-point> CAN FD data bitate sample point\n"
 		"---\n"
 		"-r                  Generate a random ID (will ignore the -I parameter)\n"
-		"-c                  Generate a random payload (will ignore the -l parameter)\n"
+		"-c                  Generate a random payload length, including the\n"
+		"                    CAN FD ones with -o (will ignore the -l parameter)\n"
 		"-e                  Use extended id\n"
 		"-R                  Set RTR\n"
+		"-B <burst>          Send the frames in bursts of <burst> frames with\n"
+		"                    a single system call (-t is the delay between\n"
+		"                    bursts, default 0) and report the throughput\n"
+		"-m <mode>           Payload mode: counter (default) or random\n"
+		"-S <seed>           Seed of the random ID, length and payload\n"
+		"-P <file>           Use the bytes of <file> as payload, in a loop\n"
+		"-f <capture>        Replay a candump log or binary capture file\n"
+		"                    (will ignore the frame generation options)\n"
+		"-x <speed>          Replay speed factor, 0 to replay as fast as\n"
+		"                    possible (default 1)\n"
 		"\n"
 		"Examples:\n"
 		"%s -i can0 -b 500000 -n 100 -R\n"
 		"%s -i can1 -b 100000\n"
 		"%s -i can1 -b 100000 -d 100000 -n 10 -o\n"
-		"\n", name, name, name, name);
+		"%s -i can0 -b 1000000 -n 100000 -B 32\n"
+		"%s -i can0 -b 500000 -d 2000000 -o -c -m random -S 42 -n 1000\n"
+		"%s -i can0 -b 500000 -f field.log -x 2\n"
+		"\n", name, name, name, name, name, name, name);
 
 	exit(exitval);
 }
@@ -114,6 +127,8 @@ static void cleanup(void)
 		ldx_can_free(can_if);
 		running = false;
 	}
+
+	can_payload_free(&payload_gen);
 }
 
 /*
@@ -143,35 +158,266 @@ static void register_signals(void)
 	sigaction(SIGTERM, &action, NULL);
 }
 
-void update_msg(struct canfd_frame *frame, uint32_t id, uint8_t dlc, uint8_t flags)
+/*
+ * wait_tx_room() - Waits until the CAN socket can accept more frames
+ *
+ * @fd:		CAN socket.
+ * @err:	Error returned by the last send operation.
+ * @frame_ns:	Bus time of one frame, in ns.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int wait_tx_room(int fd, int err, uint64_t frame_ns)
 {
-	uint8_t index;
+	struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+	struct timespec ts;
+	int ret;
 
-	if (flags & RANDOM_ID_MASK)
-		id = rand() % 2047 + 1;
+	if (err == ENOBUFS) {
+		/*
+		 * The interface queue is full but the socket is writable, so
+		 * POLLOUT would return immediately. Give the controller the
+		 * time to send one frame.
+		 */
+		ts.tv_sec = frame_ns / NSEC_PER_SEC;
+		ts.tv_nsec = frame_ns % NSEC_PER_SEC;
+		nanosleep(&ts, NULL);
+		return 0;
+	}
 
-	if (flags & EXT_ID_MASK) {
-		frame->can_id = id & CAN_EFF_MASK;
-		frame->can_id |= CAN_EFF_FLAG;
-	} else {
-		frame->can_id = id & CAN_SFF_MASK;
+	do {
+		ret = poll(&pfd, 1, BURST_POLL_TIMEOUT_MS);
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret < 0)
+		return -errno;
+	if (!ret)
+		return -ETIMEDOUT;
+
+	return 0;
+}
+
+/*
+ * send_bursts() - Sends the frames in bursts using one system call per burst
+ *
+ * @iface:	Name of the CAN interface.
+ * @ifcfg:	CAN interface configuration.
+ * @num_msgs:	Number of messages to send, updated with the pending ones.
+ * @burst:	Number of frames per burst.
+ * @ms_delay:	Delay between bursts in ms.
+ * @gen:	Payload generator, with a ring of at least 'burst' frames.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int send_bursts(const char *iface, can_if_cfg_t *ifcfg,
+		       uint32_t *num_msgs, uint32_t burst, uint32_t ms_delay,
+		       struct can_payload_gen *gen)
+{
+	bool fd_frames = ifcfg->canfd_enabled;
+	size_t mtu = fd_frames ? CANFD_MTU : CAN_MTU;
+	struct canfd_frame *frames;
+	struct mmsghdr *msgs = NULL;
+	struct iovec *iovs = NULL;
+	uint64_t start, elapsed, bus_ns = 0, frame_ns;
+	uint32_t total = 0, n, sent, i;
+	int sndbuf = BURST_SNDBUF_SIZE;
+	int ret = EXIT_FAILURE;
+	int fd;
+
+	fd = can_socket_open(iface, CAN_SOCK_NONBLOCK |
+			     (fd_frames ? CAN_SOCK_FD : 0));
+	if (fd < 0) {
+		printf("Unable to open CAN socket (%s)\n", strerror(-fd));
+		return EXIT_FAILURE;
 	}
+	setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
 
-	if (flags & RTR_BIT_MASK)
-		frame->can_id |= CAN_RTR_FLAG;
+	msgs = calloc(burst, sizeof(*msgs));
+	iovs = calloc(burst, sizeof(*iovs));
+	if (!msgs || !iovs) {
+		printf("Unable to allocate memory for the bursts\n");
+		goto out;
+	}
 
-	if (flags & RANDOM_DLC_MASK)
-		dlc = rand() % 8 + 1;
+	for (i = 0; i < burst; i++) {
+		iovs[i].iov_len = mtu;
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
 
-	frame->len = dlc;
+	start = now_ns(CLOCK_MONOTONIC);
 
-	/* Currently we just do incremental updates on the payload */
-	for (index = 0; index < dlc; index++) {
-		frame->data[index] = frame->data[index] + 1;
-		if (frame->data[index])
-			break;
+	while (running && *num_msgs) {
+		n = *num_msgs < burst ? *num_msgs : burst;
+
+		/* Frames are already generated, send them from the ring */
+		frames = can_payload_batch(gen, n);
+		for (i = 0; i < n; i++) {
+			iovs[i].iov_base = &frames[i];
+			bus_ns += can_frame_time_ns(&frames[i], fd_frames,
+						    ifcfg->bitrate, ifcfg->dbitrate);
+		}
+		frame_ns = can_frame_time_ns(&frames[n - 1], fd_frames,
+					     ifcfg->bitrate, ifcfg->dbitrate);
+
+		sent = 0;
+		while (sent < n) {
+			int err;
+
+			ret = sendmmsg(fd, &msgs[sent], n - sent, 0);
+			if (ret > 0) {
+				sent += ret;
+				continue;
+			}
+
+			err = errno;
+			if (ret < 0 && (err == EAGAIN || err == ENOBUFS)) {
+				ret = wait_tx_room(fd, err, frame_ns);
+				if (!ret)
+					continue;
+				err = -ret;
+			}
+
+			printf("Failed to send CAN frames (%s)\n", strerror(err));
+			ret = EXIT_FAILURE;
+			goto report;
+		}
+
+		total += n;
+		*num_msgs -= n;
+
+		if (ms_delay)
+			ms_sleep(ms_delay);
+	}
+	ret = EXIT_SUCCESS;
+
+report:
+	elapsed = now_ns(CLOCK_MONOTONIC) - start;
+	if (elapsed) {
+		printf("Sent %u frames in %.3f s: %.0f frames/s",
+		       total, (double)elapsed / NSEC_PER_SEC,
+		       (double)total * NSEC_PER_SEC / elapsed);
+		if (ifcfg->bitrate)
+			printf(", bus load %.1f%%", 100.0 * bus_ns / elapsed);
+		printf("\n");
 	}
 
+out:
+	free(msgs);
+	free(iovs);
+	close(fd);
+
+	return ret;
+}
+
+/*
+ * replay_capture() - Retransmits the frames of a capture file
+ *
+ * The original gaps between frames are reproduced with absolute deadlines
+ * computed from the first frame, so the error of each wait does not
+ * accumulate along the replay.
+ *
+ * @iface:	Name of the CAN interface.
+ * @ifcfg:	CAN interface configuration.
+ * @path:	Path of the candump log or binary capture file.
+ * @speed:	Speed factor, 0 to send the frames as fast as possible.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int replay_capture(const char *iface, can_if_cfg_t *ifcfg,
+			  const char *path, double speed)
+{
+	bool fd_iface = ifcfg->canfd_enabled;
+	uint64_t first_ns = 0, start = 0, deadline_ns, late, max_late = 0;
+	uint64_t elapsed, sum_late = 0;
+	uint32_t sent = 0, skipped = 0;
+	struct canfd_frame frame;
+	struct timespec ts, deadline;
+	can_replay_t *rp;
+	bool fd;
+	int ret = 0, sock;
+
+	rp = can_replay_open(path);
+	if (!rp)
+		return EXIT_FAILURE;
+
+	/* Own socket, to keep the CAN 2.0 frames of a capture as they were */
+	sock = can_socket_open(iface, CAN_SOCK_NONBLOCK |
+			       (fd_iface ? CAN_SOCK_FD : 0));
+	if (sock < 0) {
+		printf("Unable to open CAN socket (%s)\n", strerror(-sock));
+		can_replay_close(rp);
+		return EXIT_FAILURE;
+	}
+
+	printf("Replaying %s capture '%s'...\n",
+	       can_replay_format(rp) == CAN_CAPTURE_FMT_BIN ? "binary" : "log",
+	       path);
+
+	while (running && (ret = can_replay_next(rp, &frame, &ts, &fd)) > 0) {
+		if (fd && !fd_iface) {
+			skipped++;
+			continue;
+		}
+
+		if (speed > 0) {
+			if (!sent) {
+				first_ns = timespec_to_ns(&ts);
+				start = now_ns(CLOCK_MONOTONIC);
+			}
+
+			deadline_ns = start;
+			if (timespec_to_ns(&ts) > first_ns)
+				deadline_ns += (timespec_to_ns(&ts) - first_ns) / speed;
+			deadline.tv_sec = deadline_ns / NSEC_PER_SEC;
+			deadline.tv_nsec = deadline_ns % NSEC_PER_SEC;
+
+			while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+					       &deadline, NULL) == EINTR)
+				;
+
+			late = now_ns(CLOCK_MONOTONIC) - deadline_ns;
+			sum_late += late;
+			if (late > max_late)
+				max_late = late;
+		} else if (!sent) {
+			start = now_ns(CLOCK_MONOTONIC);
+		}
+
+		while (write(sock, &frame, fd ? CANFD_MTU : CAN_MTU) < 0) {
+			ret = -errno;
+			if (ret == -EAGAIN || ret == -ENOBUFS)
+				ret = wait_tx_room(sock, -ret,
+						   can_frame_time_ns(&frame, fd,
+								     ifcfg->bitrate,
+								     ifcfg->dbitrate));
+			if (ret && ret != -EINTR) {
+				printf("Failed to send CAN frame (%s)\n",
+				       strerror(-ret));
+				goto out;
+			}
+		}
+		sent++;
+	}
+
+	if (ret < 0)
+		printf("Error reading capture file (%s)\n", strerror(-ret));
+
+out:
+	elapsed = sent ? now_ns(CLOCK_MONOTONIC) - start : 0;
+	printf("Replayed %u frames in %.3f s", sent,
+	       (double)elapsed / NSEC_PER_SEC);
+	if (skipped)
+		printf(" (%u CAN FD frames skipped)", skipped);
+	printf("\n");
+	if (speed > 0 && sent)
+		printf("Lateness: avg %.1f us, max %.1f us\n",
+		       (double)sum_late / sent / 1000, (double)max_late / 1000);
+
+	close(sock);
+	can_replay_close(rp);
+
+	return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
 int main(int argc, char **argv)
@@ -183,13 +429,17 @@ int main(int argc, char **argv)
 	int ret;
 	uint32_t ms_delay = 1;
 	uint32_t num_msgs = 1;
+	uint32_t burst_size = 0;
+	bool ms_delay_set = false;
 	uint32_t msg_id = 0x123;
 	uint8_t msg_len = 8;
 	uint8_t flags = 0;
 	float sp = 0.0;
-	struct canfd_frame frame;
-
-	srand (time(NULL));
+	struct can_payload_cfg payload_cfg = { .mode = CAN_PAYLOAD_COUNTER };
+	unsigned int ring_size;
+	struct canfd_frame *frame;
+	char *replay_file = NULL;
+	double speed = 1.0;
 
 	if (argc <= 3) {
 		usage_and_exit(name, EXIT_FAILURE);
@@ -197,7 +447,7 @@ int main(int argc, char **argv)
 
 	ldx_can_set_defconfig(&ifcfg);
 
-	while ((opt = getopt(argc, argv, "i:b:n:t:I:l:a:d:s:t:oerRc")) > 0) {
+	while ((opt = getopt(argc, argv, "i:b:n:t:I:l:a:d:s:t:oerRcB:m:S:P:f:x:")) > 0) {
 		switch (opt) {
 		case 'i':
 			iface = optarg;
@@ -209,6 +459,7 @@ int main(int argc, char **argv)
 
 		case 'd':
 			ifcfg.dbitrate = strtoul(optarg, NULL, 10);
+			payload_cfg.brs = true;
 			break;
 
 		case 'n':
@@ -217,6 +468,7 @@ int main(int argc, char **argv)
 
 		case 't':
 			ms_delay = strtoul(optarg, NULL, 10);
+			ms_delay_set = true;
 			break;
 
 		case 's':
@@ -257,6 +509,36 @@ int main(int argc, char **argv)
 			flags |= RANDOM_DLC_MASK;
 			break;
 
+		case 'B':
+			burst_size = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'm':
+			if (!strcmp(optarg, "counter"))
+				payload_cfg.mode = CAN_PAYLOAD_COUNTER;
+			else if (!strcmp(optarg, "random"))
+				payload_cfg.mode = CAN_PAYLOAD_PRNG;
+			else
+				usage_and_exit(name, EXIT_FAILURE);
+			break;
+
+		case 'S':
+			payload_cfg.seed = strtoull(optarg, NULL, 0);
+			break;
+
+		case 'P':
+			payload_cfg.mode = CAN_PAYLOAD_REPLAY;
+			payload_cfg.file = optarg;
+			break;
+
+		case 'f':
+			replay_file = optarg;
+			break;
+
+		case 'x':
+			speed = strtod(optarg, NULL);
+			break;
+
 		default:
 			usage_and_exit(name, EXIT_FAILURE);
 		}
@@ -284,15 +566,42 @@ int main(int argc, char **argv)
 	}
 	printf("OK\n");
 
-	memset(&frame, 0, sizeof(frame));
+	if (replay_file) {
+		ret = replay_capture(iface, &ifcfg, replay_file, speed);
+		goto error;
+	}
+
+	payload_cfg.id = msg_id;
+	payload_cfg.len = msg_len;
+	payload_cfg.flags = flags;
+	payload_cfg.fd = ifcfg.canfd_enabled;
+
+	ring_size = CAN_PAYLOAD_DEF_RING_SIZE;
+	if (burst_size > ring_size)
+		ring_size = burst_size;
+
+	ret = can_payload_init(&payload_gen, &payload_cfg, ring_size);
+	if (ret) {
+		printf("Unable to initialize the payload generator (%s)\n",
+		       strerror(-ret));
+		ret = EXIT_FAILURE;
+		goto error;
+	}
+
+	if (burst_size) {
+		ret = send_bursts(iface, &ifcfg, &num_msgs, burst_size,
+				  ms_delay_set ? ms_delay : 0, &payload_gen);
+		if (ret)
+			goto error;
+	}
 
 	while (running && num_msgs) {
 		int retries = TX_RETRIES;
-		/* If we need to create more configuration bits, we have this variable flags*/
-		update_msg(&frame, msg_id, msg_len, flags);
+
+		frame = can_payload_next(&payload_gen);
 
 		while (retries--) {
-			ret = ldx_can_tx_frame(can_if, &frame);
+			ret = ldx_can_tx_frame(can_if, frame);
 			if (!ret) {
 				break;
 			} else if (ret == -CAN_ERROR_TX_RETRY_LATER) {
@@ -0,0 +1,218 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <stdlib.h>
+
+#include "can-stats.h"
+
+#define EFF_SLOTS_MASK		(CAN_STATS_EFF_SLOTS - 1)
+/* Stop inserting new extended IDs above 75% of occupation */
+#define EFF_MAX_USED		(CAN_STATS_EFF_SLOTS / 4 * 3)
+
+/* Weight of the moving average of the period (1 / 2^N) */
+#define AVG_PERIOD_SHIFT	3
+
+struct can_stats *can_stats_init(void)
+{
+	struct can_stats *stats;
+
+	stats = calloc(1, sizeof(*stats));
+	if (!stats)
+		return NULL;
+
+	stats->eff = calloc(CAN_STATS_EFF_SLOTS, sizeof(*stats->eff));
+	if (!stats->eff) {
+		free(stats);
+		return NULL;
+	}
+
+	return stats;
+}
+
+void can_stats_free(struct can_stats *stats)
+{
+	if (!stats)
+		return;
+
+	free(stats->eff);
+	free(stats);
+}
+
+/*
+ * eff_lookup() - Finds (or inserts) an extended ID in the open addressing table
+ *
+ * @stats:	Statistics table.
+ * @id:		Extended CAN ID, including CAN_EFF_FLAG.
+ *
+ * Return: The entry of the ID, NULL if the table is full.
+ */
+static struct can_id_stats *eff_lookup(struct can_stats *stats, uint32_t id)
+{
+	/* Fibonacci hashing of the 29-bit ID */
+	uint32_t slot = (id * 2654435761U) >> (32 - __builtin_ctz(CAN_STATS_EFF_SLOTS));
+	struct can_id_stats *entry;
+
+	for (;;) {
+		entry = &stats->eff[slot];
+		if (entry->can_id == id)
+			return entry;
+		if (!entry->can_id)
+			break;
+		slot = (slot + 1) & EFF_SLOTS_MASK;
+	}
+
+	if (stats->eff_used >= EFF_MAX_USED)
+		return NULL;
+
+	stats->eff_used++;
+	entry->can_id = id;
+
+	return entry;
+}
+
+/*
+ * jitter_bucket() - Returns the histogram bucket of a period deviation
+ *
+ * @dev_ns:	Absolute deviation from the expected period in ns.
+ *
+ * Return: The histogram bucket index.
+ */
+static unsigned int jitter_bucket(uint64_t dev_ns)
+{
+	uint64_t dev_us = dev_ns / 1000;
+	unsigned int bucket;
+
+	if (!dev_us)
+		return 0;
+
+	bucket = 64 - __builtin_clzll(dev_us);
+
+	return bucket < CAN_STATS_HIST_BUCKETS ? bucket :
+						 CAN_STATS_HIST_BUCKETS - 1;
+}
+
+void can_stats_update(struct can_stats *stats, const struct canfd_frame *frame,
+		      uint64_t ts_ns)
+{
+	struct can_id_stats *entry;
+	uint64_t period, dev;
+
+	if (frame->can_id & CAN_EFF_FLAG) {
+		entry = eff_lookup(stats, frame->can_id &
+				   (CAN_EFF_MASK | CAN_EFF_FLAG));
+		if (!entry) {
+			stats->eff_overflow++;
+			return;
+		}
+	} else {
+		/* Standard IDs use a direct table indexed by the ID */
+		entry = &stats->sff[frame->can_id & CAN_SFF_MASK];
+	}
+
+	entry->count++;
+	entry->bytes += frame->len;
+
+	if (entry->count == 1) {
+		entry->last_ns = ts_ns;
+		return;
+	}
+
+	period = ts_ns > entry->last_ns ? ts_ns - entry->last_ns : 0;
+	entry->last_ns = ts_ns;
+	entry->sum_period_ns += period;
+
+	if (entry->count == 2) {
+		entry->min_period_ns = period;
+		entry->max_period_ns = period;
+		entry->avg_period_ns = period;
+	} else {
+		if (period < entry->min_period_ns)
+			entry->min_period_ns = period;
+		if (period > entry->max_period_ns)
+			entry->max_period_ns = period;
+	}
+
+	dev = period > entry->avg_period_ns ? period - entry->avg_period_ns :
+					      entry->avg_period_ns - period;
+	entry->hist[jitter_bucket(dev)]++;
+
+	/* Integer exponential moving average, no divisions */
+	entry->avg_period_ns += (period >> AVG_PERIOD_SHIFT) -
+				(entry->avg_period_ns >> AVG_PERIOD_SHIFT);
+}
+
+/*
+ * dump_entry() - Prints the statistics of one ID
+ *
+ * @entry:	ID statistics.
+ * @id:		CAN ID, including CAN_EFF_FLAG for extended IDs.
+ * @out:	Stream to print to.
+ */
+static void dump_entry(const struct can_id_stats *entry, uint32_t id, FILE *out)
+{
+	uint32_t count = entry->count;
+	unsigned int i, last = 0;
+
+	if (!count)
+		return;
+
+	if (id & CAN_EFF_FLAG)
+		fprintf(out, "%08x", id & CAN_EFF_MASK);
+	else
+		fprintf(out, "     %03x", id);
+
+	fprintf(out, " %10u %12llu", count, (unsigned long long)entry->bytes);
+	if (count > 1)
+		fprintf(out, " %10.3f %10.3f %10.3f",
+			entry->min_period_ns / 1e6,
+			entry->sum_period_ns / 1e6 / (count - 1),
+			entry->max_period_ns / 1e6);
+	fprintf(out, "\n");
+
+	if (count < 2)
+		return;
+
+	for (i = 0; i < CAN_STATS_HIST_BUCKETS; i++)
+		if (entry->hist[i])
+			last = i;
+
+	fprintf(out, "         jitter (us):");
+	for (i = 0; i <= last; i++) {
+		if (i == CAN_STATS_HIST_BUCKETS - 1)
+			fprintf(out, " >=%u:%u", 1U << (i - 1), entry->hist[i]);
+		else
+			fprintf(out, " <%u:%u", 1U << i, entry->hist[i]);
+	}
+	fprintf(out, "\n");
+}
+
+void can_stats_dump(const struct can_stats *stats, FILE *out)
+{
+	unsigned int i;
+
+	fprintf(out, "      ID      Count        Bytes   Min (ms)  Mean (ms)   Max (ms)\n");
+
+	for (i = 0; i <= CAN_SFF_MASK; i++)
+		dump_entry(&stats->sff[i], i, out);
+
+	for (i = 0; i < CAN_STATS_EFF_SLOTS; i++)
+		dump_entry(&stats->eff[i], stats->eff[i].can_id, out);
+
+	if (stats->eff_overflow)
+		fprintf(out, "%llu frames of extended IDs not accounted (table full)\n",
+			(unsigned long long)stats->eff_overflow);
+	fprintf(out, "\n");
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CAN_STATS_H_
+#define CAN_STATS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <linux/can.h>
+
+/*
+ * Jitter histogram buckets: bucket 0 counts deviations below 1 us and
+ * bucket N (N > 0) deviations in [2^(N-1), 2^N) us. The last bucket also
+ * counts all the larger deviations.
+ */
+#define CAN_STATS_HIST_BUCKETS	20
+
+/* Number of slots of the extended ID table, must be a power of two */
+#define CAN_STATS_EFF_SLOTS	4096
+
+struct can_id_stats {
+	uint32_t can_id;		/* Extended ID table only, 0 if unused */
+	uint32_t count;
+	uint64_t bytes;
+	uint64_t last_ns;		/* Timestamp of the last frame */
+	uint64_t min_period_ns;
+	uint64_t max_period_ns;
+	uint64_t sum_period_ns;
+	uint64_t avg_period_ns;		/* Moving average, jitter reference */
+	uint32_t hist[CAN_STATS_HIST_BUCKETS];
+};
+
+struct can_stats {
+	struct can_id_stats sff[CAN_SFF_MASK + 1];
+	struct can_id_stats *eff;
+	uint32_t eff_used;
+	uint64_t eff_overflow;		/* Frames of IDs that did not fit */
+};
+
+/*
+ * can_stats_init() - Allocates and initializes a statistics table
+ *
+ * Return: The statistics table, NULL on error.
+ */
+struct can_stats *can_stats_init(void);
+
+/*
+ * can_stats_update() - Accounts a received frame
+ *
+ * The update is O(1) and does not allocate memory. It must always be called
+ * from the same thread.
+ *
+ * @stats:	Statistics table.
+ * @frame:	Received frame.
+ * @ts_ns:	Reception timestamp in ns.
+ */
+void can_stats_update(struct can_stats *stats, const struct canfd_frame *frame,
+		      uint64_t ts_ns);
+
+/*
+ * can_stats_dump() - Prints the statistics of all the received IDs
+ *
+ * The table may be updated while it is printed, the values of an ID can be
+ * slightly inconsistent between them.
+ *
+ * @stats:	Statistics table.
+ * @out:	Stream to print to.
+ */
+void can_stats_dump(const struct can_stats *stats, FILE *out);
+
+/*
+ * can_stats_free() - Frees a statistics table
+ *
+ * @stats:	Statistics table.
+ */
+void can_stats_free(struct can_stats *stats);
+
+#endif /* CAN_STATS_H_ */
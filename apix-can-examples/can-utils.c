@@ -0,0 +1,246 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <net/if.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <linux/can/raw.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <linux/sockios.h>
+
+#include "can-utils.h"
+
+/* Bits from SOF to the end of the CRC subject to bit stuffing (without data) */
+#define CAN_SFF_STUFFED_BITS	34	/* SOF, ID, RTR, IDE, r0, DLC, CRC */
+#define CAN_EFF_STUFFED_BITS	54	/* SOF, ID, SRR, IDE, ID ext, RTR, r1, r0, DLC, CRC */
+/* CRC delimiter, ACK, ACK delimiter, EOF and IFS */
+#define CAN_TRAILER_BITS	(1 + 1 + 1 + 7 + 3)
+
+/* CAN FD arbitration phase, from SOF to BRS */
+#define CANFD_SFF_ARB_BITS	17
+#define CANFD_EFF_ARB_BITS	36
+/* ESI and DLC, sent in the data phase */
+#define CANFD_DATA_HDR_BITS	5
+/* Stuff count (with its parity and fixed stuff bit) and CRC delimiter */
+#define CANFD_STUFF_COUNT_BITS	5
+#define CANFD_CRC_DELIM_BITS	1
+/* ACK, ACK delimiter, EOF and IFS, sent at the nominal bitrate */
+#define CANFD_TRAILER_BITS	(1 + 1 + 7 + 3)
+
+/*
+ * enable_hw_timestamps() - Enables RX hardware timestamping in the controller
+ *
+ * Not all the CAN controllers support it, errors are ignored and the
+ * software timestamps are used in that case.
+ *
+ * @iface:	Name of the CAN interface.
+ */
+static void enable_hw_timestamps(const char *iface)
+{
+	struct hwtstamp_config cfg;
+	struct ifreq ifr;
+	int fd;
+
+	fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0)
+		return;
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.tx_type = HWTSTAMP_TX_OFF;
+	cfg.rx_filter = HWTSTAMP_FILTER_ALL;
+
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, iface, sizeof(ifr.ifr_name) - 1);
+	ifr.ifr_data = (void *)&cfg;
+
+	ioctl(fd, SIOCSHWTSTAMP, &ifr);
+	close(fd);
+}
+
+int can_socket_open(const char *iface, int flags)
+{
+	struct sockaddr_can addr;
+	int enable = 1;
+	int type = SOCK_RAW;
+	int fd, ret;
+
+	if (flags & CAN_SOCK_NONBLOCK)
+		type |= SOCK_NONBLOCK;
+
+	fd = socket(PF_CAN, type, CAN_RAW);
+	if (fd < 0)
+		return -errno;
+
+	if (flags & CAN_SOCK_FD) {
+		if (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable,
+			       sizeof(enable)) < 0)
+			goto error;
+	}
+
+	if (flags & CAN_SOCK_TIMESTAMP) {
+		int tsflags = SOF_TIMESTAMPING_RX_SOFTWARE |
+			      SOF_TIMESTAMPING_SOFTWARE |
+			      SOF_TIMESTAMPING_RX_HARDWARE |
+			      SOF_TIMESTAMPING_RAW_HARDWARE;
+
+		enable_hw_timestamps(iface);
+		if (setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &tsflags,
+			       sizeof(tsflags)) < 0)
+			goto error;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = if_nametoindex(iface);
+	if (!addr.can_ifindex)
+		goto error;
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+		goto error;
+
+	return fd;
+
+error:
+	ret = -errno;
+	close(fd);
+
+	return ret;
+}
+
+void can_rx_ts_parse(struct msghdr *msg, struct can_rx_ts *ts)
+{
+	struct cmsghdr *cmsg;
+
+	memset(ts, 0, sizeof(*ts));
+	for (cmsg = CMSG_FIRSTHDR(msg); cmsg; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+		struct scm_timestamping *tss;
+
+		if (cmsg->cmsg_level != SOL_SOCKET ||
+		    cmsg->cmsg_type != SO_TIMESTAMPING)
+			continue;
+
+		tss = (struct scm_timestamping *)CMSG_DATA(cmsg);
+		ts->sw = tss->ts[0];
+		ts->hw = tss->ts[2];
+	}
+}
+
+int can_socket_recv(int fd, struct canfd_frame *frame, struct can_rx_ts *ts)
+{
+	char ctrl[CMSG_SPACE(sizeof(struct scm_timestamping))];
+	struct iovec iov = {
+		.iov_base = frame,
+		.iov_len = sizeof(*frame),
+	};
+	struct msghdr msg = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = ts ? ctrl : NULL,
+		.msg_controllen = ts ? sizeof(ctrl) : 0,
+	};
+	ssize_t len;
+
+	len = recvmsg(fd, &msg, 0);
+	if (len < 0)
+		return -errno;
+	if (len != CAN_MTU && len != CANFD_MTU)
+		return -EIO;
+
+	if (!ts)
+		return len;
+
+	can_rx_ts_parse(&msg, ts);
+
+	return len;
+}
+
+int thread_set_realtime(int prio, int cpu)
+{
+	struct sched_param param;
+	cpu_set_t cpuset;
+	int ret;
+
+	if (cpu >= 0) {
+		CPU_ZERO(&cpuset);
+		CPU_SET(cpu, &cpuset);
+		ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuset),
+					     &cpuset);
+		if (ret)
+			return -ret;
+	}
+
+	if (prio > 0) {
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = prio;
+		ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+		if (ret)
+			return -ret;
+	}
+
+	return 0;
+}
+
+uint64_t can_frame_time_ns(const struct canfd_frame *frame, bool fd,
+			   uint32_t bitrate, uint32_t dbitrate)
+{
+	bool eff = frame->can_id & CAN_EFF_FLAG;
+	unsigned int len = frame->len;
+	uint64_t arb_bits, data_bits;
+	unsigned int stuffed, stuff, arb_stuff, crc_bits;
+
+	if (!bitrate)
+		return 0;
+
+	if (!fd) {
+		if (frame->can_id & CAN_RTR_FLAG)
+			len = 0;
+		stuffed = (eff ? CAN_EFF_STUFFED_BITS : CAN_SFF_STUFFED_BITS) +
+			  8 * len;
+		arb_bits = stuffed + (stuffed - 1) / 4 + CAN_TRAILER_BITS;
+
+		return arb_bits * NSEC_PER_SEC / bitrate;
+	}
+
+	if (!dbitrate || !(frame->flags & CANFD_BRS))
+		dbitrate = bitrate;
+
+	/* CRC-17 up to 16 data bytes, CRC-21 above, with fixed stuff bits */
+	crc_bits = len <= 16 ? 17 : 21;
+	crc_bits += (crc_bits + 3) / 4;
+
+	arb_bits = eff ? CANFD_EFF_ARB_BITS : CANFD_SFF_ARB_BITS;
+	data_bits = CANFD_DATA_HDR_BITS + 8 * len;
+
+	/* Dynamic stuffing applies from SOF to the end of the data field */
+	stuff = (arb_bits + data_bits - 1) / 4;
+	arb_stuff = arb_bits / 4;
+
+	arb_bits += arb_stuff + CANFD_TRAILER_BITS;
+	data_bits += stuff - arb_stuff + CANFD_STUFF_COUNT_BITS + crc_bits +
+		     CANFD_CRC_DELIM_BITS;
+
+	return arb_bits * NSEC_PER_SEC / bitrate +
+	       data_bits * NSEC_PER_SEC / dbitrate;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CAN_UTILS_H_
+#define CAN_UTILS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/socket.h>
+
+#include <linux/can.h>
+
+/* Flags for can_socket_open() */
+#define CAN_SOCK_FD		(1 << 0)	/* Enable CAN FD frames */
+#define CAN_SOCK_NONBLOCK	(1 << 1)	/* Non-blocking socket */
+#define CAN_SOCK_TIMESTAMP	(1 << 2)	/* SO_TIMESTAMPING RX timestamps */
+
+#define NSEC_PER_SEC		1000000000ULL
+
+/* Reception timestamps of a frame read with can_socket_recv() */
+struct can_rx_ts {
+	struct timespec sw;	/* Kernel software timestamp (CLOCK_REALTIME) */
+	struct timespec hw;	/* Raw hardware timestamp, zero if not available */
+};
+
+/*
+ * can_socket_open() - Opens a CAN_RAW socket bound to a CAN interface
+ *
+ * The interface must be already configured and up, for example with
+ * ldx_can_init().
+ *
+ * @iface:	Name of the CAN interface.
+ * @flags:	CAN_SOCK_* flags.
+ *
+ * Return: The socket file descriptor, -errno on error.
+ */
+int can_socket_open(const char *iface, int flags);
+
+/*
+ * can_socket_recv() - Reads a frame and its timestamps from a CAN socket
+ *
+ * @fd:		CAN socket opened with can_socket_open().
+ * @frame:	Buffer to store the frame.
+ * @ts:		Buffer to store the timestamps, NULL if not needed. The
+ *		timestamps are only filled if the socket was opened with
+ *		CAN_SOCK_TIMESTAMP.
+ *
+ * Return: The number of bytes read (CAN_MTU or CANFD_MTU), -errno on error.
+ */
+int can_socket_recv(int fd, struct canfd_frame *frame, struct can_rx_ts *ts);
+
+/*
+ * can_rx_ts_parse() - Extracts the timestamps of a frame from its control data
+ *
+ * For frames read with recvmsg() or recvmmsg() from a socket opened with
+ * CAN_SOCK_TIMESTAMP. The timestamps are zero if the message has no
+ * SO_TIMESTAMPING control data.
+ *
+ * @msg:	Message header of the received frame.
+ * @ts:		Buffer to store the timestamps.
+ */
+void can_rx_ts_parse(struct msghdr *msg, struct can_rx_ts *ts);
+
+/*
+ * can_frame_time_ns() - Estimates the time a frame takes on the bus
+ *
+ * The estimation includes the interframe space and the worst case number of
+ * dynamic stuff bits. For CAN FD frames with the BRS flag set the data phase
+ * is computed at the data bitrate.
+ *
+ * @frame:	The frame.
+ * @fd:		Whether the frame is a CAN FD frame.
+ * @bitrate:	Nominal bitrate (Hz).
+ * @dbitrate:	CAN FD data bitrate (Hz), 0 to use the nominal bitrate.
+ *
+ * Return: The frame time in nanoseconds.
+ */
+uint64_t can_frame_time_ns(const struct canfd_frame *frame, bool fd,
+			   uint32_t bitrate, uint32_t dbitrate);
+
+/*
+ * thread_set_realtime() - Configures the scheduling of the calling thread
+ *
+ * @prio:	SCHED_FIFO priority (1-99), 0 to keep the current policy.
+ * @cpu:	CPU to pin the thread to, negative to keep the affinity.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int thread_set_realtime(int prio, int cpu);
+
+/*
+ * timespec_to_ns() - Converts a timespec to nanoseconds
+ *
+ * @ts:		Time to convert.
+ *
+ * Return: The time in nanoseconds.
+ */
+static inline uint64_t timespec_to_ns(const struct timespec *ts)
+{
+	return (uint64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+}
+
+/*
+ * now_ns() - Returns the current time of a clock in nanoseconds
+ *
+ * @clk:	Clock to read.
+ *
+ * Return: The current time in nanoseconds.
+ */
+static inline uint64_t now_ns(clockid_t clk)
+{
+	struct timespec ts;
+
+	clock_gettime(clk, &ts);
+
+	return timespec_to_ns(&ts);
+}
+
+#endif /* CAN_UTILS_H_ */
@@ -15,16 +15,24 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <libgen.h>
 #include <limits.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <libdigiapix/spi.h>
 
+#include "spi-eeprom.h"
+#include "spi-poll.h"
+#include "spi-program.h"
+
 #define DEFAULT_SPI_ALIAS		"DEFAULT_SPI"
 #define DEFAULT_SPI_ADDRESS_SIZE	1
 #define DEFAULT_SPI_PAGE_SIZE		16
@@ -49,7 +57,24 @@
 
 #define OPERATION_BYTES		1
 
+#define DEFAULT_POLL_SAMPLES		5000
+#define DEFAULT_POLL_PRIORITY		50
+
+/* Registers read by every operation of the message benchmark */
+#define BENCH_REGS			4
+#define BENCH_REG_SIZE			4
+
+/* Bus speeds of the read benchmark */
+static const unsigned int bench_speeds[] = {
+	1000000, 2000000, 5000000, 10000000, 20000000
+};
+
 static spi_t *spi_dev;
+static struct spi_eeprom eeprom;
+static struct spi_poll poller;
+static uint8_t *mem_buffer, *mem_buffer2;
+static uint8_t *image;
+static size_t image_size;
 static unsigned int page_size, address_bytes = 0;
 static uint8_t *tx_buffer;
 static uint8_t *rx_buffer;
@@ -66,15 +91,39 @@ static void usage_and_exit(char *name, int exitval)
 	fprintf(stdout,
 		"Example application using libdigiapix SPI support\n"
 		"\n"
-		"Usage: %s <spi-dev> <spi-ss> <address-size> <page-size> <page-index>\n\n"
+		"Usage: %s [options] <spi-dev> <spi-ss> <address-size> <page-size> <page-index>\n\n"
 		"<spi-dev>       SPI device index to use or alias\n"
 		"<spi-ss>        SPI slave index to use or alias\n"
 		"<address-size>  Number of EEPROM memory address bytes\n"
 		"<page-size>     EEPROM memory page size in bytes\n"
 		"<page-index>    EEPROM memory page index to use\n"
 		"\n"
+		"Options:\n"
+		"-n <pages>      Number of pages to write from <page-index>\n"
+		"                (default 1)\n"
+		"-t <us>         Typical write cycle time of the EEPROM, the time\n"
+		"                to wait before polling the status (default %d)\n"
+		"-p <file>       Program the image in <file> from <page-index>,\n"
+		"                skipping the pages that already match, and\n"
+		"                verify it, instead of writing random data\n"
+		"-s <bytes>      EEPROM memory size, required by -d and -B\n"
+		"-d <file>       Dump the whole memory to <file> instead of writing\n"
+		"                the page\n"
+		"-M <ops>        Benchmark <ops> operations submitted as single\n"
+		"                messages against one call per command\n"
+		"-P <rate>       Poll <page-index> at <rate> reads/s from a real\n"
+		"                time thread, as a sensor, and report the timing\n"
+		"-C <samples>    Number of samples to poll (default %d)\n"
+		"-F <priority>   SCHED_FIFO priority of the polling thread, 0 for\n"
+		"                the default policy (default %d)\n"
+		"-B              Benchmark the page by page read against the\n"
+		"                sequential read of the whole memory at several bus\n"
+		"                speeds, instead of writing the page\n"
+		"-h              Help\n"
+		"\n"
 		"Aliases for SPI can be configured in the library config file\n"
-		"\n", name);
+		"\n", name, SPI_EEPROM_DEF_TWC_US, DEFAULT_POLL_SAMPLES,
+		DEFAULT_POLL_PRIORITY);
 
 	exit(exitval);
 }
@@ -85,11 +134,17 @@ static void usage_and_exit(char *name, int exitval)
 static void cleanup(void)
 {
 	/* Free spi */
+	spi_poll_stop(&poller);
+	spi_eeprom_close(&eeprom);
 	ldx_spi_free(spi_dev);
 
 	/* Free buffers */
 	free(tx_buffer);
 	free(rx_buffer);
+	free(mem_buffer);
+	free(mem_buffer2);
+	if (image)
+		munmap(image, image_size);
 }
 
 /*
@@ -155,158 +210,483 @@ static int parse_argument(char *argv, int arg_type)
 }
 
 /*
- * enable_write() - Sets the SPI write enable bit
+ * write_page() - Writes an EEPROM page with the given data
+ *
+ * @page_index:	index of the EEPROM page to write.
+ * @data:	the data to write.
  *
  * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
  */
-static int enable_write(void)
+static int write_page(int page_index, uint8_t* data)
 {
-	uint8_t write_data[1] = {0};
+	uint32_t page_address = page_size * page_index;
+	int ret;
 
-	printf("[INFO] Setting write enable bit...\n");
-	write_data[0] = WREN;
+	printf("[INFO] Writing %d bytes to page %d at address 0x%x...\n", page_size,
+			  page_index, page_address);
+
+	/* Perform the write operation, directly from the given buffer. */
+	ret = spi_eeprom_write_page(&eeprom, page_address, data, page_size);
+	if (ret) {
+		printf("Failed to write the page: %s\n", strerror(-ret));
+		return EXIT_FAILURE;
+	}
 
-	return ldx_spi_write(spi_dev, write_data, sizeof(write_data));
+	/* Wait for the write cycle to complete. */
+	ret = spi_eeprom_wait_ready(&eeprom, SPI_EEPROM_WC_TIMEOUT_US);
+	if (ret < 0) {
+		printf("Failed to wait for the write cycle: %s\n", strerror(-ret));
+		return EXIT_FAILURE;
+	}
+	printf("[INFO] Write finished in %d us\n", ret);
+
+	return EXIT_SUCCESS;
 }
 
 /*
- * read_status_register() - Reads the SPI status register
+ * read_page() - Reads an EEPROM page
  *
- * @status:	Variable to store the read status.
+ * @page_index:	index of the EEPROM page to read.
+ * @data:	buffer to store the read data in.
  *
  * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
  */
-static int read_status_register(uint8_t *status)
+static int read_page(int page_index, uint8_t* data)
 {
-	uint8_t write_data[2] = {0};
-	uint8_t read_data[2] = {0};
+	uint32_t page_address = page_size * page_index;
+
+	printf("[INFO] Reading page %d at address 0x%x...\n", page_index,
+			  page_address);
 
-	printf("[INFO] Reading status register...\n");
-	write_data[0] = RDSR;
-	if (ldx_spi_transfer(spi_dev, write_data, read_data, 2) != EXIT_SUCCESS) {
+	/* The data is received directly in the given buffer */
+	if (spi_eeprom_read(&eeprom, page_address, data, page_size)) {
 		return EXIT_FAILURE;
 	}
 
-	printf("[INFO] SPI Status Register is 0x%02x\n", read_data[1]);
-	*status = read_data[1];
-
 	return EXIT_SUCCESS;
 }
 
 /*
- * write_page() - Writes an EEPROM page with the given data
+ * elapsed_secs() - Returns the time elapsed since the given time
  *
- * @page_index:	index of the EEPROM page to write.
- * @data:	the data to write.
+ * @start:	CLOCK_MONOTONIC start time.
+ *
+ * Return: The elapsed time, in seconds.
+ */
+static double elapsed_secs(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start->tv_sec) +
+		(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+ * dump_memory() - Reads the whole memory and writes it to a file
+ *
+ * @path:	File to write.
+ * @mem_size:	Memory size, in bytes.
  *
  * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
  */
-static int write_page(int page_index, uint8_t* data)
+static int dump_memory(const char *path, uint32_t mem_size)
 {
-	uint8_t *write_data;
-	uint16_t page_address = page_size * page_index;
-	uint8_t status = 0;
-	int i, ret = 0;
-
-	/* Create the page write buffer */
-	write_data = (uint8_t *)calloc(page_size + OPERATION_BYTES + address_bytes,
-			  sizeof(uint8_t));
-	if (write_data == NULL) {
-		printf("Unable to allocate memory to write the page.");
+	struct timespec start;
+	double secs;
+	ssize_t n;
+	size_t done;
+	int fd, ret;
+
+	printf("[INFO] Reading %u bytes...\n", mem_size);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	ret = spi_eeprom_read(&eeprom, 0, mem_buffer, mem_size);
+	if (ret) {
+		printf("Failed to read the memory: %s\n", strerror(-ret));
 		return EXIT_FAILURE;
 	}
+	secs = elapsed_secs(&start);
+	printf("[INFO] Read %u bytes in %lu transfers, %.3f s (%.1f KB/s)\n",
+	       mem_size, eeprom.messages, secs, mem_size / 1024.0 / secs);
 
-	printf("[INFO] Writing %d bytes to page %d at address 0x%x...\n", page_size,
-			  page_index, page_address);
-	write_data[0] = WRITE; // Operation.
-	for (i = 0; i < address_bytes; i++) {
-		write_data[i + OPERATION_BYTES] = (page_address >> (8 * (address_bytes -
-				  i - 1)));
+	fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		printf("Failed to create '%s': %s\n", path, strerror(errno));
+		return EXIT_FAILURE;
+	}
+	for (done = 0; done < mem_size; done += n) {
+		n = write(fd, mem_buffer + done, mem_size - done);
+		if (n < 0) {
+			printf("Failed to write '%s': %s\n", path,
+			       strerror(errno));
+			close(fd);
+			return EXIT_FAILURE;
+		}
+	}
+	close(fd);
+
+	printf("[INFO] Memory dumped to '%s'\n", path);
+
+	return EXIT_SUCCESS;
+}
+
+/*
+ * bench_read() - Compares the page by page and the sequential reads
+ *
+ * Reads the whole memory at every speed of 'bench_speeds', first with one
+ * transfer per page and then with the sequential read, and checks that both
+ * return the same data.
+ *
+ * @mem_size:	Memory size, in bytes.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int bench_read(uint32_t mem_size)
+{
+	double page_secs, bulk_secs;
+	unsigned long page_msgs, bulk_msgs;
+	struct timespec start;
+	uint32_t addr, len;
+	unsigned int i;
+	int ret;
+
+	printf("Reading %u bytes, %u byte pages, up to %u bytes per transfer\n\n",
+	       mem_size, page_size, eeprom.max_msg);
+	printf("   Speed (Hz)   Bus (KB/s)  Paged (KB/s)   Bulk (KB/s)   "
+	       "Transfers  Data\n");
+
+	for (i = 0; i < sizeof(bench_speeds) / sizeof(bench_speeds[0]); i++) {
+		if (ldx_spi_set_speed(spi_dev, bench_speeds[i]) != EXIT_SUCCESS) {
+			printf("Failed to set the bus speed to %u Hz\n",
+			       bench_speeds[i]);
+			return EXIT_FAILURE;
+		}
+
+		/* One transfer per page */
+		page_msgs = eeprom.messages;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (addr = 0; addr < mem_size; addr += len) {
+			len = mem_size - addr < page_size ?
+				mem_size - addr : page_size;
+			ret = spi_eeprom_read(&eeprom, addr, mem_buffer2 + addr,
+					      len);
+			if (ret)
+				goto err;
+		}
+		page_secs = elapsed_secs(&start);
+		page_msgs = eeprom.messages - page_msgs;
+
+		/* Sequential read of the whole memory */
+		bulk_msgs = eeprom.messages;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		ret = spi_eeprom_read(&eeprom, 0, mem_buffer, mem_size);
+		if (ret)
+			goto err;
+		bulk_secs = elapsed_secs(&start);
+		bulk_msgs = eeprom.messages - bulk_msgs;
+
+		printf("%13u %12.1f %13.1f %13.1f %6lu/%-6lu %s\n",
+		       bench_speeds[i], bench_speeds[i] / 8 / 1024.0,
+		       mem_size / 1024.0 / page_secs,
+		       mem_size / 1024.0 / bulk_secs, page_msgs, bulk_msgs,
+		       memcmp(mem_buffer, mem_buffer2, mem_size) ?
+		       "MISMATCH" : "match");
 	}
 
-	/* Fill the data array. */
-	for (i = 0; i < page_size; i++) {
-		write_data[(i + OPERATION_BYTES + address_bytes)] = data[i];
+	ldx_spi_set_speed(spi_dev, MAX_BUS_SPEED);
+
+	return EXIT_SUCCESS;
+
+err:
+	printf("Failed to read the memory at %u Hz: %s\n", bench_speeds[i],
+	       strerror(-ret));
+
+	return EXIT_FAILURE;
+}
+
+/*
+ * bench_op() - Runs an operation of the message benchmark
+ *
+ * @op:		0: WREN and RDSR, 1: RDSR and BENCH_REGS register reads.
+ * @batched:	Submit the operation as one message instead of one
+ *		libdigiapix call per command.
+ * @regs:	Buffer for the registers read.
+ *
+ * Return: 0 on success, -1 on error.
+ */
+static int bench_op(int op, int batched, uint8_t *regs)
+{
+	uint8_t tx[BENCH_REGS][1 + SPI_EEPROM_MAX_ADDR_BYTES + BENCH_REG_SIZE];
+	uint8_t rx[1 + SPI_EEPROM_MAX_ADDR_BYTES + BENCH_REG_SIZE];
+	uint8_t wren = WREN, rdsr[2] = {RDSR, 0}, status[2];
+	struct spi_seg segs[1 + 2 * BENCH_REGS];
+	unsigned int hdr = OPERATION_BYTES + address_bytes;
+	unsigned int i, j, n = 0, addr;
+
+	memset(tx, 0, sizeof(tx));
+	for (i = 0; i < BENCH_REGS; i++) {
+		/* Registers spread over the memory */
+		addr = i * page_size;
+		tx[i][0] = READ;
+		for (j = 0; j < address_bytes; j++)
+			tx[i][1 + j] = addr >> (8 * (address_bytes - j - 1));
 	}
 
-	/* Perform the write operation. */
-	if (ldx_spi_write(spi_dev, write_data, page_size + OPERATION_BYTES +
-			  address_bytes) != EXIT_SUCCESS) {
-		free(write_data);
-		return EXIT_FAILURE;
+	if (!batched) {
+		if (op == 0)
+			return ldx_spi_write(spi_dev, &wren, 1) ||
+			       ldx_spi_transfer(spi_dev, rdsr, status, 2) ? -1 : 0;
+
+		if (ldx_spi_transfer(spi_dev, rdsr, status, 2))
+			return -1;
+		for (i = 0; i < BENCH_REGS; i++) {
+			if (ldx_spi_transfer(spi_dev, tx[i], rx,
+					     hdr + BENCH_REG_SIZE))
+				return -1;
+			memcpy(regs + i * BENCH_REG_SIZE, rx + hdr,
+			       BENCH_REG_SIZE);
+		}
+		return 0;
+	}
+
+	memset(segs, 0, sizeof(segs));
+	if (op == 0) {
+		segs[n++] = (struct spi_seg){ .tx = &wren, .len = 1,
+					      .cs_change = true };
+		segs[n++] = (struct spi_seg){ .tx = rdsr, .rx = status,
+					      .len = 2 };
+	} else {
+		segs[n++] = (struct spi_seg){ .tx = rdsr, .rx = status,
+					      .len = 2, .cs_change = true };
+		for (i = 0; i < BENCH_REGS; i++) {
+			segs[n++] = (struct spi_seg){ .tx = tx[i], .len = hdr };
+			segs[n++] = (struct spi_seg){
+				.rx = regs + i * BENCH_REG_SIZE,
+				.len = BENCH_REG_SIZE,
+				.cs_change = true,
+			};
+		}
+	}
+
+	return spi_msg_transfer(eeprom.fd, segs, n) ? -1 : 0;
+}
+
+/*
+ * bench_msg() - Compares single messages with one call per command
+ *
+ * Runs two operations, WREN followed by RDSR (the same sequence as WREN and
+ * WRITE, without a write cycle) and RDSR followed by the read of
+ * BENCH_REGS registers, first with one libdigiapix call per command and
+ * then with a single message per operation.
+ *
+ * @ops:	Number of operations of every test.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int bench_msg(unsigned long ops)
+{
+	static const char * const names[] = {
+		"WREN + RDSR",
+		"RDSR + register reads",
+	};
+	uint8_t regs[2][BENCH_REGS * BENCH_REG_SIZE];
+	double secs[2];
+	struct timespec start;
+	unsigned long k;
+	int op, batched;
+
+	printf("%lu operations per test at %u Hz, %d registers of %d bytes\n\n",
+	       ops, MAX_BUS_SPEED, BENCH_REGS, BENCH_REG_SIZE);
+	printf("%-24s %12s %12s %10s\n", "Operation", "Calls (op/s)",
+	       "Batch (op/s)", "Speedup");
+
+	for (op = 0; op < 2; op++) {
+		for (batched = 0; batched < 2; batched++) {
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			for (k = 0; k < ops; k++) {
+				if (bench_op(op, batched, regs[batched])) {
+					printf("Failed to run the operation\n");
+					return EXIT_FAILURE;
+				}
+			}
+			secs[batched] = elapsed_secs(&start);
+		}
+
+		printf("%-24s %12.0f %12.0f %9.2fx", names[op], ops / secs[0],
+		       ops / secs[1], secs[0] / secs[1]);
+		if (op == 1 && memcmp(regs[0], regs[1], sizeof(regs[0])))
+			printf("  (registers differ!)");
+		printf("\n");
 	}
 
-	/* Wait for the operation to complete. */
-	do {
-		/* Read the status register to check the WIP (write-in-progress) bit. */
-		ret = read_status_register(&status);
-		if (ret != EXIT_SUCCESS) {
-			free(write_data);
+	/* Leave the write enable latch as it was */
+	return ldx_spi_write(spi_dev, (uint8_t []){ WRDI }, 1) ?
+		EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*
+ * poll_page() - Polls a page of the memory as if it were a sensor
+ *
+ * The samples are read by the polling thread and consumed here.
+ *
+ * @page_index:	Page to read.
+ * @rate:	Reads per second.
+ * @samples:	Number of samples to consume.
+ * @priority:	SCHED_FIFO priority, 0 for the default policy.
+ *
+ * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
+ */
+static int poll_page(int page_index, double rate, unsigned long samples,
+		     int priority)
+{
+	uint32_t addr = page_size * page_index;
+	uint8_t cmd[1 + SPI_EEPROM_MAX_ADDR_BYTES];
+	struct spi_poll_cfg cfg = {
+		.period_ns = 1e9 / rate,
+		.cmd = cmd,
+		.cmd_len = OPERATION_BYTES + address_bytes,
+		.len = page_size,
+		.priority = priority,
+	};
+	const struct spi_poll_stats *st = &poller.stats;
+	struct spi_poll_sample sample;
+	uint64_t delay, delay_max = 0, delay_sum = 0;
+	struct timespec now;
+	unsigned long received = 0;
+	double secs;
+	int i, ret, timeout_ms;
+
+	cmd[0] = READ;
+	for (i = 0; i < address_bytes; i++)
+		cmd[1 + i] = addr >> (8 * (address_bytes - i - 1));
+
+	/* No page faults in the polling loop */
+	if (mlockall(MCL_CURRENT | MCL_FUTURE))
+		printf("[WARN] Unable to lock the memory: %s\n", strerror(errno));
+
+	ret = spi_poll_start(&poller, eeprom.fd, &cfg);
+	if (ret) {
+		printf("Failed to start polling: %s\n", strerror(-ret));
+		return EXIT_FAILURE;
+	}
+	if (priority && !poller.rt)
+		printf("[WARN] Not allowed to use SCHED_FIFO, polling with the "
+		       "default policy\n");
+	printf("[INFO] Polling %u bytes at address 0x%x, %.1f reads/s...\n",
+	       page_size, addr, rate);
+
+	/* Two periods plus some margin for the thread to run */
+	timeout_ms = cfg.period_ns / 1000000 < INT_MAX / 2 - 1000 ?
+		     cfg.period_ns * 2 / 1000000 + 1000 : INT_MAX;
+
+	while (received < samples) {
+		ret = spi_poll_get(&poller, &sample, timeout_ms);
+		if (ret < 0) {
+			printf("Failed to get a sample: %s\n", strerror(-ret));
 			return EXIT_FAILURE;
 		}
-		/* Check the WIP (write-in-progress) status bit. */
-		if (status & 0x01) {
-			printf("[INFO] Write in progress...\n");
-			usleep(1);
-		} else {
-			printf("[INFO] Write finished!\n");
+		if (!ret) {
+			printf("No samples for %d ms\n", timeout_ms);
+			return EXIT_FAILURE;
 		}
-	} while (status & 0x1);
 
-	free(write_data);
+		/* From the deadline of the poll to the consumer */
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		delay = now.tv_sec * 1000000000ULL + now.tv_nsec - sample.ts;
+		if (delay > delay_max)
+			delay_max = delay;
+		delay_sum += delay;
+
+		received++;
+		spi_poll_release(&poller);
+	}
+
+	spi_poll_stop(&poller);
+
+	secs = (st->last_ts - st->first_ts) / 1e9;
+	printf("Samples: %llu read, %lu consumed, %llu dropped, %llu errors\n",
+	       (unsigned long long)st->polls, received,
+	       (unsigned long long)st->dropped, (unsigned long long)st->errors);
+	if (st->polls > 1 && secs > 0)
+		printf("Rate: %.1f reads/s (nominal %.1f), %llu missed deadlines\n",
+		       (st->polls - 1) / secs, rate,
+		       (unsigned long long)st->missed);
+	if (st->polls)
+		printf("Transfer latency: min %.1f us, avg %.1f us, max %.1f us\n",
+		       st->lat_min / 1e3, (double)st->lat_sum / st->polls / 1e3,
+		       st->lat_max / 1e3);
+	printf("Wake up delay: max %.1f us\n", st->wake_max / 1e3);
+	printf("Deadline to consumer: avg %.1f us, max %.1f us\n",
+	       (double)delay_sum / received / 1e3, delay_max / 1e3);
 
 	return EXIT_SUCCESS;
 }
 
 /*
- * read_page() - Reads an EEPROM page
+ * program_image() - Programs an image file into the memory
  *
- * @page_index:	index of the EEPROM page to read.
- * @data:	buffer to store the read data in.
+ * @path:	Image file.
+ * @page_index:	Page to program the image at.
+ * @mem_size:	Memory size in bytes, 0 if unknown.
  *
  * Return: EXIT_SUCCESS on success, EXIT_FAILURE otherwise.
  */
-static int read_page(int page_index, uint8_t* data)
+static int program_image(const char *path, int page_index, uint32_t mem_size)
 {
-	uint8_t *write_data;
-	uint8_t *read_data;
-	uint16_t page_address;
-	int i = 0;
-
-	page_address = page_size * page_index;
-
-	/* Create the buffers */
-	write_data = (uint8_t *)calloc(page_size + OPERATION_BYTES + address_bytes,
-			  sizeof(uint8_t));
-	read_data = (uint8_t *)calloc(page_size + OPERATION_BYTES + address_bytes,
-			  sizeof(uint8_t));
-	if (write_data == NULL || read_data == NULL) {
-		printf("Unable to allocate memory to read the page.");
+	uint32_t addr = page_size * page_index;
+	struct spi_prog_stats st;
+	struct stat sb;
+	int fd, ret;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		printf("Failed to open '%s': %s\n", path, strerror(errno));
+		return EXIT_FAILURE;
+	}
+	if (fstat(fd, &sb) || !sb.st_size) {
+		printf("Failed to get the size of '%s'\n", path);
+		close(fd);
+		return EXIT_FAILURE;
+	}
+	if (mem_size && addr + (uint64_t)sb.st_size > mem_size) {
+		printf("The image (%lld bytes) does not fit at address 0x%x\n",
+		       (long long)sb.st_size, addr);
+		close(fd);
+		return EXIT_FAILURE;
+	}
+	image_size = sb.st_size;
+	image = mmap(NULL, image_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (image == MAP_FAILED) {
+		image = NULL;
+		printf("Failed to map '%s': %s\n", path, strerror(errno));
 		return EXIT_FAILURE;
 	}
 
-	printf("[INFO] Reading page %d at address 0x%x...\n", page_index,
-			  page_address);
-	write_data[0] = READ; // Operation.
-	for (i = 0; i < address_bytes; i++) {
-		write_data[i + OPERATION_BYTES] = (page_address >> (8 * (address_bytes -
-				i - 1)));
+	printf("[INFO] Programming %zu bytes at address 0x%x...\n", image_size,
+	       addr);
+	ret = spi_program_image(&eeprom, addr, image, image_size, &st);
+	if (ret && ret != -EIO) {
+		printf("Failed to program the image: %s\n", strerror(-ret));
+		return EXIT_FAILURE;
 	}
 
-	/* Perform the read operation with a transfer */
-	if (ldx_spi_transfer(spi_dev, write_data, read_data, page_size +
-			  OPERATION_BYTES + address_bytes) != EXIT_SUCCESS) {
-		free(write_data);
-		free(read_data);
+	printf("[INFO] %u pages written, %u already up to date\n",
+	       st.pages_written, st.pages_skipped);
+	if (ret) {
+		printf("Verify failed: image CRC-32 0x%08x, memory CRC-32 0x%08x\n",
+		       st.image_crc, st.read_crc);
 		return EXIT_FAILURE;
 	}
-	for (i = 0; i < page_size; i++) {
-		data[i] = read_data[(i + OPERATION_BYTES + address_bytes)];
+	printf("[INFO] Verify OK, CRC-32 0x%08x\n", st.image_crc);
+	printf("[INFO] Total time %.3f s, %.1f bytes/s\n", st.secs,
+	       image_size / st.secs);
+	if (st.pages_written) {
+		printf("\n");
+		spi_eeprom_print_wc(&eeprom, stdout);
 	}
 
-	free(write_data);
-	free(read_data);
-
 	return EXIT_SUCCESS;
 }
 
@@ -315,16 +695,101 @@ int main(int argc, char *argv[])
 	int spi_device = 0, spi_slave = 0, page_index = 0, i = 0;
 	spi_transfer_cfg_t transfer_mode = {0};
 	char *name = basename(argv[0]);
+	char *dump_file = NULL, *image_file = NULL;
+	uint32_t mem_size = 0;
+	unsigned int twc_us = SPI_EEPROM_DEF_TWC_US;
+	int bench = 0, num_pages = 1, page, errors;
+	unsigned long msg_ops = 0, poll_samples = DEFAULT_POLL_SAMPLES;
+	int poll_priority = DEFAULT_POLL_PRIORITY;
+	double poll_rate = 0;
+	int opt, nargs, ret;
+
+	while ((opt = getopt(argc, argv, "n:t:p:s:d:M:P:C:F:Bh")) > 0) {
+		switch (opt) {
+		case 'n':
+			num_pages = atoi(optarg);
+			if (num_pages <= 0) {
+				printf("Number of pages must be greater than 0\n");
+				return EXIT_FAILURE;
+			}
+			break;
+
+		case 't':
+			twc_us = strtoul(optarg, NULL, 10);
+			break;
+
+		case 'p':
+			image_file = optarg;
+			break;
+
+		case 's':
+			mem_size = strtoul(optarg, NULL, 0);
+			if (!mem_size) {
+				printf("Memory size must be greater than 0\n");
+				return EXIT_FAILURE;
+			}
+			break;
+
+		case 'd':
+			dump_file = optarg;
+			break;
+
+		case 'M':
+			msg_ops = strtoul(optarg, NULL, 10);
+			if (!msg_ops) {
+				printf("Number of operations must be greater than 0\n");
+				return EXIT_FAILURE;
+			}
+			break;
+
+		case 'P':
+			poll_rate = strtod(optarg, NULL);
+			if (poll_rate <= 0) {
+				printf("Polling rate must be greater than 0\n");
+				return EXIT_FAILURE;
+			}
+			break;
+
+		case 'C':
+			poll_samples = strtoul(optarg, NULL, 10);
+			if (!poll_samples) {
+				printf("Number of samples must be greater than 0\n");
+				return EXIT_FAILURE;
+			}
+			break;
+
+		case 'F':
+			poll_priority = atoi(optarg);
+			if (poll_priority < 0 || poll_priority > 99) {
+				printf("Priority must be between 0 and 99\n");
+				return EXIT_FAILURE;
+			}
+			break;
+
+		case 'B':
+			bench = 1;
+			break;
+
+		case 'h':
+			usage_and_exit(name, EXIT_SUCCESS);
+			break;
+
+		default:
+			usage_and_exit(name, EXIT_FAILURE);
+		}
+	}
+	argv += optind - 1;
+	nargs = argc - optind;
 
 	/* Check input parameters */
-	if (argc == 1) {
+	if (nargs == 0) {
 		/* Use default values */
 		spi_device = ldx_spi_get_device(DEFAULT_SPI_ALIAS);
 		spi_slave = ldx_spi_get_slave(DEFAULT_SPI_ALIAS);
 		address_bytes = DEFAULT_SPI_ADDRESS_SIZE;
 		page_size = DEFAULT_SPI_PAGE_SIZE;
 		page_index = DEFAULT_SPI_PAGE_INDEX;
-	} else if (argc == 6) {
+	} else if (nargs == 5) {
 		/* Parse command line arguments */
 		spi_device = parse_argument(argv[1], ARG_SPI_DEVICE);
 		spi_slave = parse_argument(argv[2], ARG_SPI_SLAVE);
@@ -351,6 +816,10 @@ int main(int argc, char *argv[])
 		printf("Page index must be greater or equal than 0\n");
 		return EXIT_FAILURE;
 	}
+	if ((dump_file || bench) && !mem_size) {
+		printf("The memory size (-s) is required to dump or benchmark\n");
+		return EXIT_FAILURE;
+	}
 
 	/* Register signals and exit cleanup function */
 	atexit(cleanup);
@@ -384,11 +853,40 @@ int main(int argc, char *argv[])
 		return EXIT_FAILURE;
 	}
 
-	/* Set the write-enable bit. */
-	if (enable_write() != EXIT_SUCCESS) {
-		printf("Failed to set the write-enable bit\n");
+	/* Open the memory for multi-transfer messages */
+	ret = spi_eeprom_open(&eeprom, spi_dev, address_bytes, page_size);
+	if (ret) {
+		printf("Failed to open the SPI device: %s\n", strerror(-ret));
 		return EXIT_FAILURE;
 	}
+	spi_eeprom_set_twc(&eeprom, twc_us);
+
+	if (msg_ops)
+		return bench_msg(msg_ops);
+
+	if (poll_rate)
+		return poll_page(page_index, poll_rate, poll_samples,
+				 poll_priority);
+
+	if (image_file)
+		return program_image(image_file, page_index, mem_size);
+
+	if (dump_file || bench) {
+		mem_buffer = malloc(mem_size);
+		mem_buffer2 = bench ? malloc(mem_size) : NULL;
+		if (!mem_buffer || (bench && !mem_buffer2)) {
+			printf("Failed to allocate the memory buffers\n");
+			return EXIT_FAILURE;
+		}
+
+		if (dump_file && dump_memory(dump_file, mem_size))
+			return EXIT_FAILURE;
+		if (bench && bench_read(mem_size))
+			return EXIT_FAILURE;
+
+		/* 'atexit' executes the cleanup function */
+		return EXIT_SUCCESS;
+	}
 
 	/* Initialize the write and read buffers */
 	tx_buffer = (uint8_t *)calloc(page_size, sizeof(uint8_t));
@@ -398,36 +896,50 @@ int main(int argc, char *argv[])
 		return EXIT_FAILURE;
 	}
 
-	/* Fill the data to write with random bytes. */
 	srand(time(NULL));
-	for (i = 0; i < (page_size); i++) {
-		tx_buffer[i] = rand() % 255;
-	}
+	for (page = page_index; page < page_index + num_pages; page++) {
+		/* Fill the data to write with random bytes. */
+		for (i = 0; i < (page_size); i++) {
+			tx_buffer[i] = rand() % 255;
+		}
 
-	/* Write the page. */
-	if (write_page(page_index, tx_buffer) != EXIT_SUCCESS) {
-		printf("Write page failed\n");
-		return EXIT_FAILURE;
-	}
+		/* Write the page. */
+		if (write_page(page, tx_buffer) != EXIT_SUCCESS) {
+			printf("Write page failed\n");
+			return EXIT_FAILURE;
+		}
 
-	/* Read the page. */
-	if (read_page(page_index, rx_buffer) != EXIT_SUCCESS) {
-		printf("Read page failed\n");
-		return EXIT_FAILURE;
-	}
+		/* Read the page. */
+		if (read_page(page, rx_buffer) != EXIT_SUCCESS) {
+			printf("Read page failed\n");
+			return EXIT_FAILURE;
+		}
 
-	/* Validate the read data. */
-	printf("[INFO] Validating read data...\n");
-	for (i = 0; i < page_size; i++) {
-		printf("  Byte %d: Write 0x%02x - Read 0x%02x", i,
-				tx_buffer[i], rx_buffer[i]);
-		if (tx_buffer[i] == rx_buffer[i]) {
-			printf(" - Correct\n");
-		} else {
-			printf(" - Incorrect\n");
+		/* Validate the read data. */
+		printf("[INFO] Validating read data...\n");
+		if (num_pages > 1) {
+			for (i = 0, errors = 0; i < page_size; i++)
+				errors += tx_buffer[i] != rx_buffer[i];
+			printf("  %d bytes correct, %d incorrect\n",
+			       page_size - errors, errors);
+			continue;
+		}
+		for (i = 0; i < page_size; i++) {
+			printf("  Byte %d: Write 0x%02x - Read 0x%02x", i,
+					tx_buffer[i], rx_buffer[i]);
+			if (tx_buffer[i] == rx_buffer[i]) {
+				printf(" - Correct\n");
+			} else {
+				printf(" - Incorrect\n");
+			}
 		}
 	}
 
+	if (num_pages > 1) {
+		printf("\n");
+		spi_eeprom_print_wc(&eeprom, stdout);
+	}
+
 	/* 'atexit' executes the cleanup function */
 	return EXIT_SUCCESS;
 }
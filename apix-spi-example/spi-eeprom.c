@@ -0,0 +1,347 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "spi-eeprom.h"
+
+#define SPIDEV_BUFSIZ_PATH	"/sys/module/spidev/parameters/bufsiz"
+
+/*
+ * read_bufsiz() - Reads the maximum size of a spidev message
+ *
+ * Return: The spidev bufsiz, SPI_EEPROM_DEF_BUFSIZ if unknown.
+ */
+static uint32_t read_bufsiz(void)
+{
+	unsigned long bufsiz;
+	FILE *f;
+
+	f = fopen(SPIDEV_BUFSIZ_PATH, "r");
+	if (!f)
+		return SPI_EEPROM_DEF_BUFSIZ;
+
+	if (fscanf(f, "%lu", &bufsiz) != 1 || !bufsiz || bufsiz > UINT32_MAX)
+		bufsiz = SPI_EEPROM_DEF_BUFSIZ;
+	fclose(f);
+
+	return bufsiz;
+}
+
+/*
+ * set_cmd() - Fills the command and address bytes of an operation
+ *
+ * @ee:		Memory.
+ * @cmd:	Buffer of 1 + addr_bytes bytes.
+ * @op:		Operation code.
+ * @addr:	Address.
+ *
+ * Return: The number of bytes filled.
+ */
+static unsigned int set_cmd(const struct spi_eeprom *ee, uint8_t *cmd,
+			    uint8_t op, uint32_t addr)
+{
+	unsigned int i;
+
+	cmd[0] = op;
+	for (i = 0; i < ee->addr_bytes; i++)
+		cmd[1 + i] = addr >> (8 * (ee->addr_bytes - i - 1));
+
+	return 1 + ee->addr_bytes;
+}
+
+/*
+ * now_us() - Returns the monotonic time in microseconds
+ *
+ * Return: The current CLOCK_MONOTONIC time in us.
+ */
+static uint64_t now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/*
+ * sleep_us() - Sleeps the given time
+ *
+ * @us:		Time to sleep, in us.
+ */
+static void sleep_us(unsigned int us)
+{
+	struct timespec ts = {
+		.tv_sec = us / 1000000,
+		.tv_nsec = (us % 1000000) * 1000,
+	};
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR)
+		;
+}
+
+/*
+ * account_wc() - Adds a write cycle to the statistics
+ *
+ * @wc:		Statistics.
+ * @us:		Write cycle time, in us.
+ * @polls:	Status reads of the cycle.
+ */
+static void account_wc(struct spi_eeprom_wc_stats *wc, uint32_t us,
+		       unsigned int polls)
+{
+	unsigned int bucket = us / SPI_EEPROM_WC_BUCKET_US;
+
+	if (!wc->count || us < wc->min_us)
+		wc->min_us = us;
+	if (us > wc->max_us)
+		wc->max_us = us;
+	wc->sum_us += us;
+	wc->polls += polls;
+	if (polls == 1)
+		wc->ready_first++;
+	wc->hist[bucket < SPI_EEPROM_WC_BUCKETS ?
+		 bucket : SPI_EEPROM_WC_BUCKETS]++;
+	wc->count++;
+}
+
+int spi_eeprom_open(struct spi_eeprom *ee, const spi_t *spi,
+		    unsigned int addr_bytes, unsigned int page_size)
+{
+	int fd;
+
+	if (!addr_bytes || addr_bytes > SPI_EEPROM_MAX_ADDR_BYTES || !page_size)
+		return -EINVAL;
+
+	memset(ee, 0, sizeof(*ee));
+	ee->addr_bytes = addr_bytes;
+	ee->page_size = page_size;
+	ee->max_msg = read_bufsiz();
+	ee->twc_us = SPI_EEPROM_DEF_TWC_US;
+	ee->sleep_us = ee->twc_us;
+
+	/* The status poll always submits the same segment */
+	ee->sr_seg.tx = ee->sr_buf;
+	ee->sr_seg.rx = ee->sr_buf;
+	ee->sr_seg.len = sizeof(ee->sr_buf);
+
+	/* The command and address must leave room for some data */
+	if (ee->max_msg <= 1 + addr_bytes)
+		return -EINVAL;
+
+	fd = spi_msg_open(spi);
+	if (fd < 0)
+		return fd;
+	ee->fd = fd;
+
+	return 0;
+}
+
+int spi_eeprom_read(struct spi_eeprom *ee, uint32_t addr, void *buf,
+		    size_t len)
+{
+	uint8_t cmd[1 + SPI_EEPROM_MAX_ADDR_BYTES];
+	struct spi_seg segs[2] = {
+		{ .tx = cmd },
+		{ .tx = NULL },
+	};
+	uint8_t *p = buf;
+	size_t n;
+	int ret;
+
+	while (len) {
+		/*
+		 * Command and address in the first segment, the data in the
+		 * second one. Chip select stays active between them, and
+		 * spidev clocks out zeros when there is no tx buffer.
+		 */
+		segs[0].len = set_cmd(ee, cmd, SPI_EEPROM_READ, addr);
+		n = ee->max_msg - segs[0].len;
+		if (n > len)
+			n = len;
+		segs[1].rx = p;
+		segs[1].len = n;
+
+		ret = spi_msg_transfer(ee->fd, segs, 2);
+		if (ret)
+			return ret;
+		ee->messages++;
+
+		addr += n;
+		p += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+int spi_eeprom_write_page(struct spi_eeprom *ee, uint32_t addr,
+			  const void *data, size_t len)
+{
+	static const uint8_t wren = SPI_EEPROM_WREN;
+	uint8_t cmd[1 + SPI_EEPROM_MAX_ADDR_BYTES];
+	struct spi_seg segs[3] = {
+		/* WREN is a command of its own, deselect the chip after it */
+		{ .tx = &wren, .len = 1, .cs_change = true },
+		{ .tx = cmd },
+		{ .tx = data, .len = len },
+	};
+	int ret;
+
+	/* The memory wraps around within the page */
+	if (!len || addr % ee->page_size + len > ee->page_size)
+		return -EINVAL;
+
+	segs[1].len = set_cmd(ee, cmd, SPI_EEPROM_WRITE, addr);
+	if (1 + segs[1].len + len > ee->max_msg)
+		return -EMSGSIZE;
+
+	ret = spi_msg_transfer(ee->fd, segs, 3);
+	if (!ret)
+		ee->messages++;
+
+	return ret;
+}
+
+void spi_eeprom_set_twc(struct spi_eeprom *ee, unsigned int twc_us)
+{
+	ee->twc_us = twc_us;
+	ee->sleep_us = twc_us;
+}
+
+int spi_eeprom_read_status(struct spi_eeprom *ee, uint8_t *status)
+{
+	int ret;
+
+	/* Full duplex on the same buffer, the command is sent every time */
+	ee->sr_buf[0] = SPI_EEPROM_RDSR;
+	ret = spi_msg_transfer(ee->fd, &ee->sr_seg, 1);
+	if (ret)
+		return ret;
+	ee->messages++;
+	*status = ee->sr_buf[1];
+
+	return 0;
+}
+
+int spi_eeprom_wait_ready(struct spi_eeprom *ee, unsigned int timeout_us)
+{
+	unsigned int interval = SPI_EEPROM_POLL_MIN_US;
+	unsigned int polls = 0, sleep;
+	uint64_t start, elapsed, busy = 0;
+	uint8_t status = 0;
+	int ret;
+
+	start = now_us();
+
+	/* Nothing to poll for before the expected end of the cycle */
+	sleep = ee->sleep_us < timeout_us ? ee->sleep_us : timeout_us;
+	sleep_us(sleep);
+
+	for (;;) {
+		ret = spi_eeprom_read_status(ee, &status);
+		if (ret)
+			return ret;
+		polls++;
+
+		elapsed = now_us() - start;
+		if (!(status & SPI_EEPROM_SR_WIP))
+			break;
+		if (elapsed >= timeout_us)
+			return -ETIMEDOUT;
+		busy = elapsed;
+
+		sleep_us(interval);
+		if (interval < SPI_EEPROM_POLL_MAX_US)
+			interval *= 2;
+		if (interval > SPI_EEPROM_POLL_MAX_US)
+			interval = SPI_EEPROM_POLL_MAX_US;
+	}
+
+	/*
+	 * Over at the first poll: the cycle may be shorter than the sleep,
+	 * try a shorter one next time. Otherwise the memory was still busy
+	 * at 'busy', a safe sleep for the next cycle.
+	 */
+	if (polls == 1)
+		ee->sleep_us -= ee->sleep_us / 8;
+	else if (busy < ee->twc_us)
+		ee->sleep_us = busy;
+	else
+		ee->sleep_us = ee->twc_us;
+
+	account_wc(&ee->wc, elapsed, polls);
+
+	return elapsed;
+}
+
+void spi_eeprom_print_wc(const struct spi_eeprom *ee, FILE *f)
+{
+	const struct spi_eeprom_wc_stats *wc = &ee->wc;
+	unsigned long peak = 0;
+	unsigned int i, first, last, width;
+
+	if (!wc->count) {
+		fprintf(f, "No write cycles measured\n");
+		return;
+	}
+
+	fprintf(f, "Write cycles: %lu, min %u us, avg %llu us, max %u us, "
+		"%.1f status polls per cycle\n", wc->count, wc->min_us,
+		(unsigned long long)(wc->sum_us / wc->count), wc->max_us,
+		(double)wc->polls / wc->count);
+
+	/* Only the range of buckets in use */
+	first = SPI_EEPROM_WC_BUCKETS;
+	last = 0;
+	for (i = 0; i <= SPI_EEPROM_WC_BUCKETS; i++) {
+		if (!wc->hist[i])
+			continue;
+		if (i < first)
+			first = i;
+		last = i;
+		if (wc->hist[i] > peak)
+			peak = wc->hist[i];
+	}
+
+	for (i = first; i <= last; i++) {
+		width = wc->hist[i] * 40 / peak;
+		if (i < SPI_EEPROM_WC_BUCKETS)
+			fprintf(f, "  %5u-%5u us %8lu |", i * SPI_EEPROM_WC_BUCKET_US,
+				(i + 1) * SPI_EEPROM_WC_BUCKET_US - 1, wc->hist[i]);
+		else
+			fprintf(f, "  %5u+      us %8lu |",
+				i * SPI_EEPROM_WC_BUCKET_US, wc->hist[i]);
+		while (width--)
+			fputc('#', f);
+		fputc('\n', f);
+	}
+
+	fprintf(f, "First poll after %u us (typical write cycle time %u us), "
+		"%lu%% of the cycles over at the first poll\n", ee->sleep_us,
+		ee->twc_us, wc->ready_first * 100 / wc->count);
+}
+
+void spi_eeprom_close(struct spi_eeprom *ee)
+{
+	if (ee->fd > 0)
+		close(ee->fd);
+	ee->fd = -1;
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef SPI_EEPROM_H_
+#define SPI_EEPROM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <libdigiapix/spi.h>
+
+#include "spi-msg.h"
+
+#define SPI_EEPROM_WREN			0x06
+#define SPI_EEPROM_WRITE		0x02
+#define SPI_EEPROM_READ			0x03
+#define SPI_EEPROM_RDSR			0x05
+
+#define SPI_EEPROM_SR_WIP		0x01	/* Write in progress */
+
+#define SPI_EEPROM_MAX_ADDR_BYTES	4
+#define SPI_EEPROM_DEF_BUFSIZ		4096	/* spidev default */
+
+#define SPI_EEPROM_DEF_TWC_US		3000	/* Typical write cycle time */
+#define SPI_EEPROM_WC_TIMEOUT_US	100000
+#define SPI_EEPROM_POLL_MIN_US		20	/* First status poll interval */
+#define SPI_EEPROM_POLL_MAX_US		500	/* Largest poll interval */
+
+#define SPI_EEPROM_WC_BUCKET_US		250
+#define SPI_EEPROM_WC_BUCKETS		40	/* Up to 10 ms, plus overflow */
+
+/* Distribution of the measured write cycle times */
+struct spi_eeprom_wc_stats {
+	unsigned long count;
+	unsigned long polls;		/* Status reads */
+	unsigned long ready_first;	/* Cycles done at the first poll */
+	uint32_t min_us, max_us;
+	uint64_t sum_us;
+	unsigned long hist[SPI_EEPROM_WC_BUCKETS + 1];
+};
+
+/* Direct spidev access to a 25xx-like SPI EEPROM or flash memory */
+struct spi_eeprom {
+	int fd;
+	unsigned int addr_bytes;
+	unsigned int page_size;
+	uint32_t max_msg;		/* Bytes per message (spidev bufsiz) */
+	unsigned long messages;		/* Messages submitted so far */
+	unsigned int twc_us;		/* Typical write cycle time */
+	unsigned int sleep_us;		/* Sleep before the first poll */
+	struct spi_seg sr_seg;		/* Status read, prepared once */
+	uint8_t sr_buf[2];
+	struct spi_eeprom_wc_stats wc;
+};
+
+/*
+ * spi_eeprom_open() - Opens the spidev device of an SPI memory
+ *
+ * The device is opened again with spi_msg_open(), apart from the
+ * libdigiapix handle, to submit messages of several transfers.
+ *
+ * @ee:		Memory to initialize.
+ * @spi:	SPI handle returned by ldx_spi_request().
+ * @addr_bytes:	Number of address bytes of the memory.
+ * @page_size:	Page size of the memory, in bytes.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int spi_eeprom_open(struct spi_eeprom *ee, const spi_t *spi,
+		    unsigned int addr_bytes, unsigned int page_size);
+
+/*
+ * spi_eeprom_read() - Reads a range of the memory
+ *
+ * Uses the sequential read of the memory: a single READ command and address
+ * followed by the data of the whole range, received directly in the given
+ * buffer. Ranges longer than a spidev message are split in as few messages
+ * as possible.
+ *
+ * @ee:		Memory.
+ * @addr:	Address of the first byte.
+ * @buf:	Buffer to store the data.
+ * @len:	Number of bytes to read.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int spi_eeprom_read(struct spi_eeprom *ee, uint32_t addr, void *buf,
+		    size_t len);
+
+/*
+ * spi_eeprom_write_page() - Starts the write of a page, or part of it
+ *
+ * Sends WREN, the WRITE command and address, and the data directly from the
+ * given buffer, in a single message of three segments. The function returns
+ * when the data is sent, with the write cycle of the memory in progress (see
+ * spi_eeprom_wait_ready()).
+ *
+ * @ee:		Memory.
+ * @addr:	Address of the first byte.
+ * @data:	Data to write.
+ * @len:	Number of bytes, the range must not cross a page boundary.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int spi_eeprom_write_page(struct spi_eeprom *ee, uint32_t addr,
+			  const void *data, size_t len);
+
+/*
+ * spi_eeprom_set_twc() - Sets the typical write cycle time of the memory
+ *
+ * spi_eeprom_wait_ready() starts sleeping this time before the first status
+ * poll, and never sleeps longer.
+ *
+ * @ee:		Memory.
+ * @twc_us:	Typical write cycle time, in us (SPI_EEPROM_DEF_TWC_US by
+ *		default).
+ */
+void spi_eeprom_set_twc(struct spi_eeprom *ee, unsigned int twc_us);
+
+/*
+ * spi_eeprom_read_status() - Reads the status register of the memory
+ *
+ * @ee:		Memory.
+ * @status:	Variable to store the status register.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int spi_eeprom_read_status(struct spi_eeprom *ee, uint8_t *status);
+
+/*
+ * spi_eeprom_wait_ready() - Waits for the end of a write cycle
+ *
+ * To be called right after the write. Sleeps before the first status poll
+ * and then polls the WIP bit with an exponential backoff from
+ * SPI_EEPROM_POLL_MIN_US to SPI_EEPROM_POLL_MAX_US.
+ *
+ * The sleep starts at the typical write cycle time and adapts to the
+ * memory: it is reduced by 1/8 every time the cycle is over at the first
+ * poll, and set to the time of the last busy poll when the memory needed
+ * more polls, so it converges just below the actual write cycle time. The
+ * measured time is added to the write cycle statistics.
+ *
+ * @ee:		Memory.
+ * @timeout_us:	Maximum time to wait, in us.
+ *
+ * Return: The write cycle time in us, -ETIMEDOUT if the memory is still
+ *	   busy after the timeout, -errno on other errors.
+ */
+int spi_eeprom_wait_ready(struct spi_eeprom *ee, unsigned int timeout_us);
+
+/*
+ * spi_eeprom_print_wc() - Prints the distribution of the write cycle times
+ *
+ * @ee:		Memory.
+ * @f:		Output stream.
+ */
+void spi_eeprom_print_wc(const struct spi_eeprom *ee, FILE *f);
+
+/*
+ * spi_eeprom_close() - Closes the spidev device of an SPI memory
+ *
+ * @ee:		Memory.
+ */
+void spi_eeprom_close(struct spi_eeprom *ee);
+
+#endif /* SPI_EEPROM_H_ */
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+#include "spi-msg.h"
+
+#define SPIDEV_PATH_FMT		"/dev/spidev%u.%u"
+
+int spi_msg_open(const spi_t *spi)
+{
+	char path[32];
+	int fd;
+
+	snprintf(path, sizeof(path), SPIDEV_PATH_FMT, spi->spi_device,
+		 spi->spi_slave);
+	fd = open(path, O_RDWR | O_CLOEXEC);
+
+	return fd < 0 ? -errno : fd;
+}
+
+int spi_msg_transfer(int fd, const struct spi_seg *segs, unsigned int n)
+{
+	struct spi_ioc_transfer xfer[SPI_MSG_MAX_SEGS];
+	unsigned int i;
+
+	if (!n || n > SPI_MSG_MAX_SEGS)
+		return -EINVAL;
+
+	memset(xfer, 0, n * sizeof(xfer[0]));
+	for (i = 0; i < n; i++) {
+		xfer[i].tx_buf = (unsigned long)segs[i].tx;
+		xfer[i].rx_buf = (unsigned long)segs[i].rx;
+		xfer[i].len = segs[i].len;
+		xfer[i].delay_usecs = segs[i].delay_us;
+		/* In the last transfer it would keep the chip selected */
+		xfer[i].cs_change = segs[i].cs_change && i < n - 1;
+	}
+
+	if (ioctl(fd, SPI_IOC_MESSAGE(n), xfer) < 0)
+		return -errno;
+
+	return 0;
+}
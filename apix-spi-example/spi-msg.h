@@ -0,0 +1,66 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef SPI_MSG_H_
+#define SPI_MSG_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <libdigiapix/spi.h>
+
+#define SPI_MSG_MAX_SEGS	32
+
+/* Transfer segment of an SPI message */
+struct spi_seg {
+	const void *tx;		/* Data to send, NULL to send zeros */
+	void *rx;		/* Buffer for the received data, or NULL */
+	uint32_t len;
+	bool cs_change;		/* Deselect the chip after this segment */
+	uint16_t delay_us;	/* Delay after this segment */
+};
+
+/*
+ * spi_msg_open() - Opens the spidev device of an SPI slave
+ *
+ * The mode, bits per word and speed configured with libdigiapix on the
+ * same slave apply to the new descriptor too.
+ *
+ * @spi:	SPI handle returned by ldx_spi_request().
+ *
+ * Return: The file descriptor, -errno on error.
+ */
+int spi_msg_open(const spi_t *spi);
+
+/*
+ * spi_msg_transfer() - Submits a list of segments as a single message
+ *
+ * All the segments are transferred with one SPI_IOC_MESSAGE ioctl. The chip
+ * stays selected from one segment to the next unless the segment has
+ * 'cs_change' set, which separates two operations, for example WREN and
+ * WRITE, in the same message. 'cs_change' is ignored in the last segment,
+ * the chip is always deselected at the end of the message. The total length
+ * is limited by the spidev bufsiz.
+ *
+ * @fd:		spidev file descriptor.
+ * @segs:	Segments.
+ * @n:		Number of segments, up to SPI_MSG_MAX_SEGS.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int spi_msg_transfer(int fd, const struct spi_seg *segs, unsigned int n);
+
+#endif /* SPI_MSG_H_ */
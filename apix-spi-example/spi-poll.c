@@ -0,0 +1,269 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "spi-poll.h"
+
+#define NSEC_PER_SEC		1000000000ULL
+#define RING_MASK		(SPI_POLL_RING_SIZE - 1)
+
+_Static_assert(!(SPI_POLL_RING_SIZE & RING_MASK),
+	       "ring size must be a power of 2");
+
+/*
+ * now_ns() - Returns the monotonic time in nanoseconds
+ *
+ * Return: The current CLOCK_MONOTONIC time in ns.
+ */
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+/*
+ * poll_once() - Reads a sample into the next slot of the ring
+ *
+ * @p:		Engine.
+ * @deadline:	Deadline of the poll.
+ */
+static void poll_once(struct spi_poll *p, uint64_t deadline)
+{
+	struct spi_poll_stats *st = &p->stats;
+	uint32_t head = atomic_load_explicit(&p->head, memory_order_relaxed);
+	struct spi_seg segs[2] = {
+		{ .tx = p->cmd, .len = p->cfg.cmd_len },
+		{ .len = p->cfg.len },
+	};
+	uint64_t start, lat, val = 1;
+
+	/* The slot is still owned by the consumer */
+	if (head - atomic_load_explicit(&p->tail, memory_order_acquire) ==
+	    SPI_POLL_RING_SIZE) {
+		st->dropped++;
+		return;
+	}
+
+	segs[1].rx = p->pool + (head & RING_MASK) * p->stride;
+	start = now_ns();
+	if (start - deadline > st->wake_max)
+		st->wake_max = start - deadline;
+	if (spi_msg_transfer(p->fd, segs, 2)) {
+		st->errors++;
+		return;
+	}
+	lat = now_ns() - start;
+
+	if (!st->polls || lat < st->lat_min)
+		st->lat_min = lat;
+	if (lat > st->lat_max)
+		st->lat_max = lat;
+	st->lat_sum += lat;
+	if (!st->polls)
+		st->first_ts = deadline;
+	st->last_ts = deadline;
+	st->polls++;
+
+	p->ts[head & RING_MASK] = deadline;
+	p->latency[head & RING_MASK] = lat;
+	atomic_store(&p->head, head + 1);
+
+	/* Only wake up the consumer when it is waiting */
+	if (atomic_load(&p->sleeping) && atomic_exchange(&p->sleeping, false))
+		if (write(p->efd, &val, sizeof(val)) < 0)
+			return;
+}
+
+/*
+ * poll_thread() - Polls the slave on every deadline
+ *
+ * @arg:	Engine (struct spi_poll).
+ */
+static void *poll_thread(void *arg)
+{
+	struct spi_poll *p = arg;
+	uint64_t period = p->cfg.period_ns;
+	uint64_t deadline, now, skip;
+	struct timespec ts;
+
+	deadline = now_ns() + period;
+
+	while (atomic_load_explicit(&p->running, memory_order_relaxed)) {
+		ts.tv_sec = deadline / NSEC_PER_SEC;
+		ts.tv_nsec = deadline % NSEC_PER_SEC;
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts,
+				       NULL) == EINTR)
+			;
+
+		poll_once(p, deadline);
+
+		/* Skip the deadlines already missed, keep the phase */
+		deadline += period;
+		now = now_ns();
+		if (deadline <= now) {
+			skip = (now - deadline) / period + 1;
+			deadline += skip * period;
+			p->stats.missed += skip;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * create_thread() - Creates the polling thread
+ *
+ * @p:		Engine.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+static int create_thread(struct spi_poll *p)
+{
+	struct sched_param param = { .sched_priority = p->cfg.priority };
+	pthread_attr_t attr;
+	int ret;
+
+	if (p->cfg.priority) {
+		pthread_attr_init(&attr);
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		pthread_attr_setschedparam(&attr, &param);
+		ret = pthread_create(&p->thread, &attr, poll_thread, p);
+		pthread_attr_destroy(&attr);
+		if (!ret) {
+			p->rt = true;
+			return 0;
+		}
+		if (ret != EPERM)
+			return -ret;
+	}
+
+	/* Not privileged for real time, poll with the default policy */
+	ret = pthread_create(&p->thread, NULL, poll_thread, p);
+
+	return -ret;
+}
+
+int spi_poll_start(struct spi_poll *p, int fd, const struct spi_poll_cfg *cfg)
+{
+	int ret;
+
+	if (!cfg->period_ns || !cfg->len || !cfg->cmd || !cfg->cmd_len ||
+	    cfg->cmd_len > SPI_POLL_MAX_CMD)
+		return -EINVAL;
+
+	memset(p, 0, sizeof(*p));
+	p->fd = fd;
+	p->cfg = *cfg;
+	memcpy(p->cmd, cfg->cmd, cfg->cmd_len);
+	p->cfg.cmd = p->cmd;
+
+	/* Whole cache lines per slot, no line shared by two samples */
+	p->stride = (cfg->len + SPI_POLL_ALIGN - 1) & ~(SPI_POLL_ALIGN - 1);
+	ret = posix_memalign((void **)&p->pool, SPI_POLL_ALIGN,
+			     SPI_POLL_RING_SIZE * p->stride);
+	if (ret)
+		return -ret;
+	/* Fault the pool in now, not in the polling loop */
+	memset(p->pool, 0, SPI_POLL_RING_SIZE * p->stride);
+
+	p->efd = eventfd(0, EFD_CLOEXEC);
+	if (p->efd < 0) {
+		ret = -errno;
+		goto err_pool;
+	}
+
+	atomic_store(&p->running, true);
+	ret = create_thread(p);
+	if (ret)
+		goto err_efd;
+	p->started = true;
+
+	return 0;
+
+err_efd:
+	close(p->efd);
+err_pool:
+	free(p->pool);
+	p->pool = NULL;
+
+	return ret;
+}
+
+int spi_poll_get(struct spi_poll *p, struct spi_poll_sample *s,
+		 int timeout_ms)
+{
+	uint32_t tail = atomic_load_explicit(&p->tail, memory_order_relaxed);
+	struct pollfd pfd = { .fd = p->efd, .events = POLLIN };
+	uint64_t val;
+	int ret;
+
+	while (atomic_load_explicit(&p->head, memory_order_acquire) == tail) {
+		atomic_store(&p->sleeping, true);
+		/* A sample may have been published before 'sleeping' was set */
+		if (atomic_load(&p->head) != tail) {
+			atomic_store(&p->sleeping, false);
+			break;
+		}
+
+		ret = poll(&pfd, 1, timeout_ms);
+		atomic_store(&p->sleeping, false);
+		if (ret < 0 && errno != EINTR)
+			return -errno;
+		if (ret == 0)
+			return 0;
+		if (ret > 0 && read(p->efd, &val, sizeof(val)) < 0)
+			return -errno;
+	}
+
+	s->ts = p->ts[tail & RING_MASK];
+	s->latency_ns = p->latency[tail & RING_MASK];
+	s->data = p->pool + (tail & RING_MASK) * p->stride;
+
+	return 1;
+}
+
+void spi_poll_release(struct spi_poll *p)
+{
+	uint32_t tail = atomic_load_explicit(&p->tail, memory_order_relaxed);
+
+	atomic_store_explicit(&p->tail, tail + 1, memory_order_release);
+}
+
+void spi_poll_stop(struct spi_poll *p)
+{
+	if (!p->started)
+		return;
+
+	/* The thread checks the flag on every deadline */
+	atomic_store(&p->running, false);
+	pthread_join(p->thread, NULL);
+	close(p->efd);
+	free(p->pool);
+	p->pool = NULL;
+	p->started = false;
+}
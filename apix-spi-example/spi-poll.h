@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef SPI_POLL_H_
+#define SPI_POLL_H_
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "spi-msg.h"
+
+#define SPI_POLL_RING_SIZE	1024	/* Samples, power of 2 */
+#define SPI_POLL_ALIGN		64	/* Cache line, and DMA alignment */
+#define SPI_POLL_MAX_CMD	16
+
+struct spi_poll_cfg {
+	uint64_t period_ns;
+	const uint8_t *cmd;	/* Sent at every poll, e.g. a register read */
+	unsigned int cmd_len;	/* 1 to SPI_POLL_MAX_CMD */
+	unsigned int len;	/* Bytes read after the command */
+	int priority;		/* SCHED_FIFO priority, 0 for SCHED_OTHER */
+};
+
+/* Sample of the ring, valid until spi_poll_release() */
+struct spi_poll_sample {
+	uint64_t ts;		/* Deadline of the poll, CLOCK_MONOTONIC ns */
+	uint32_t latency_ns;	/* Duration of the transfer */
+	const uint8_t *data;	/* 'len' bytes read */
+};
+
+/* Statistics of the polling thread, read them after spi_poll_stop() */
+struct spi_poll_stats {
+	uint64_t polls;
+	uint64_t missed;	/* Deadlines skipped because the loop was late */
+	uint64_t errors;	/* Failed transfers */
+	uint64_t dropped;	/* Samples lost because the ring was full */
+	uint64_t first_ts, last_ts;
+	uint64_t lat_min, lat_max, lat_sum;	/* Transfer latency, ns */
+	uint64_t wake_max;	/* Worst wake up delay after a deadline, ns */
+};
+
+/*
+ * Polling engine: a thread reads the slave on every deadline, directly into
+ * the slots of a pool of aligned buffers allocated once, and publishes the
+ * samples to a consumer through a single producer, single consumer ring.
+ */
+struct spi_poll {
+	int fd;
+	struct spi_poll_cfg cfg;
+	uint8_t cmd[SPI_POLL_MAX_CMD] __attribute__((aligned(SPI_POLL_ALIGN)));
+	uint8_t *pool;		/* SPI_POLL_RING_SIZE slots of 'stride' bytes */
+	size_t stride;
+	uint64_t ts[SPI_POLL_RING_SIZE];
+	uint32_t latency[SPI_POLL_RING_SIZE];
+	struct spi_poll_stats stats;
+	bool rt;		/* Running with SCHED_FIFO */
+
+	/* Write position, written by the polling thread */
+	_Atomic uint32_t head __attribute__((aligned(SPI_POLL_ALIGN)));
+
+	/* Read position, written by the consumer */
+	_Atomic uint32_t tail __attribute__((aligned(SPI_POLL_ALIGN)));
+	_Atomic bool sleeping;	/* Consumer waiting on the eventfd */
+	_Atomic bool running;
+	int efd;
+	pthread_t thread;
+	bool started;
+};
+
+/*
+ * spi_poll_start() - Starts polling an SPI slave
+ *
+ * The thread runs with SCHED_FIFO if cfg->priority is not 0. If the process
+ * is not allowed to, it falls back to the default policy and 'rt' is false.
+ *
+ * @p:		Engine to start.
+ * @fd:		spidev file descriptor, see spi_msg_open().
+ * @cfg:	Polling configuration.
+ *
+ * Return: 0 on success, -errno otherwise.
+ */
+int spi_poll_start(struct spi_poll *p, int fd, const struct spi_poll_cfg *cfg);
+
+/*
+ * spi_poll_get() - Waits for the next sample
+ *
+ * Must be called from a single thread. The sample stays in the ring, and its
+ * data in the pool, until spi_poll_release().
+ *
+ * @p:		Engine.
+ * @s:		Variable to store the sample.
+ * @timeout_ms:	Maximum time to wait, -1 to wait forever.
+ *
+ * Return: 1 if there is a sample, 0 on timeout, -errno on error.
+ */
+int spi_poll_get(struct spi_poll *p, struct spi_poll_sample *s,
+		 int timeout_ms);
+
+/*
+ * spi_poll_release() - Returns the sample got to the ring
+ *
+ * @p:		Engine.
+ */
+void spi_poll_release(struct spi_poll *p);
+
+/*
+ * spi_poll_stop() - Stops polling and frees the buffer pool
+ *
+ * @p:		Engine.
+ */
+void spi_poll_stop(struct spi_poll *p);
+
+#endif /* SPI_POLL_H_ */
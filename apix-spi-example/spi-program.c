@@ -0,0 +1,182 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "spi-program.h"
+
+#define CRC32_POLY		0xedb88320	/* Reflected IEEE 802.3 */
+
+static uint32_t crc32_table[256];
+
+/*
+ * crc32_init() - Generates the CRC-32 lookup table
+ */
+static void crc32_init(void)
+{
+	uint32_t c;
+	unsigned int i, k;
+
+	if (crc32_table[1])
+		return;
+
+	for (i = 0; i < 256; i++) {
+		c = i;
+		for (k = 0; k < 8; k++)
+			c = c & 1 ? (c >> 1) ^ CRC32_POLY : c >> 1;
+		crc32_table[i] = c;
+	}
+}
+
+/*
+ * crc32_update() - Adds data to a CRC-32
+ *
+ * Same CRC as zlib's crc32(), start with 0.
+ *
+ * @crc:	CRC of the previous data.
+ * @p:		Data.
+ * @len:	Number of bytes.
+ *
+ * Return: The updated CRC.
+ */
+static uint32_t crc32_update(uint32_t crc, const uint8_t *p, size_t len)
+{
+	crc = ~crc;
+	while (len--)
+		crc = crc32_table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+
+	return ~crc;
+}
+
+/*
+ * chunk_len() - Returns the bytes of the image up to the next page boundary
+ *
+ * @ee:		Memory.
+ * @addr:	Address of the image.
+ * @off:	Offset in the image.
+ * @len:	Image size.
+ *
+ * Return: The length of the chunk of the image starting at 'off'.
+ */
+static size_t chunk_len(const struct spi_eeprom *ee, uint32_t addr,
+			size_t off, size_t len)
+{
+	size_t n = ee->page_size - (addr + off) % ee->page_size;
+
+	return n < len - off ? n : len - off;
+}
+
+/*
+ * next_dirty() - Finds the next chunk of the image to write
+ *
+ * @ee:		Memory.
+ * @addr:	Address of the image.
+ * @image:	Image.
+ * @cur:	Current contents of the memory.
+ * @off:	Offset to start searching at, at a chunk boundary.
+ * @len:	Image size.
+ * @skipped:	Counter of the chunks that do not need a write.
+ *
+ * Return: The offset of the next chunk that differs, 'len' if none.
+ */
+static size_t next_dirty(const struct spi_eeprom *ee, uint32_t addr,
+			 const uint8_t *image, const uint8_t *cur, size_t off,
+			 size_t len, unsigned int *skipped)
+{
+	size_t n;
+
+	for (; off < len; off += n) {
+		n = chunk_len(ee, addr, off, len);
+		if (memcmp(image + off, cur + off, n))
+			break;
+		(*skipped)++;
+	}
+
+	return off;
+}
+
+int spi_program_image(struct spi_eeprom *ee, uint32_t addr,
+		      const uint8_t *image, size_t len,
+		      struct spi_prog_stats *st)
+{
+	struct timespec start, end;
+	size_t off, next, crc_off = 0;
+	uint8_t *cur;
+	int ret;
+
+	memset(st, 0, sizeof(*st));
+	if (!len)
+		return -EINVAL;
+
+	crc32_init();
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	/*
+	 * Read the whole range up front. The read is long (a 32 KB memory takes
+	 * about 260 ms at 1 MHz), but a page is read in a fraction of its write
+	 * cycle, so one bulk read is far cheaper than the page writes it lets
+	 * the programmer skip.
+	 */
+	cur = malloc(len);
+	if (!cur)
+		return -ENOMEM;
+	ret = spi_eeprom_read(ee, addr, cur, len);
+	if (ret)
+		goto out;
+
+	off = next_dirty(ee, addr, image, cur, 0, len, &st->pages_skipped);
+	while (off < len) {
+		ret = spi_eeprom_write_page(ee, addr + off, image + off,
+					    chunk_len(ee, addr, off, len));
+		if (ret)
+			goto out;
+		st->pages_written++;
+
+		/* Prepare the next write during the write cycle */
+		next = next_dirty(ee, addr, image, cur,
+				  off + chunk_len(ee, addr, off, len), len,
+				  &st->pages_skipped);
+		st->image_crc = crc32_update(st->image_crc, image + crc_off,
+					     next - crc_off);
+		crc_off = next;
+
+		ret = spi_eeprom_wait_ready(ee, SPI_EEPROM_WC_TIMEOUT_US);
+		if (ret < 0)
+			goto out;
+		off = next;
+	}
+	st->image_crc = crc32_update(st->image_crc, image + crc_off,
+				     len - crc_off);
+
+	/* Verify */
+	ret = spi_eeprom_read(ee, addr, cur, len);
+	if (ret)
+		goto out;
+	st->read_crc = crc32_update(0, cur, len);
+	ret = st->read_crc == st->image_crc ? 0 : -EIO;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	st->secs = (end.tv_sec - start.tv_sec) +
+		   (end.tv_nsec - start.tv_nsec) / 1e9;
+
+out:
+	free(cur);
+
+	return ret;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026, Digi International Inc.
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH
+ * REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY
+ * AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT,
+ * INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM
+ * LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE
+ * OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR
+ * PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef SPI_PROGRAM_H_
+#define SPI_PROGRAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "spi-eeprom.h"
+
+/* Result of the programming of an image */
+struct spi_prog_stats {
+	unsigned int pages_written;
+	unsigned int pages_skipped;	/* Already had the image contents */
+	uint32_t image_crc;
+	uint32_t read_crc;		/* CRC of the memory after programming */
+	double secs;			/* Total time, including the verify */
+};
+
+/*
+ * spi_program_image() - Programs an image into the memory and verifies it
+ *
+ * Reads the current contents of the range first and only writes the pages
+ * that differ from the image. The next page to write is searched for, and
+ * the CRC of the image computed, while the memory runs the write cycle of
+ * the current page. The data is sent directly from the image buffer. When
+ * all the pages are written, the range is read back and its CRC-32 compared
+ * with the CRC-32 of the image.
+ *
+ * @ee:		Memory.
+ * @addr:	Address to program the image at.
+ * @image:	Image.
+ * @len:	Image size, in bytes.
+ * @st:		Variable to store the result.
+ *
+ * Return: 0 on success, -EIO if the verify fails, -errno on other errors.
+ */
+int spi_program_image(struct spi_eeprom *ee, uint32_t addr,
+		      const uint8_t *image, size_t len,
+		      struct spi_prog_stats *st);
+
+#endif /* SPI_PROGRAM_H_ */